@@ -0,0 +1,134 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Arena and Pool against malloc: single allocate/free pairs, and building then discarding 1000 small objects.
+///
+
+#include "Benchmark.h"
+
+#include <npas4/Arena.h>
+#include <npas4/Pool.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+	struct Node
+	{
+		int64_t Key;
+		int64_t Value;
+		Node* Left;
+		Node* Right;
+	};
+
+	void* volatile Sink{nullptr};
+
+	const int Count{1000};
+} // namespace
+
+int main()
+{
+	npas4::Arena arena("bench.arena");
+	npas4::Pool<Node> pool("bench.pool");
+
+	npas4::bench::Report("malloc/free 32 bytes", npas4::bench::NanosecondsPerCall(
+														  []() {
+															  auto x = malloc(sizeof(Node));
+															  Sink = x;
+															  free(x);
+														  },
+														  5000000));
+
+	npas4::bench::Report("Pool Create/Destroy 32 bytes", npas4::bench::NanosecondsPerCall(
+																  [&pool]() {
+																	  auto x = pool.Create();
+																	  Sink = x;
+																	  pool.Destroy(x);
+																  },
+																  5000000));
+
+	// Reset now and then, so the arena does not grow without bound.
+	int resetCountdown{Count};
+
+	npas4::bench::Report("Arena Allocate 32 bytes", npas4::bench::NanosecondsPerCall(
+														 [&arena, &resetCountdown]() {
+															 Sink = arena.Allocate(sizeof(Node));
+
+															 if(--resetCountdown == 0)
+															 {
+																 resetCountdown = Count;
+																 arena.Reset();
+															 }
+														 },
+														 5000000));
+
+	// Build 1000 nodes and discard them, as a parser or a request handler might.
+	std::vector<void*> nodes(Count);
+
+	npas4::bench::Report("malloc x 1000 then free x 1000", npas4::bench::NanosecondsPerCall(
+																	[&nodes]() {
+																		for(auto& i : nodes)
+																		{
+																			i = malloc(sizeof(Node));
+																		}
+
+																		Sink = nodes[Count - 1];
+
+																		for(auto i : nodes)
+																		{
+																			free(i);
+																		}
+																	},
+																	5000));
+
+	npas4::bench::Report("Pool Create x 1000 then Destroy x 1000", npas4::bench::NanosecondsPerCall(
+																			[&nodes, &pool]() {
+																				for(auto& i : nodes)
+																				{
+																					i = pool.Create();
+																				}
+
+																				Sink = nodes[Count - 1];
+
+																				for(auto i : nodes)
+																				{
+																					pool.Destroy(static_cast<Node*>(i));
+																				}
+																			},
+																			5000));
+
+	npas4::bench::Report("Arena Allocate x 1000 then Reset", npas4::bench::NanosecondsPerCall(
+																	  [&nodes, &arena]() {
+																		  for(auto& i : nodes)
+																		  {
+																			  i = arena.Allocate(sizeof(Node));
+																		  }
+
+																		  Sink = nodes[Count - 1];
+																		  arena.Reset();
+																	  },
+																	  5000));
+
+	for(auto i : npas4::GetArenaReports())
+	{
+		std::cout << static_cast<std::string>(i);
+	}
+
+	return 0;
+}
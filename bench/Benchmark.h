@@ -0,0 +1,75 @@
+#ifndef H_NPAS4_BENCHMARK_H
+#define H_NPAS4_BENCHMARK_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+///
+/// Minimal timing helpers shared by the npas4 benchmark executables.
+///
+namespace npas4
+{
+	namespace bench
+	{
+		///
+		/// Keeps a value alive so the optimizer cannot remove the work that produced it.
+		///
+		template <typename T>
+		void DoNotOptimize(const T& value)
+		{
+			static volatile int64_t sink{0};
+			sink = sink + static_cast<int64_t>(value);
+		}
+
+		///
+		/// Runs f() 'iterations' times (after a short warm up) and returns the mean nanoseconds per call.
+		///
+		template <typename F>
+		double NanosecondsPerCall(F f, int64_t iterations)
+		{
+			for(int64_t i = 0; i < iterations / 10 + 1; ++i)
+			{
+				f();
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+
+			for(int64_t i = 0; i < iterations; ++i)
+			{
+				f();
+			}
+
+			const auto stop = std::chrono::steady_clock::now();
+			return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()) / static_cast<double>(iterations);
+		}
+
+		inline void Report(const std::string& name, double nanoseconds)
+		{
+			std::cout << std::left << std::setw(56) << name << std::right << std::setw(12) << std::fixed << std::setprecision(1) << nanoseconds
+					  << " ns" << std::endl;
+		}
+	} // namespace bench
+} // namespace npas4
+
+#endif
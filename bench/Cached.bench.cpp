@@ -0,0 +1,94 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Contention benchmark: 1..N threads hammering the cached and uncached query functions concurrently.
+///
+
+#include "Benchmark.h"
+
+#include <npas4/Cached.h>
+#include <npas4/Npas4.h>
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	///
+	/// Runs f() 'iterations' times on each of 'threads' threads, all released at once.  Returns the mean nanoseconds per call per thread.
+	///
+	template <typename F>
+	double Contended(F f, unsigned threads, int64_t iterations)
+	{
+		std::atomic<bool> go{false};
+		std::atomic<int64_t> totalNanoseconds{0};
+		std::vector<std::thread> workers;
+
+		for(unsigned i = 0; i < threads; ++i)
+		{
+			workers.emplace_back([&]() {
+				while(go.load() == false)
+				{
+				}
+
+				const auto ns = npas4::bench::NanosecondsPerCall(f, iterations);
+				totalNanoseconds += static_cast<int64_t>(ns * static_cast<double>(iterations));
+			});
+		}
+
+		go = true;
+
+		for(auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		return static_cast<double>(totalNanoseconds.load()) / static_cast<double>(iterations * threads);
+	}
+} // namespace
+
+int main()
+{
+	constexpr int64_t UncachedIterations{20000};
+	constexpr int64_t CachedIterations{2000000};
+
+	const auto maxThreads = std::max(4u, std::thread::hardware_concurrency());
+	std::cout << "TTL: " << npas4::cached::GetTTL().count() << " ns" << std::endl;
+
+	for(unsigned threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		std::stringstream ss;
+		ss << threads << " thread(s) ";
+
+		npas4::bench::Report(ss.str() + "GetRAMPhysicalAvailable",
+							 Contended([]() { npas4::bench::DoNotOptimize(npas4::GetRAMPhysicalAvailable()); }, threads, UncachedIterations));
+
+		npas4::bench::Report(ss.str() + "cached::GetRAMPhysicalAvailable",
+							 Contended([]() { npas4::bench::DoNotOptimize(npas4::cached::GetRAMPhysicalAvailable()); }, threads, CachedIterations));
+
+		npas4::bench::Report(ss.str() + "GetRAMPhysicalUsedByCurrentProcess",
+							 Contended([]() { npas4::bench::DoNotOptimize(npas4::GetRAMPhysicalUsedByCurrentProcess()); }, threads, UncachedIterations));
+
+		npas4::bench::Report(ss.str() + "cached::GetRAMPhysicalUsedByCurrentProcess",
+							 Contended([]() { npas4::bench::DoNotOptimize(npas4::cached::GetRAMPhysicalUsedByCurrentProcess()); }, threads, CachedIterations));
+	}
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// The cost CountingResource adds to each allocate/deallocate pair, over a malloc backed upstream and over a pool (where the wrapper's
+/// share of the time is easiest to see).
+///
+
+#include "Benchmark.h"
+
+#include <npas4/CountingResource.h>
+
+#include <algorithm>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+
+namespace
+{
+	void* volatile Sink{nullptr};
+
+	double AllocateDeallocate(std::pmr::memory_resource* x)
+	{
+		return npas4::bench::NanosecondsPerCall(
+			[x]() {
+				auto p = x->allocate(64);
+				Sink = p;
+				x->deallocate(p, 64);
+			},
+			5000000);
+	}
+
+	///
+	/// Runs each configuration several times, interleaved, and keeps the fastest.
+	///
+	void Run(const std::string& name, std::pmr::memory_resource* upstream)
+	{
+		const int repetitions{5};
+
+		npas4::CountingResource counting(upstream);
+
+		npas4::CountingResourceOptions options;
+		options.Budget = int64_t(1) << 40;
+		npas4::CountingResource budgeted(upstream, options);
+
+		double bare{1e300};
+		double wrapped{1e300};
+		double limited{1e300};
+
+		for(int i = 0; i < repetitions; ++i)
+		{
+			bare = std::min(bare, AllocateDeallocate(upstream));
+			wrapped = std::min(wrapped, AllocateDeallocate(&counting));
+			limited = std::min(limited, AllocateDeallocate(&budgeted));
+		}
+
+		npas4::bench::Report(name, bare);
+		npas4::bench::Report(name + " (counted)", wrapped);
+		npas4::bench::Report(name + " (counted, budget)", limited);
+
+		std::stringstream ss;
+		ss.precision(1);
+		ss << std::fixed << name << " overhead: " << wrapped - bare << " ns counted, " << limited - bare << " ns with a budget";
+		std::cout << ss.str() << std::endl;
+	}
+} // namespace
+
+int main()
+{
+	Run("new_delete_resource 64 bytes", std::pmr::new_delete_resource());
+
+	std::pmr::unsynchronized_pool_resource pool;
+	Run("unsynchronized_pool_resource 64 bytes", &pool);
+
+	std::pmr::synchronized_pool_resource shared;
+	Run("synchronized_pool_resource 64 bytes", &shared);
+
+	return 0;
+}
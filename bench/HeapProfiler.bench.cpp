@@ -0,0 +1,187 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// The cost of the sampling heap profiler: a bare operator new/delete pair, and a container workload, with the profiler stopped and
+/// running at the default 512 KB interval with each way of capturing stacks.  Exits with a failure if the container workload's overhead
+/// misses the 1% target.
+///
+
+#include "Benchmark.h"
+
+#include <npas4/HeapProfiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	void* volatile Sink{nullptr};
+
+	double NewDelete(int64_t iterations)
+	{
+		return npas4::bench::NanosecondsPerCall(
+			[]() {
+				auto x = new char[64];
+				Sink = x;
+				delete[] x;
+			},
+			iterations);
+	}
+
+	///
+	/// Builds, searches and destroys a map of short strings: allocation heavy, but with work between the allocations.
+	///
+	double Containers(int64_t iterations)
+	{
+		return npas4::bench::NanosecondsPerCall(
+			[]() {
+				std::map<int, std::string> x;
+
+				for(int i = 0; i < 1000; ++i)
+				{
+					x[i * 7919 % 1000] = std::string(40, static_cast<char>('a' + i % 26));
+				}
+
+				int64_t total{0};
+
+				for(int i = 0; i < 1000; ++i)
+				{
+					total += static_cast<int64_t>(x[i].size());
+				}
+
+				npas4::bench::DoNotOptimize(total);
+			},
+			iterations);
+	}
+
+	///
+	/// The median of a sample and a 95% confidence interval for it, from the order statistics around it.
+	///
+	struct Estimate
+	{
+		double Median;
+		double Low;
+		double High;
+	};
+
+	Estimate GetEstimate(std::vector<double> x)
+	{
+		std::sort(x.begin(), x.end());
+
+		const auto n = static_cast<double>(x.size());
+		const auto spread = static_cast<size_t>(0.98 * std::sqrt(n) + 1.0);
+		const auto middle = x.size() / 2;
+
+		Estimate e;
+		e.Median = x[middle];
+		e.Low = x[(middle > spread) ? middle - spread : 0];
+		e.High = x[std::min(middle + spread, x.size() - 1)];
+		return e;
+	}
+
+	///
+	/// The overhead the default configuration must stay under.
+	///
+	const double MaxOverhead{0.01};
+
+	std::string Percent(double ratio)
+	{
+		std::stringstream ss;
+		ss.precision(2);
+		ss << std::fixed << (ratio - 1.0) * 100.0 << "%";
+		return ss.str();
+	}
+
+	///
+	/// Measures the profiler at the default 512 KB interval directly, so the fixed costs of every call (the sampling countdown and operator
+	/// delete's alignment check) are included.  The overhead is far below the noise of any one run, so the workload is run in many short rounds,
+	/// each timing the three configurations back to back so that drifts in machine speed hit all of them alike.  The overhead reported is
+	/// the median over the rounds of each round's ratio.  (Not the fastest run: with exponentially spaced samples, the fastest runs are
+	/// the ones that happened to take the fewest samples.)
+	///
+	/// Returns the overhead of the default configuration, frame pointers.
+	///
+	Estimate Run(const std::string& name, double (*f)(int64_t), int64_t iterations, int rounds)
+	{
+		std::vector<double> stopped;
+		std::vector<double> walking;
+		std::vector<double> unwinding;
+
+		for(int i = 0; i < rounds; ++i)
+		{
+			double x[3];
+
+			// Rotates which configuration runs first, so that none gains from its place in the round.
+			for(int j = 0; j < 3; ++j)
+			{
+				const auto configuration = (i + j) % 3;
+
+				if(configuration == 0)
+				{
+					npas4::StopHeapProfiler();
+				}
+				else
+				{
+					npas4::HeapProfilerOptions options;
+					options.FramePointers = (configuration == 1);
+					npas4::StartHeapProfiler(options);
+				}
+
+				x[configuration] = f(iterations);
+			}
+
+			stopped.push_back(x[0]);
+			walking.push_back(x[1] / x[0]);
+			unwinding.push_back(x[2] / x[0]);
+		}
+
+		npas4::StopHeapProfiler();
+
+		const auto median = GetEstimate(stopped).Median;
+		const auto walkingRatio = GetEstimate(walking);
+		const auto unwindingRatio = GetEstimate(unwinding);
+
+		npas4::bench::Report(name + " (stopped)", median);
+		npas4::bench::Report(name + " (512 KB, frame pointers)", median * walkingRatio.Median);
+		npas4::bench::Report(name + " (512 KB, backtrace)", median * unwindingRatio.Median);
+
+		std::cout << name << " overhead at 512 KB: " << Percent(walkingRatio.Median) << " frame pointers (95% CI " << Percent(walkingRatio.Low)
+				  << " to " << Percent(walkingRatio.High) << "), " << Percent(unwindingRatio.Median) << " backtrace" << std::endl;
+
+		return walkingRatio;
+	}
+} // namespace
+
+int main()
+{
+	// Rounds of 200K pairs of 64 bytes, and of 20 maps of 1000 nodes of about 120 bytes: about 25 and 5 samples a round.
+	// The pairs are the worst case, with no work of the program's own to spread a sample's cost over.  The maps are the workload the 1%
+	// target is for, and are run for more rounds, to narrow the interval around their overhead well inside the target.
+	Run("new/delete 64 bytes", &NewDelete, 200000, 401);
+	const auto overhead = Run("map<int, string> x 1000", &Containers, 20, 1201);
+	const auto pass = (overhead.Median - 1.0 < MaxOverhead);
+
+	std::cout << "Target: map<int, string> x 1000 overhead at 512 KB under " << Percent(1.0 + MaxOverhead) << ": "
+			  << ((pass == true) ? "PASS" : "FAIL") << std::endl;
+
+	std::cout << static_cast<std::string>(npas4::GetHeapProfileReport());
+	return (pass == true) ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Compares the single pass, perfect hash procfs tokenizer against the fgets + strncmp + atoi path the library used previously.
+///
+
+#include "Benchmark.h"
+
+#include <ProcParser.h>
+#include <npas4/Npas4.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	constexpr int BufferSize{128};
+	constexpr int64_t Kilobytes2Bytes{1024};
+
+	std::string ReadFile(const char* path)
+	{
+		std::ifstream file(path);
+		std::stringstream ss;
+		ss << file.rdbuf();
+		return ss.str();
+	}
+
+	// The original implementation, verbatim.
+	int ParseLine(char* line)
+	{
+		const auto i = strlen(line);
+
+		while(*line < '0' || *line > '9')
+		{
+			line++;
+		}
+
+		line[i - 3] = '\0';
+		return atoi(line);
+	}
+
+	// The original per-field loop, one strncmp per key per line.
+	int64_t LegacyParseStatus(FILE* file)
+	{
+		char line[BufferSize];
+		int64_t rss = 0;
+		int64_t hwm = 0;
+		int64_t size = 0;
+
+		while(fgets(line, BufferSize, file) != nullptr)
+		{
+			if(strncmp(line, "VmRSS:", 6) == 0)
+			{
+				rss = ParseLine(line) * Kilobytes2Bytes;
+			}
+			else if(strncmp(line, "VmHWM:", 6) == 0)
+			{
+				hwm = ParseLine(line) * Kilobytes2Bytes;
+			}
+			else if(strncmp(line, "VmSize:", 7) == 0)
+			{
+				size = ParseLine(line) * Kilobytes2Bytes;
+			}
+		}
+
+		return rss + hwm + size;
+	}
+
+	int64_t LegacyParseMeminfo(FILE* file)
+	{
+		char line[BufferSize];
+		int64_t total = 0;
+
+		while(fgets(line, BufferSize, file) != nullptr)
+		{
+			if(strncmp(line, "MemTotal:", 9) == 0 || strncmp(line, "MemFree:", 8) == 0 || strncmp(line, "MemAvailable:", 13) == 0
+			   || strncmp(line, "Cached:", 7) == 0 || strncmp(line, "SwapTotal:", 10) == 0 || strncmp(line, "SwapFree:", 9) == 0)
+			{
+				total += ParseLine(line) * Kilobytes2Bytes;
+			}
+		}
+
+		return total;
+	}
+} // namespace
+
+int main()
+{
+	constexpr int64_t ParseIterations{200000};
+	constexpr int64_t ReadIterations{20000};
+
+	auto status = ReadFile("/proc/self/status");
+	auto meminfo = ReadFile("/proc/meminfo");
+
+	std::cout << "/proc/self/status: " << status.size() << " bytes, /proc/meminfo: " << meminfo.size() << " bytes" << std::endl;
+
+	// Parse only.  fmemopen() lets the legacy path run its fgets loop over the same bytes without touching procfs.
+	npas4::bench::Report("status: fgets + strncmp + atoi", npas4::bench::NanosecondsPerCall(
+															   [&status]() {
+																   auto file = fmemopen(&status[0], status.size(), "r");
+																   npas4::bench::DoNotOptimize(LegacyParseStatus(file));
+																   fclose(file);
+															   },
+															   ParseIterations));
+
+	npas4::bench::Report("status: ParseKeyValues", npas4::bench::NanosecondsPerCall(
+													   [&status]() {
+														   npas4::impl::StatusFields fields;
+														   npas4::impl::ParseKeyValues(status.data(), status.size(), fields);
+														   npas4::bench::DoNotOptimize(fields.VmRSS + fields.VmHWM + fields.VmSize);
+													   },
+													   ParseIterations));
+
+	npas4::bench::Report("meminfo: fgets + strncmp + atoi", npas4::bench::NanosecondsPerCall(
+																[&meminfo]() {
+																	auto file = fmemopen(&meminfo[0], meminfo.size(), "r");
+																	npas4::bench::DoNotOptimize(LegacyParseMeminfo(file));
+																	fclose(file);
+																},
+																ParseIterations));
+
+	npas4::bench::Report("meminfo: ParseKeyValues", npas4::bench::NanosecondsPerCall(
+														[&meminfo]() {
+															npas4::impl::MeminfoFields fields;
+															npas4::impl::ParseKeyValues(meminfo.data(), meminfo.size(), fields);
+															npas4::bench::DoNotOptimize(fields.MemTotal + fields.MemAvailable);
+														},
+														ParseIterations));
+
+	// Read and parse, including the kernel's cost of producing the file.
+	npas4::bench::Report("status: fopen + fgets + strncmp + atoi", npas4::bench::NanosecondsPerCall(
+																	   []() {
+																		   auto file = fopen("/proc/self/status", "r");
+																		   npas4::bench::DoNotOptimize(LegacyParseStatus(file));
+																		   fclose(file);
+																	   },
+																	   ReadIterations));
+
+	npas4::bench::Report("status: GetRAMPhysicalUsedByCurrentProcess", npas4::bench::NanosecondsPerCall(
+																		   []() { npas4::bench::DoNotOptimize(npas4::GetRAMPhysicalUsedByCurrentProcess()); },
+																		   ReadIterations));
+
+	npas4::SetProcessQueryMode(npas4::ProcessQueryMode::LowLatency);
+	npas4::bench::Report("statm: GetRAMPhysicalUsedByCurrentProcess", npas4::bench::NanosecondsPerCall(
+																		  []() { npas4::bench::DoNotOptimize(npas4::GetRAMPhysicalUsedByCurrentProcess()); },
+																		  ReadIterations));
+	npas4::SetProcessQueryMode(npas4::ProcessQueryMode::Status);
+
+	return 0;
+}
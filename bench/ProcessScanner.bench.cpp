@@ -0,0 +1,102 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Whole-system scan benchmark over a synthetic /proc tree (50,000 processes by default, or argv[1]), with 1..N scanning threads.
+///
+
+#include "Benchmark.h"
+
+#include <npas4/ProcessScanner.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	std::string MakeFakeProc(int64_t processes)
+	{
+		char path[] = "/tmp/npas4-bench-proc-XXXXXX";
+		const std::string root = mkdtemp(path);
+
+		for(int64_t pid = 1; pid <= processes; ++pid)
+		{
+			const auto directory = root + "/" + std::to_string(pid);
+			mkdir(directory.c_str(), 0755);
+
+			// Vary the sizes so the top-N sort has work to do.
+			const auto resident = (pid * 7919) % 100000;
+			std::ofstream(directory + "/statm") << resident * 4 << " " << resident << " 100 10 0 500 0\n";
+			std::ofstream(directory + "/smaps_rollup") << "00400000-7fff0000 ---p 00000000 00:00 0 [rollup]\n"
+													   << "Rss:        " << resident * 4 << " kB\n"
+													   << "Pss:        " << resident * 3 << " kB\n"
+													   << "Shared_Clean:        " << resident << " kB\n"
+													   << "Private_Clean:        0 kB\n"
+													   << "Private_Dirty:        " << resident * 3 << " kB\n"
+													   << "Swap:        0 kB\n";
+		}
+
+		return root;
+	}
+
+	void RemoveFakeProc(const std::string& root)
+	{
+		nftw(root.c_str(), [](const char* x, const struct stat*, int, struct FTW*) { return remove(x); }, 16, FTW_DEPTH | FTW_PHYS);
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const int64_t processes = (argc > 1) ? std::atoll(argv[1]) : 50000;
+	constexpr int64_t Iterations{5};
+
+	std::cout << "Building a fake /proc with " << processes << " processes..." << std::endl;
+	const auto root = MakeFakeProc(processes);
+
+	const auto maxThreads = std::max(4u, std::thread::hardware_concurrency());
+
+	for(unsigned threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		npas4::ProcessScanner scanner(threads, root);
+
+		std::stringstream ss;
+		ss << threads << " thread(s) ";
+
+		npas4::ScanOptions statm;
+		statm.Top = 20;
+
+		npas4::bench::Report(ss.str() + "Scan statm, top 20",
+							 npas4::bench::NanosecondsPerCall([&]() { npas4::bench::DoNotOptimize(scanner.Scan(statm).Size()); }, Iterations));
+
+		npas4::ScanOptions smaps;
+		smaps.SortBy = npas4::ScanKey::ProportionalUsed;
+		smaps.Top = 20;
+
+		npas4::bench::Report(ss.str() + "Scan statm + smaps_rollup, top 20",
+							 npas4::bench::NanosecondsPerCall([&]() { npas4::bench::DoNotOptimize(scanner.Scan(smaps).Size()); }, Iterations));
+	}
+
+	RemoveFakeProc(root);
+	return 0;
+}
@@ -0,0 +1,104 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Batched procfs reads: io_uring against one pread() per file, for a single snapshot and for a batch of many processes' files.
+///
+
+#include "Benchmark.h"
+
+#include <ReadBatch.h>
+#include <npas4/SnapshotReader.h>
+
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+	///
+	/// Reads every file in 'files' once per call, through 'batch'.
+	///
+	double ReadAll(npas4::impl::ReadBatch& batch, const std::vector<int>& files, int64_t iterations)
+	{
+		std::vector<char> buffers(files.size() * 4096);
+
+		return npas4::bench::NanosecondsPerCall(
+			[&]() {
+				batch.Clear();
+
+				for(size_t i = 0; i < files.size(); ++i)
+				{
+					batch.Add(files[i], &buffers[i * 4096], 4095);
+				}
+
+				batch.Submit();
+				npas4::bench::DoNotOptimize(batch.Result(0));
+			},
+			iterations);
+	}
+} // namespace
+
+int main()
+{
+	constexpr int64_t Iterations{2000};
+
+	npas4::impl::ReadBatch ring(256);
+	npas4::impl::ReadBatch pread(256, npas4::impl::ReadBatch::Backend::Pread);
+	std::cout << "io_uring available: " << (ring.IsRing() ? "yes" : "no") << std::endl;
+
+	const std::vector<int> snapshot{open("/proc/meminfo", O_RDONLY), open("/proc/self/status", O_RDONLY), open("/proc/self/statm", O_RDONLY),
+									open("/proc/self/smaps_rollup", O_RDONLY)};
+
+	npas4::bench::Report("Snapshot (4 files) pread", ReadAll(pread, snapshot, Iterations));
+	npas4::bench::Report("Snapshot (4 files) io_uring", ReadAll(ring, snapshot, Iterations));
+
+	// Stands in for the status and statm files of many monitored processes.
+	for(size_t count = 16; count <= 256; count *= 4)
+	{
+		std::vector<int> files;
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			files.push_back(open((i % 2 == 0) ? "/proc/self/status" : "/proc/self/statm", O_RDONLY));
+		}
+
+		std::stringstream ss;
+		ss << "Batch of " << count << " files ";
+
+		npas4::bench::Report(ss.str() + "pread", ReadAll(pread, files, Iterations / 10));
+		npas4::bench::Report(ss.str() + "io_uring", ReadAll(ring, files, Iterations / 10));
+
+		for(const auto fd : files)
+		{
+			close(fd);
+		}
+	}
+
+	npas4::SnapshotReader reader;
+	npas4::bench::Report("SnapshotReader::GetRAMReport",
+						 npas4::bench::NanosecondsPerCall([&]() { npas4::bench::DoNotOptimize(reader.GetRAMReport().RamPhysicalUsedByCurrentProcess); },
+														  Iterations));
+
+	for(const auto fd : snapshot)
+	{
+		close(fd);
+	}
+
+	return 0;
+}
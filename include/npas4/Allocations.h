@@ -0,0 +1,99 @@
+#ifndef H_NPAS4_ALLOCATIONS_H
+#define H_NPAS4_ALLOCATIONS_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Accounting for the global operator new and operator delete.
+///
+/// These functions live in the separate npas4hooks library, which replaces the global operator new and delete of any program it is linked
+/// into.  Every allocation then goes to malloc() and is counted.  Nothing is counted (and these functions are not available) in programs
+/// that only link npas4.
+///
+/// The npas4tags library is npas4hooks plus memory tags (MemoryTag.h).  Link one or the other, not both.
+///
+
+#include <npas4/Npas4.h>
+
+#include <chrono>
+#include <string>
+
+namespace npas4
+{
+	///
+	/// Cumulative operator new / operator delete counters.  Byte counts are the allocator's usable size of each block
+	/// (malloc_usable_size()), which is at least the size requested, so LiveBytes matches what the heap actually holds.
+	///
+	struct AllocationReport
+	{
+		///
+		/// Bytes allocated and not yet freed.  A thread's report may be negative: it counts what the thread freed, wherever it was
+		/// allocated.
+		///
+		int64_t LiveBytes{0};
+
+		///
+		/// Bytes ever allocated and ever freed.
+		///
+		int64_t AllocatedBytes{0};
+		int64_t FreedBytes{0};
+
+		///
+		/// Calls to operator new and operator delete (of a non-null pointer).
+		///
+		int64_t Allocations{0};
+		int64_t Deallocations{0};
+
+		///
+		/// When the report was taken.
+		///
+		std::chrono::steady_clock::time_point Time;
+
+		operator std::string();
+		npas4::AllocationReport operator-(const npas4::AllocationReport& x);
+	};
+
+	///
+	/// AllocationReport counters per second.
+	///
+	struct AllocationRates
+	{
+		double Allocations{0.0};
+		double Deallocations{0.0};
+		double AllocatedBytes{0.0};
+		double FreedBytes{0.0};
+	};
+
+	///
+	/// Sums every thread's counters.  Lock free, and never allocates, but the sum is not an atomic snapshot: allocations made by other
+	/// threads while it is taken may or may not be included.
+	///
+	NPAS4_EXPORT npas4::AllocationReport GetAllocationReport();
+
+	///
+	/// The calling thread's counters, since the thread's first allocation.  Zero if the thread could not be given counters of its own (more
+	/// than a few hundred threads allocating at once).
+	///
+	NPAS4_EXPORT npas4::AllocationReport GetThreadAllocationReport();
+
+	///
+	/// The rates between two reports, e.g. taken either side of a hot loop.  Zero if 'after' was not taken after 'before'.
+	///
+	NPAS4_EXPORT npas4::AllocationRates GetAllocationRates(const npas4::AllocationReport& before, const npas4::AllocationReport& after);
+} // namespace npas4
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef H_NPAS4_ARENA_H
+#define H_NPAS4_ARENA_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Bump arenas and fixed size pools (Pool.h) that report their footprint, for allocation heavy code that has outgrown malloc.
+///
+
+#include <npas4/Npas4.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace npas4
+{
+	///
+	/// The footprint of one arena or pool.
+	///
+	struct ArenaReport
+	{
+		std::string Name;
+
+		///
+		/// "arena" or "pool".
+		///
+		std::string Type;
+
+		///
+		/// Bytes obtained from malloc() for chunks (arenas) or slabs (pools), whether or not anything is allocated from them yet.
+		///
+		int64_t CommittedBytes{0};
+
+		///
+		/// Bytes handed out and not yet reset (arenas) or freed (pools).  An arena's includes alignment padding.
+		///
+		int64_t UsedBytes{0};
+
+		///
+		/// The most UsedBytes has been.  A pool's is the most it has carved from its slabs, which also counts blocks freed to its caches.
+		///
+		int64_t PeakUsedBytes{0};
+
+		operator std::string();
+	};
+
+	///
+	/// \class Arena
+	///
+	/// A chunked bump allocator: each allocation advances a pointer through the current chunk, and nothing is freed until Reset(), which
+	/// rewinds to the first chunk in constant time and keeps every chunk for reuse.  Destructors of objects placed in the arena are never
+	/// run.
+	///
+	/// An arena is not thread safe, except that its report may be read from any thread (approximately, while it is being allocated from).
+	/// Every arena is listed by GetArenaReports().
+	///
+	class NPAS4_EXPORT Arena
+	{
+	public:
+		///
+		/// 'chunkSize' is the size of each chunk obtained from malloc(); larger allocations get a chunk of their own.  The first chunk is
+		/// obtained at construction.  The name is copied.
+		///
+		explicit Arena(const char* name = "arena", size_t chunkSize = 64 * 1024);
+		~Arena();
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		///
+		/// 'alignment' must be a power of two.  Throws std::bad_alloc if a new chunk cannot be obtained.
+		///
+		void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+		{
+			const auto position = reinterpret_cast<uintptr_t>(this->current.load(std::memory_order_relaxed));
+			const auto aligned = (position + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+
+			if(aligned <= this->end && this->end - aligned >= bytes)
+			{
+				this->current.store(reinterpret_cast<char*>(aligned + bytes), std::memory_order_relaxed);
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			return this->grow(bytes, alignment);
+		}
+
+		///
+		/// Forgets everything allocated, in constant time.  Chunks are kept, and reused in order.
+		///
+		void Reset();
+
+		///
+		/// Reset(), and return every chunk but the first to the system.
+		///
+		void Release();
+
+		npas4::ArenaReport GetReport() const;
+
+	private:
+		void* grow(size_t bytes, size_t alignment);
+
+		std::atomic<char*> current{nullptr};
+		uintptr_t end{0};
+
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+
+	///
+	/// Every arena and pool alive, largest CommittedBytes first.
+	///
+	NPAS4_EXPORT std::vector<npas4::ArenaReport> GetArenaReports();
+} // namespace npas4
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef H_NPAS4_BUDGET_H
+#define H_NPAS4_BUDGET_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Admission control: deciding whether there is memory for a large piece of work before it starts allocating.
+///
+
+#include <npas4/Npas4.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace npas4
+{
+	struct BudgetOptions
+	{
+		///
+		/// The most that may be reserved at once, whatever memory is available.  Zero for no cap.
+		///
+		int64_t Cap{0};
+
+		///
+		/// Memory to leave unreserved: the limit is what is available less this.
+		///
+		int64_t Headroom{0};
+
+		///
+		/// Limit reservations to the memory available on the system (GetRAMPhysicalAvailable(), MemAvailable on Linux), and to the memory
+		/// available to the process's cgroup (GetRAMCgroupAvailable()).
+		///
+		bool UsePhysicalAvailable{true};
+		bool UseCgroupAvailable{true};
+
+		///
+		/// How often the available memory is re-read, by a thread of the budget's own.  Zero for no thread: the limit then only changes on
+		/// Refresh() and SetCap().
+		///
+		std::chrono::nanoseconds Interval{std::chrono::milliseconds(100)};
+	};
+
+	struct BudgetReport
+	{
+		///
+		/// The most that may be reserved at once: the smaller of the cap and the available memory (less the headroom) plus what was
+		/// reserved when it was read, as of the last refresh.  -1 if there is no limit at all.
+		///
+		int64_t Limit{-1};
+
+		///
+		/// The available memory read by the last refresh (the smaller of the physical and cgroup values in use), or -1 if neither is used.
+		///
+		int64_t Available{-1};
+
+		int64_t Reserved{0};
+
+		///
+		/// Calls to Reserve() that succeeded, and that were refused.
+		///
+		int64_t Reservations{0};
+		int64_t Refused{0};
+
+		int64_t Refreshes{0};
+
+		operator std::string();
+	};
+
+	///
+	/// \class Budget
+	///
+	/// Callers Reserve() the memory a piece of work will need before starting it, and Release() it afterwards.  A reservation is refused if
+	/// it would take the total reserved past the limit, so work that cannot fit is turned away before it allocates, rather than the process
+	/// being killed once it has.
+	///
+	/// Reserving and releasing are lock free: an atomic add, or a compare and swap loop against the limit.  The limit is recomputed by a
+	/// background thread every Interval.
+	///
+	/// The available memory already excludes what reserved work has allocated, so each refresh adds back the total reserved at the time:
+	/// the limit on the sum of reservations is the available memory, less the headroom, plus what was reserved when it was read.  This
+	/// assumes that work holding a reservation at a refresh has allocated it; work that reserves and then allocates slowly, over several
+	/// intervals, may see later work admitted against memory it has yet to take, which the headroom should allow for.
+	///
+	/// \code
+	/// npas4::Budget budget;
+	/// npas4::ScopedReservation reservation(budget, job.GetEstimatedBytes());
+	///
+	/// if(reservation.IsReserved() == true)
+	/// {
+	///		job.Run();
+	/// }
+	/// \endcode
+	///
+	class NPAS4_EXPORT Budget
+	{
+	public:
+		explicit Budget(const npas4::BudgetOptions& x = npas4::BudgetOptions());
+		~Budget();
+
+		Budget(const Budget&) = delete;
+		Budget& operator=(const Budget&) = delete;
+
+		///
+		/// Returns false, reserving nothing, if 'bytes' does not fit under the limit.  Reserving zero or fewer bytes always succeeds.
+		///
+		bool Reserve(int64_t bytes);
+
+		///
+		/// Returns bytes reserved by a successful Reserve().
+		///
+		void Release(int64_t bytes);
+
+		///
+		/// Re-reads the available memory and recomputes the limit now.
+		///
+		void Refresh();
+
+		///
+		/// Changes the cap (zero for none), recomputing the limit from the last available memory read.
+		///
+		void SetCap(int64_t x);
+
+		npas4::BudgetReport GetReport() const;
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+
+	///
+	/// \class ScopedReservation
+	///
+	/// Reserves from a Budget for the lifetime of the object, if the reservation fits.
+	///
+	class NPAS4_EXPORT ScopedReservation
+	{
+	public:
+		ScopedReservation(npas4::Budget& budget, int64_t bytes);
+		~ScopedReservation();
+
+		ScopedReservation(const ScopedReservation&) = delete;
+		ScopedReservation& operator=(const ScopedReservation&) = delete;
+
+		bool IsReserved() const;
+
+	private:
+		npas4::Budget& budget;
+		const int64_t bytes;
+		const bool reserved;
+	};
+} // namespace npas4
+
+#endif
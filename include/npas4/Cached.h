@@ -0,0 +1,83 @@
+#ifndef H_NPAS4_CACHED_H
+#define H_NPAS4_CACHED_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <chrono>
+
+///
+/// \namespace npas4::cached
+///
+/// Drop-in replacements for the npas4 query functions for callers that query thousands of times per second from many threads.
+///
+/// Each underlying source (the system query, the process query, the cgroup query, and the smaps query) is refreshed at most once per TTL, process wide.  Values are shared
+/// through seqlock protected storage: readers never take a lock, and when a value expires exactly one caller refreshes it while every other
+/// caller keeps returning the previous value.  Values may therefore be up to one TTL (plus the cost of one refresh) old.
+///
+/// The process values always come from /proc/self/status; the ProcessQueryMode setting does not apply.
+///
+/// As with npas4::GetRAMReport(), GetRAMReport() leaves PSS and USS zero, so it never refreshes the smaps source.
+///
+namespace npas4
+{
+	namespace cached
+	{
+		///
+		/// Sets the maximum age of cached values for all threads.  The default is 10 milliseconds.  A TTL of zero refreshes on every call.
+		///
+		NPAS4_EXPORT void SetTTL(std::chrono::nanoseconds x);
+
+		NPAS4_EXPORT std::chrono::nanoseconds GetTTL();
+
+		///
+		/// Expires every cached value so the next query of each source refreshes it.  A refresh already under way when this is called
+		/// publishes its value already expired, so the next query still refreshes.
+		///
+		NPAS4_EXPORT void Invalidate();
+
+		NPAS4_EXPORT int64_t GetRAMSystemTotal();
+		NPAS4_EXPORT int64_t GetRAMSystemAvailable();
+		NPAS4_EXPORT int64_t GetRAMSystemUsed();
+		NPAS4_EXPORT int64_t GetRAMSystemUsedByCurrentProcess();
+
+		NPAS4_EXPORT int64_t GetRAMPhysicalTotal();
+		NPAS4_EXPORT int64_t GetRAMPhysicalAvailable();
+		NPAS4_EXPORT int64_t GetRAMPhysicalUsed();
+		NPAS4_EXPORT int64_t GetRAMPhysicalUsedByCurrentProcess();
+		NPAS4_EXPORT int64_t GetRAMPhysicalUsedByCurrentProcessPeak();
+
+		NPAS4_EXPORT int64_t GetRAMVirtualTotal();
+		NPAS4_EXPORT int64_t GetRAMVirtualAvailable();
+		NPAS4_EXPORT int64_t GetRAMVirtualUsed();
+		NPAS4_EXPORT int64_t GetRAMVirtualUsedByCurrentProcess();
+
+		NPAS4_EXPORT int64_t GetRAMProportionalUsedByCurrentProcess();
+		NPAS4_EXPORT int64_t GetRAMUniqueUsedByCurrentProcess();
+
+		NPAS4_EXPORT int64_t GetRAMCgroupTotal();
+		NPAS4_EXPORT int64_t GetRAMCgroupAvailable();
+		NPAS4_EXPORT int64_t GetRAMCgroupUsed();
+
+		NPAS4_EXPORT npas4::RAMReport GetRAMReport();
+	} // namespace cached
+} // namespace npas4
+
+#endif
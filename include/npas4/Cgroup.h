@@ -0,0 +1,104 @@
+#ifndef H_NPAS4_CGROUP_H
+#define H_NPAS4_CGROUP_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <string>
+
+namespace npas4
+{
+	///
+	/// The cgroup hierarchy that controls the memory of a process.
+	///
+	enum class CgroupVersion : int
+	{
+		///
+		/// The process is not in a memory controlled cgroup, or the platform has no cgroups.
+		///
+		None,
+
+		///
+		/// The legacy per-controller hierarchy, mounted at /sys/fs/cgroup/memory.
+		///
+		V1,
+
+		///
+		/// The unified hierarchy, mounted at /sys/fs/cgroup.
+		///
+		V2
+	};
+
+	///
+	/// The memory limits and usage of the cgroup the current process belongs to.  All values are in bytes.
+	///
+	/// Limits are effective limits: the smallest limit set on the process's cgroup or any of its ancestors.  A limit of -1 means unlimited.
+	///
+	struct CgroupReport
+	{
+		npas4::CgroupVersion Version{npas4::CgroupVersion::None};
+
+		///
+		/// The hard limit.  (memory.max, or memory.limit_in_bytes on v1.)
+		///
+		int64_t MemoryMax{-1};
+
+		///
+		/// The throttling limit.  (memory.high, or memory.soft_limit_in_bytes on v1.)
+		///
+		int64_t MemoryHigh{-1};
+
+		///
+		/// Memory charged to the cgroup, including page cache.  (memory.current, or memory.usage_in_bytes on v1.)
+		///
+		int64_t MemoryCurrent{0};
+
+		///
+		/// Page cache on the cgroup's inactive list, which the kernel reclaims before the cgroup reaches its limit.  (inactive_file in
+		/// memory.stat, or total_inactive_file on v1.)  MemoryCurrent minus this is the cgroup's working set.
+		///
+		int64_t InactiveFile{0};
+
+		///
+		/// The swap limit.  (memory.swap.max, or memory.memsw.limit_in_bytes minus memory.limit_in_bytes on v1.)
+		///
+		int64_t SwapMax{-1};
+
+		///
+		/// Swap charged to the cgroup.  (memory.swap.current, or memory.memsw.usage_in_bytes minus memory.usage_in_bytes on v1.)
+		///
+		int64_t SwapCurrent{0};
+
+		operator std::string();
+	};
+
+	///
+	/// Reports on the cgroup of the current process.  The cgroup is located once per process; each call re-reads its memory files.
+	///
+	NPAS4_EXPORT npas4::CgroupReport GetCgroupReport();
+
+	///
+	/// Reports on the cgroup named in <root>/proc/self/cgroup, reading the hierarchy under <root>/sys/fs/cgroup.  Intended for testing
+	/// against a fake filesystem.  GetCgroupReport() is equivalent to GetCgroupReport("").
+	///
+	NPAS4_EXPORT npas4::CgroupReport GetCgroupReport(const std::string& root);
+} // namespace npas4
+
+#endif
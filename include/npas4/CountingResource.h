@@ -0,0 +1,167 @@
+#ifndef H_NPAS4_COUNTINGRESOURCE_H
+#define H_NPAS4_COUNTINGRESOURCE_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Accounting for std::pmr containers.  Part of the npas4pmr library, which (unlike the rest of npas4) requires C++17 and is only built
+/// when the compiler provides <memory_resource>.
+///
+
+#include <npas4/Npas4.h>
+
+#include <atomic>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace npas4
+{
+	struct CountingResourceOptions
+	{
+		///
+		/// The most bytes that may be live from the upstream resource at once.  Zero for no limit.
+		///
+		int64_t Budget{0};
+
+		///
+		/// Where allocations that would exceed the budget go instead.  If null, they throw std::bad_alloc.
+		///
+		std::pmr::memory_resource* Fallback{nullptr};
+	};
+
+	///
+	/// Byte counts are the sizes requested, as std::pmr passes them to deallocate() too.
+	///
+	struct CountingResourceReport
+	{
+		int64_t LiveBytes{0};
+
+		///
+		/// The most LiveBytes has been, as seen each time a thread reserved more of the budget: it may be off by up to 64 KB per thread.
+		///
+		int64_t PeakBytes{0};
+
+		int64_t AllocatedBytes{0};
+		int64_t Allocations{0};
+		int64_t Deallocations{0};
+
+		///
+		/// Allocations refused by the budget: sent to the fallback resource, or thrown.  Bytes live in the fallback are not in LiveBytes.
+		///
+		int64_t FallbackLiveBytes{0};
+		int64_t FallbackAllocations{0};
+		int64_t Refused{0};
+
+		operator std::string();
+		npas4::CountingResourceReport operator-(const npas4::CountingResourceReport& x);
+	};
+
+	///
+	/// \class CountingResource
+	///
+	/// A std::pmr::memory_resource that counts what passes through it to an upstream resource, and can hold it to a budget.
+	///
+	/// \code
+	/// npas4::CountingResource counting;
+	/// std::pmr::vector<int> x(&counting);
+	/// \endcode
+	///
+	/// As with the operator new hooks (Allocations.h), each thread counts in a shard of its own with plain relaxed stores, and draws on the
+	/// budget in chunks (64 KB, or less for small budgets), so most calls cost a few nanoseconds on top of the upstream resource and never
+	/// contend.  Threads may each hold up to two chunks they are not using, so an allocation can be refused a little before the budget is
+	/// reached.  Thread safe if the upstream and fallback resources are.  About 4 KB in size.
+	///
+	class NPAS4_EXPORT CountingResource : public std::pmr::memory_resource
+	{
+	public:
+		///
+		/// Threads beyond this many share one shard, updated with atomic additions, and reserve their allocations from the budget one at a
+		/// time.
+		///
+		static constexpr size_t ShardCount{64};
+
+		explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource(),
+								  const npas4::CountingResourceOptions& x = npas4::CountingResourceOptions());
+		~CountingResource() override;
+
+		CountingResource(const CountingResource&) = delete;
+		CountingResource& operator=(const CountingResource&) = delete;
+
+		std::pmr::memory_resource* GetUpstream() const;
+
+		///
+		/// Changes the budget (zero for none).  Lowering it below LiveBytes frees nothing; allocations are refused until enough is freed.
+		///
+		void SetBudget(int64_t x);
+		int64_t GetBudget() const;
+
+		///
+		/// Lock free.  As with GetAllocationReport(), not an atomic snapshot while other threads allocate.
+		///
+		npas4::CountingResourceReport GetReport() const;
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& x) const noexcept override;
+
+	private:
+		struct alignas(64) Shard
+		{
+			std::atomic<int64_t> Live{0};
+			std::atomic<int64_t> Reserved{0};
+			std::atomic<int64_t> AllocatedBytes{0};
+			std::atomic<int64_t> Allocations{0};
+			std::atomic<int64_t> Deallocations{0};
+		};
+
+		bool reserve(Shard& shard, int64_t live);
+		void* allocateShared(size_t bytes, size_t alignment);
+		void deallocateShared(void* p, size_t bytes, size_t alignment);
+		void* allocateFallback(size_t bytes, size_t alignment);
+
+		std::pmr::memory_resource* const upstream;
+		std::pmr::memory_resource* const fallback;
+
+		///
+		/// The last shard is shared by threads that found no other free.
+		///
+		Shard shards[ShardCount + 1];
+
+		///
+		/// The sum of the shards' reservations.  Only written when a thread takes or returns a chunk.
+		///
+		alignas(64) std::atomic<int64_t> reserved{0};
+		std::atomic<int64_t> budget{0};
+		std::atomic<int64_t> chunk{0};
+		std::atomic<int64_t> peak{0};
+
+		///
+		/// Blocks from the fallback resource, so they can be returned to it.  Only searched while there are any.
+		///
+		alignas(64) std::atomic<int64_t> fallbackCount{0};
+		std::atomic<int64_t> fallbackLive{0};
+		std::atomic<int64_t> fallbackAllocations{0};
+		std::atomic<int64_t> refused{0};
+		std::mutex fallbackLock;
+		std::unordered_set<void*> fallbackBlocks;
+	};
+} // namespace npas4
+
+#endif
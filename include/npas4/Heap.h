@@ -0,0 +1,132 @@
+#ifndef H_NPAS4_HEAP_H
+#define H_NPAS4_HEAP_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <string>
+#include <vector>
+
+namespace npas4
+{
+	///
+	/// The state of the C heap (malloc) of the current process, in bytes, from the allocator's point of view rather than the kernel's.
+	///
+	/// Only populated with glibc, from mallinfo2() (or mallinfo(), whose fields wrap at 2 GB, before glibc 2.33).  Elsewhere every field is
+	/// zero.  The values are summed over every arena.
+	///
+	/// https://man7.org/linux/man-pages/man3/mallinfo.3.html
+	///
+	struct HeapReport
+	{
+		///
+		/// Memory obtained from the system for the heap (arenas), excluding chunks allocated with mmap().  (arena)
+		///
+		int64_t Arena{0};
+
+		///
+		/// Memory in chunks allocated with mmap(), and the number of them.  Returned to the system as soon as they are freed.  (hblkhd, hblks)
+		///
+		int64_t Mmap{0};
+		int64_t MmapCount{0};
+
+		///
+		/// Memory in allocated chunks.  (uordblks)
+		///
+		int64_t InUse{0};
+
+		///
+		/// Memory in free chunks, held by the allocator but not in use, and the number of them.  (fordblks, ordblks)
+		///
+		int64_t Free{0};
+		int64_t FreeCount{0};
+
+		///
+		/// The part of Free in fastbins.  (fsmblks)
+		///
+		int64_t FreeFastBins{0};
+
+		///
+		/// The part of Free at the top of the main heap, which malloc_trim() can return to the system without madvise().  (keepcost)
+		///
+		int64_t TopReleasable{0};
+
+		///
+		/// Free / Arena: the share of the heap the allocator holds but the program is not using.  Zero for an empty heap.  A ratio that
+		/// stays high while the process is idle means freed memory is scattered between live chunks and cannot be returned to the system.
+		///
+		double GetFragmentation() const;
+
+		operator std::string();
+		npas4::HeapReport operator-(const npas4::HeapReport& x);
+	};
+
+	///
+	/// One malloc arena, as reported by malloc_info().
+	///
+	struct HeapArenaReport
+	{
+		///
+		/// The arena's number.  Zero is the main arena, which grows with brk().
+		///
+		int64_t Index{0};
+
+		///
+		/// Free chunks held by the arena (fastbins and the rest), in bytes and in number.
+		///
+		int64_t Free{0};
+		int64_t FreeCount{0};
+
+		///
+		/// Memory the arena currently has from the system, and the most it has ever had.
+		///
+		int64_t System{0};
+		int64_t SystemMax{0};
+
+		///
+		/// The address space the arena has reserved.
+		///
+		int64_t AddressSpace{0};
+
+		///
+		/// Free / System.
+		///
+		double GetFragmentation() const;
+	};
+
+	///
+	/// Returns mallinfo2().  Takes every arena's lock, but makes no system call.
+	///
+	NPAS4_EXPORT npas4::HeapReport GetHeapReport();
+
+	///
+	/// Returns one report per arena, parsed from malloc_info()'s XML.  Much more expensive than GetHeapReport(): malloc_info() walks every free
+	/// chunk of every arena.  Empty where malloc_info() is not available.
+	///
+	NPAS4_EXPORT std::vector<npas4::HeapArenaReport> GetHeapArenaReports();
+
+	///
+	/// Calls malloc_trim(0), which returns the top of each heap and every whole free page within it to the system.  Returns the decrease in
+	/// the resident set size, which is never negative.  Returns zero where malloc_trim() is not available.
+	///
+	NPAS4_EXPORT int64_t TrimHeap();
+} // namespace npas4
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef H_NPAS4_HEAPPROFILEWRITER_H
+#define H_NPAS4_HEAPPROFILEWRITER_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Writes the sampling heap profiler's stacks (HeapProfiler.h) in formats read by standard tools.  Part of the npas4hooks library.
+///
+/// Both writers stream to a file descriptor as they visit the profile, through a fixed size buffer: memory use grows with the number of
+/// distinct return addresses, not with the number of stacks.
+///
+
+#include <npas4/Npas4.h>
+
+namespace npas4
+{
+	struct HeapProfileWriteOptions
+	{
+		///
+		/// Compress the output with gzip, as pprof writes it.  Ignored (the output is written uncompressed, which pprof also reads) if npas4
+		/// was built without zlib.
+		///
+		bool Gzip{true};
+
+		///
+		/// Name each return address with dladdr() (POSIX only).  Only exported symbols can be found this way: link executables with
+		/// -rdynamic, or leave the rest for pprof to symbolize from the binaries named in the profile's mappings.
+		///
+		bool Symbolize{true};
+	};
+
+	enum class HeapProfileValue : int
+	{
+		InUseSpace,
+		InUseObjects,
+		AllocSpace,
+		AllocObjects
+	};
+
+	///
+	/// Writes the profile in pprof's protobuf format (profile.proto), with the sample types alloc_objects, alloc_space, inuse_objects and
+	/// inuse_space.  Returns false if writing failed.
+	///
+	/// https://github.com/google/pprof/blob/main/proto/profile.proto
+	///
+	NPAS4_EXPORT bool WriteHeapProfile(int fd, const npas4::HeapProfileWriteOptions& x = npas4::HeapProfileWriteOptions());
+
+	///
+	/// Writes one line per stack with a non-zero value, "outermost;...;innermost value", as read by flamegraph.pl and most flame graph
+	/// viewers.  Frames are symbolized where possible, and otherwise written as hexadecimal addresses.  Returns false if writing failed.
+	///
+	NPAS4_EXPORT bool WriteHeapProfileFolded(int fd, npas4::HeapProfileValue x = npas4::HeapProfileValue::InUseSpace);
+} // namespace npas4
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef H_NPAS4_HEAPPROFILER_H
+#define H_NPAS4_HEAPPROFILER_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// A sampling heap profiler for allocations made through operator new.  Part of the npas4hooks library (see Allocations.h).
+///
+
+#include <npas4/Npas4.h>
+
+#include <functional>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__aarch64__)) && (defined(__linux__) || (defined(__APPLE__) && defined(__MACH__)))
+#define NPAS4_HAVE_FRAME_POINTER_WALK
+#endif
+
+namespace npas4
+{
+	struct HeapProfilerOptions
+	{
+		///
+		/// The mean number of bytes allocated between samples.  The gaps are drawn from an exponential distribution, so an allocation of
+		/// 'n' bytes is sampled with probability 1 - exp(-n / Interval) no matter how the program's allocations are sized or ordered.
+		///
+		int64_t Interval{512 * 1024};
+
+		///
+		/// Capacity of the table of distinct stacks, and of the table of live sampled allocations.  Samples that do not fit are dropped (and
+		/// counted).  Fixed by the first StartHeapProfiler().
+		///
+		size_t MaxStacks{16384};
+		size_t MaxLive{65536};
+
+		///
+		/// Walk the stack by following frame pointers instead of calling backtrace().  About a hundred times faster, but stacks are cut
+		/// short (or wrong) through code built without frame pointers, so build the program with -fno-omit-frame-pointer (the hooks
+		/// libraries are), or turn this off to pay for backtrace()'s unwinding instead.  The default where NPAS4_HAVE_FRAME_POINTER_WALK is
+		/// defined (GCC or Clang on x86-64 or AArch64 Linux and Apple); ignored elsewhere.
+		///
+#ifdef NPAS4_HAVE_FRAME_POINTER_WALK
+		bool FramePointers{true};
+#else
+		bool FramePointers{false};
+#endif
+	};
+
+	///
+	/// One distinct allocation stack.  The sample counts are exact; the estimates scale them up to the whole program, as pprof does, by
+	/// the inverse of the probability that an allocation of the stack's mean size is sampled.
+	///
+	struct HeapProfileStack
+	{
+		///
+		/// Return addresses, innermost first.
+		///
+		void* const* Frames{nullptr};
+		size_t Depth{0};
+
+		int64_t AllocatedSamples{0};
+		int64_t AllocatedSampleBytes{0};
+		int64_t LiveSamples{0};
+		int64_t LiveSampleBytes{0};
+
+		int64_t AllocatedCount{0};
+		int64_t AllocatedBytes{0};
+		int64_t LiveCount{0};
+		int64_t LiveBytes{0};
+	};
+
+	struct HeapProfileReport
+	{
+		///
+		/// The sampling interval currently in effect.
+		///
+		int64_t Interval{0};
+
+		///
+		/// Allocations sampled since the profiler was first started, and those that did not fit in the tables.
+		///
+		int64_t Samples{0};
+		int64_t Dropped{0};
+
+		///
+		/// Distinct stacks recorded, and sampled allocations not yet freed.
+		///
+		int64_t Stacks{0};
+		int64_t LiveSamples{0};
+
+		operator std::string();
+	};
+
+	///
+	/// Starts (or resumes) sampling allocations in every thread.  A thread may allocate up to 64 KB before it notices.  Returns false if the
+	/// tables could not be allocated, or the options are invalid.
+	///
+	/// The tables are allocated by the first call and kept for the life of the process; later calls only change the interval.  Counts
+	/// accumulate across stops and starts.
+	///
+	NPAS4_EXPORT bool StartHeapProfiler(const npas4::HeapProfilerOptions& x = npas4::HeapProfilerOptions());
+
+	///
+	/// Stops taking new samples.  Sampled allocations freed later are still removed from the live counts.
+	///
+	NPAS4_EXPORT void StopHeapProfiler();
+
+	NPAS4_EXPORT bool IsHeapProfilerRunning();
+
+	NPAS4_EXPORT npas4::HeapProfileReport GetHeapProfileReport();
+
+	///
+	/// Calls 'visitor' once for each recorded stack, in no particular order, without copying the profile.  Returns the number of stacks
+	/// visited.  Sampling continues meanwhile, so counts may change between stacks.  The visitor may allocate.
+	///
+	NPAS4_EXPORT size_t VisitHeapProfile(const std::function<void(const npas4::HeapProfileStack&)>& visitor);
+} // namespace npas4
+
+#endif
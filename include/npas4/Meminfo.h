@@ -0,0 +1,97 @@
+#ifndef H_NPAS4_MEMINFO_H
+#define H_NPAS4_MEMINFO_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <string>
+
+namespace npas4
+{
+	///
+	/// System wide memory detail from /proc/meminfo.  All values are in bytes.  Only populated on Linux; elsewhere every field is zero.
+	///
+	/// https://www.kernel.org/doc/Documentation/filesystems/proc.txt
+	///
+	struct MeminfoReport
+	{
+		int64_t MemTotal{0};
+
+		///
+		/// Memory that is entirely unused.  Usually far less than MemAvailable, since Linux keeps otherwise idle memory as page cache.
+		///
+		int64_t MemFree{0};
+
+		///
+		/// The kernel's estimate of memory available for new allocations without swapping: free memory plus the reclaimable part of the page
+		/// cache and slab.  On kernels older than 3.14, which do not report it, this is estimated as MemFree + Buffers + Cached +
+		/// SReclaimable - Shmem.
+		///
+		int64_t MemAvailable{0};
+
+		///
+		/// Block device buffers.
+		///
+		int64_t Buffers{0};
+
+		///
+		/// The page cache, including Shmem but excluding SwapCached.
+		///
+		int64_t Cached{0};
+
+		///
+		/// Memory that was swapped out and has been swapped back in, but is still in the swap file.
+		///
+		int64_t SwapCached{0};
+
+		///
+		/// The reclaimable part of the kernel's slab allocator (e.g. dentry and inode caches).
+		///
+		int64_t SReclaimable{0};
+
+		///
+		/// Shared memory and tmpfs.  Counted in Cached but not reclaimable without swap.
+		///
+		int64_t Shmem{0};
+
+		///
+		/// Page cache waiting to be written back to disk.
+		///
+		int64_t Dirty{0};
+
+		///
+		/// Page cache actively being written back to disk.
+		///
+		int64_t Writeback{0};
+
+		int64_t SwapTotal{0};
+		int64_t SwapFree{0};
+
+		operator std::string();
+		npas4::MeminfoReport operator-(const npas4::MeminfoReport& x);
+	};
+
+	///
+	/// Returns a MeminfoReport built from a single read of /proc/meminfo.
+	///
+	NPAS4_EXPORT npas4::MeminfoReport GetMeminfoReport();
+} // namespace npas4
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef H_NPAS4_MEMORYTAG_H
+#define H_NPAS4_MEMORYTAG_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Memory tags: attributing operator new allocations to the subsystem that made them.  Part of the npas4tags library, which is npas4hooks
+/// (see Allocations.h) plus tags.
+///
+/// To free each block from the tag it was allocated under, npas4tags puts a 16 byte header in front of every block.  For small allocations
+/// that is a large share of the heap (24 byte blocks take 40% more memory), so tags are opt in: npas4hooks adds nothing to a block.
+///
+
+#include <npas4/Npas4.h>
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace npas4
+{
+	///
+	/// Returns the id of the tag with the given name, registering it the first time.  Up to 127 tags can be registered; beyond that the
+	/// untagged id, zero, is returned.  The name is copied (and truncated to 63 characters).
+	///
+	NPAS4_EXPORT int RegisterMemoryTag(const char* name);
+
+	///
+	/// Sets the most a tag should have live, in usable bytes (zero for no budget).  A budget does not refuse allocations: operator new
+	/// cannot fail a subsystem's allocation cleanly.  Instead the tag is marked over budget, for the subsystem (or an admission check
+	/// before its next piece of work) to query.  Ignored for unregistered ids.
+	///
+	NPAS4_EXPORT void SetMemoryTagBudget(int id, int64_t bytes);
+
+	NPAS4_EXPORT int64_t GetMemoryTagBudget(int id);
+
+	///
+	/// True if the tag's live bytes were over its budget when last checked.  The check is made whenever a thread reports its changes to
+	/// the tag (in 64 KB batches, see MemoryTagReport::PeakBytes) and when the budget is set, so it lags by up to 64 KB per thread.
+	///
+	NPAS4_EXPORT bool IsMemoryTagOverBudget(int id);
+
+	///
+	/// \class MemoryTag
+	///
+	/// Attributes every operator new allocation the calling thread makes during its lifetime to a tag.  Scopes nest: the innermost tag
+	/// wins.  A block is always freed from the tag it was allocated under, whichever thread frees it and whatever tag is current then.
+	///
+	/// \code
+	/// {
+	///		npas4::MemoryTag tag("parser");
+	///		auto tree = Parse(text);
+	/// }
+	/// \endcode
+	///
+	class NPAS4_EXPORT MemoryTag
+	{
+	public:
+		///
+		/// Looking up the name costs a short search of the registered tags.  Prefer the id constructor on hot paths.
+		///
+		explicit MemoryTag(const char* name);
+		explicit MemoryTag(int id);
+		~MemoryTag();
+
+		MemoryTag(const MemoryTag&) = delete;
+		MemoryTag& operator=(const MemoryTag&) = delete;
+
+		///
+		/// The calling thread's current tag id (zero if untagged).
+		///
+		static int GetCurrent();
+	};
+
+	///
+	/// One tag's operator new traffic, in usable bytes (see AllocationReport).
+	///
+	struct MemoryTagReport
+	{
+		std::string Name;
+		int Id{0};
+
+		int64_t LiveBytes{0};
+
+		///
+		/// The most LiveBytes has been.  Each thread reports its changes in 64 KB batches, so the peak may be off by up to 64 KB per thread
+		/// allocating under the tag.
+		///
+		int64_t PeakBytes{0};
+
+		int64_t AllocatedBytes{0};
+		int64_t Allocations{0};
+		int64_t Deallocations{0};
+
+		///
+		/// The tag's budget (zero for none), whether it is over it (see IsMemoryTagOverBudget()), and how many times it has gone over.
+		///
+		int64_t Budget{0};
+		bool OverBudget{false};
+		int64_t BudgetExceeded{0};
+
+		operator std::string();
+	};
+
+	///
+	/// Every registered tag, including "untagged" (id zero), largest LiveBytes first.  If 'top' is not zero, only the first 'top'.  The
+	/// sum of LiveBytes is AllocationReport's LiveBytes, so the tags show which subsystems account for the heap part of
+	/// RamPhysicalUsedByCurrentProcess.
+	///
+	NPAS4_EXPORT std::vector<npas4::MemoryTagReport> GetMemoryTagReports(size_t top = 0);
+
+	///
+	/// \class TaggedAllocator
+	///
+	/// A standard allocator that attributes its allocations to a fixed tag, whatever tag is current, for containers that outlive the scope
+	/// that filled them or are filled from many places.
+	///
+	template <typename T>
+	class TaggedAllocator
+	{
+	public:
+		typedef T value_type;
+
+		explicit TaggedAllocator(int tag) : tag{tag}
+		{
+		}
+
+		template <typename U>
+		TaggedAllocator(const TaggedAllocator<U>& x) : tag{x.GetTag()}
+		{
+		}
+
+		T* allocate(size_t n)
+		{
+			npas4::MemoryTag scope(this->tag);
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		}
+
+		void deallocate(T* x, size_t)
+		{
+			::operator delete(x);
+		}
+
+		int GetTag() const
+		{
+			return this->tag;
+		}
+
+	private:
+		int tag{0};
+	};
+
+	///
+	/// Any TaggedAllocator can free what another allocated, whatever their tags.
+	///
+	template <typename T, typename U>
+	bool operator==(const TaggedAllocator<T>&, const TaggedAllocator<U>&)
+	{
+		return true;
+	}
+
+	template <typename T, typename U>
+	bool operator!=(const TaggedAllocator<T>&, const TaggedAllocator<U>&)
+	{
+		return false;
+	}
+} // namespace npas4
+
+#endif
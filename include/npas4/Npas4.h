@@ -62,10 +62,139 @@ namespace npas4
 		int64_t RamVirtualUsed{0};
 		int64_t RamVirtualUsedByCurrentProcess{0};
 
+		///
+		/// Physical RAM as seen from inside the current process's cgroup (see GetRAMCgroupTotal()).
+		///
+		int64_t RamCgroupTotal{0};
+		int64_t RamCgroupAvailable{0};
+		int64_t RamCgroupUsed{0};
+
+		///
+		/// Physical RAM used by the current process with shared pages divided among the processes sharing them (PSS), and with shared pages
+		/// excluded entirely (USS).  Unlike RamPhysicalUsedByCurrentProcess, these can be summed across processes.  Linux only.
+		///
+		int64_t RamProportionalUsedByCurrentProcess{0};
+		int64_t RamUniqueUsedByCurrentProcess{0};
+
 		operator std::string();
 		npas4::RAMReport operator-(const npas4::RAMReport& x);
 	};
 
+	///
+	/// Bit flags naming the fields of a RAMReport, for use with GetRAMReport(uint32_t).  Combine with operator|.
+	///
+	struct RAMReportField
+	{
+		enum : uint32_t
+		{
+			SystemTotal = 1u << 0,
+			SystemAvailable = 1u << 1,
+			SystemUsed = 1u << 2,
+			SystemUsedByCurrentProcess = 1u << 3,
+			PhysicalTotal = 1u << 4,
+			PhysicalAvailable = 1u << 5,
+			PhysicalUsed = 1u << 6,
+			PhysicalUsedByCurrentProcess = 1u << 7,
+			PhysicalUsedByCurrentProcessPeak = 1u << 8,
+			VirtualTotal = 1u << 9,
+			VirtualAvailable = 1u << 10,
+			VirtualUsed = 1u << 11,
+			VirtualUsedByCurrentProcess = 1u << 12,
+			CgroupTotal = 1u << 13,
+			CgroupAvailable = 1u << 14,
+			CgroupUsed = 1u << 15,
+			ProportionalUsedByCurrentProcess = 1u << 16,
+			UniqueUsedByCurrentProcess = 1u << 17,
+			All = (1u << 18) - 1
+		};
+	};
+
+	///
+	/// Per-process detail that RAMReport does not carry.  All values are in bytes.
+	///
+	/// On Linux, the shared, text, and data fields come from a single read of /proc/self/statm, and the remaining fields from a single read
+	/// of /proc/self/smaps_rollup.  On Windows, only the physical and virtual fields are populated.
+	///
+	struct ExtendedReport
+	{
+		int64_t RamPhysicalUsedByCurrentProcess{0};
+		int64_t RamVirtualUsedByCurrentProcess{0};
+
+		///
+		/// Resident pages backed by a file or shared memory.
+		///
+		int64_t RamSharedByCurrentProcess{0};
+
+		///
+		/// The size of the executable's text (code) segment.
+		///
+		int64_t RamTextByCurrentProcess{0};
+
+		///
+		/// The size of the data segment plus stack.
+		///
+		int64_t RamDataByCurrentProcess{0};
+
+		///
+		/// The proportional set size (PSS): resident memory with each shared page divided by the number of processes mapping it.
+		///
+		int64_t RamProportionalUsedByCurrentProcess{0};
+
+		///
+		/// The unique set size (USS): resident memory mapped only by this process (Private_Clean + Private_Dirty).
+		///
+		int64_t RamUniqueUsedByCurrentProcess{0};
+
+		///
+		/// Memory swapped out, in total and proportionally to sharing.
+		///
+		int64_t RamSwapByCurrentProcess{0};
+		int64_t RamSwapProportionalByCurrentProcess{0};
+
+		///
+		/// Resident anonymous (not file backed) memory, and the part of it backed by transparent huge pages.
+		///
+		int64_t RamAnonymousByCurrentProcess{0};
+		int64_t RamAnonHugePagesByCurrentProcess{0};
+
+		///
+		/// Memory locked with mlock().
+		///
+		int64_t RamLockedByCurrentProcess{0};
+
+		operator std::string();
+		npas4::ExtendedReport operator-(const npas4::ExtendedReport& x);
+	};
+
+	///
+	/// Selects the source used on Linux by GetRAMPhysicalUsedByCurrentProcess(), GetRAMVirtualUsedByCurrentProcess(), and
+	/// GetRAMSystemUsedByCurrentProcess(), and by their ...ByProcess(pid) equivalents.  Other platforms ignore the mode.
+	///
+	enum class ProcessQueryMode : int
+	{
+		///
+		/// Parse /proc/self/status.  This is the default.
+		///
+		Status,
+
+		///
+		/// Read /proc/self/statm, a single line of integers that is much cheaper for the kernel to produce and for the library to parse.
+		/// It reports the same resident and virtual sizes as /proc/self/status.  GetRAMPhysicalUsedByCurrentProcessPeak() and GetRAMReport()
+		/// are not affected, since statm carries no peak.
+		///
+		LowLatency
+	};
+
+	// ----------------------------------------------------------------
+	// Configuration
+
+	///
+	/// Sets the process query mode for all threads.  Safe to call concurrently with any other function.
+	///
+	NPAS4_EXPORT void SetProcessQueryMode(npas4::ProcessQueryMode x);
+
+	NPAS4_EXPORT npas4::ProcessQueryMode GetProcessQueryMode();
+
 	// ----------------------------------------------------------------
 	// Physical + Virtual Memory
 
@@ -94,6 +223,8 @@ namespace npas4
 	/// disk first. It is the sum of the size of the standby, free, and zero lists."
 	/// https://msdn.microsoft.com/en-us/library/windows/desktop/aa366770(v=vs.85).aspx
 	///
+	/// On Linux, this is MemAvailable from /proc/meminfo: free memory plus the page cache and slab that can be reclaimed.  (See Meminfo.h.)
+	///
 	NPAS4_EXPORT int64_t GetRAMPhysicalAvailable();
 
 	///
@@ -112,7 +243,8 @@ namespace npas4
 	NPAS4_EXPORT int64_t GetRAMPhysicalUsedByCurrentProcess();
 
 	///
-	///
+	/// The largest GetRAMPhysicalUsedByCurrentProcess() since the process started (VmHWM on Linux, PeakWorkingSetSize on Windows), or on Linux
+	/// since the last ResetPeak().  See npas4/Peak.h.
 	///
 	NPAS4_EXPORT int64_t GetRAMPhysicalUsedByCurrentProcessPeak();
 
@@ -149,10 +281,94 @@ namespace npas4
 	///
 	NPAS4_EXPORT int64_t GetRAMVirtualUsedByCurrentProcess();
 
+	// ----------------------------------------------------------------
+	// Proportional and Unique Memory
+
+	///
+	/// The proportional set size (PSS) of the current process: its resident memory with each shared page divided by the number of
+	/// processes mapping it.  Summing PSS over a group of processes gives their true combined footprint, where summing
+	/// GetRAMPhysicalUsedByCurrentProcess() counts shared libraries once per process.
+	///
+	/// On Linux this costs one read of /proc/self/smaps_rollup (or a walk of /proc/self/smaps before Linux 4.14), which is considerably more
+	/// expensive than the other process queries.  Returns zero on other platforms.
+	///
+	NPAS4_EXPORT int64_t GetRAMProportionalUsedByCurrentProcess();
+
+	///
+	/// The unique set size (USS) of the current process: resident memory no other process maps, i.e. what exiting would free.
+	/// Same cost as GetRAMProportionalUsedByCurrentProcess().  Returns zero on other platforms.
+	///
+	NPAS4_EXPORT int64_t GetRAMUniqueUsedByCurrentProcess();
+
+	// ----------------------------------------------------------------
+	// Other Processes
+
+	///
+	/// The per-process queries above, for an arbitrary process id.  Each returns zero if the process does not exist, has exited, or cannot be
+	/// queried (e.g. for lack of permission).
+	///
+	/// Each call resolves /proc/<pid> afresh.  To sample the same process repeatedly, use a ProcessHandle (see ProcessHandle.h).
+	/// On platforms other than Linux and Windows only the current process can be queried.
+	///
+	NPAS4_EXPORT int64_t GetRAMSystemUsedByProcess(int64_t pid);
+	NPAS4_EXPORT int64_t GetRAMPhysicalUsedByProcess(int64_t pid);
+	NPAS4_EXPORT int64_t GetRAMPhysicalUsedByProcessPeak(int64_t pid);
+	NPAS4_EXPORT int64_t GetRAMVirtualUsedByProcess(int64_t pid);
+	NPAS4_EXPORT int64_t GetRAMProportionalUsedByProcess(int64_t pid);
+	NPAS4_EXPORT int64_t GetRAMUniqueUsedByProcess(int64_t pid);
+
+	// ----------------------------------------------------------------
+	// Cgroup Memory
+
+	///
+	/// The physical RAM the current process's cgroup may use: the smaller of the cgroup's effective hard limit and GetRAMPhysicalTotal().
+	/// Inside a memory limited container this is the container's limit rather than the host's RAM.
+	///
+	/// Outside a memory controlled cgroup (and on platforms without cgroups) this equals GetRAMPhysicalTotal().  See Cgroup.h for the raw
+	/// cgroup values.
+	///
+	NPAS4_EXPORT int64_t GetRAMCgroupTotal();
+
+	///
+	/// GetRAMCgroupTotal() minus the cgroup's working set, never less than zero.  The working set is GetRAMCgroupUsed() less the inactive
+	/// page cache the kernel reclaims before the cgroup reaches its limit (as kubelet computes it), so a container that has read many files
+	/// is not reported as full.  When the cgroup has no limit below the host's RAM, this is at most GetRAMPhysicalAvailable().
+	///
+	NPAS4_EXPORT int64_t GetRAMCgroupAvailable();
+
+	///
+	/// The memory charged to the current process's cgroup, including page cache.  Outside a memory controlled cgroup this equals
+	/// GetRAMPhysicalUsed().
+	///
+	NPAS4_EXPORT int64_t GetRAMCgroupUsed();
+
 	///
 	/// Returns a RAMReport class containing all RAM measurements.
 	///
+	/// The report is built from a single system query, a single process query, and a single cgroup query (one read of /proc/meminfo, one read
+	/// of /proc/self/status, and one read of each cgroup memory file on Linux), so it is both cheaper than calling each function individually
+	/// and internally consistent.
+	///
+	/// RamProportionalUsedByCurrentProcess and RamUniqueUsedByCurrentProcess are left zero: reading them walks the process's page tables,
+	/// which costs several times the rest of the report.  Request them from GetRAMReport(uint32_t) or GetExtendedReport().
+	///
 	NPAS4_EXPORT npas4::RAMReport GetRAMReport();
+
+	///
+	/// Returns a RAMReport with only the requested fields (a combination of RAMReportField flags) populated.  All other fields are zero.
+	///
+	/// Only the operating system queries needed for the requested fields are issued.  On Linux, system wide fields cost one read of /proc/meminfo,
+	/// per-process fields cost one read of /proc/self/statm, or one read of /proc/self/status if the peak is requested, cgroup fields
+	/// cost one read of /proc/meminfo plus one read of each cgroup memory file, and the proportional and unique fields cost one read of
+	/// /proc/self/smaps_rollup.
+	///
+	NPAS4_EXPORT npas4::RAMReport GetRAMReport(uint32_t fields);
+
+	///
+	/// Returns an ExtendedReport for the current process.  On Linux this costs one read of /proc/self/statm and one read of
+	/// /proc/self/smaps_rollup.
+	///
+	NPAS4_EXPORT npas4::ExtendedReport GetExtendedReport();
 } // namespace npas4
 
 #endif
@@ -0,0 +1,87 @@
+#ifndef H_NPAS4_PEAK_H
+#define H_NPAS4_PEAK_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <chrono>
+#include <memory>
+
+namespace npas4
+{
+	///
+	/// Resets the kernel's peak resident set size (VmHWM) to the current resident set size, so that
+	/// GetRAMPhysicalUsedByCurrentProcessPeak() reports the peak since this call rather than since the process started.
+	///
+	/// On Linux 4.0 and later this writes "5" to /proc/self/clear_refs.  Returns false where the peak cannot be reset: other platforms, older
+	/// kernels, or a /proc that is not writable.  Any ScopedPeak that is alive keeps the peak it had observed before the reset.
+	///
+	NPAS4_EXPORT bool ResetPeak();
+
+	///
+	/// \class ScopedPeak
+	///
+	/// Measures the peak resident set size of the current process over the lifetime of the object.
+	///
+	/// Where ResetPeak() is supported the peak is the kernel's, exact to the page.  Elsewhere a Sampler is started for the lifetime of the
+	/// object and the peak is the largest sample it has seen, so spikes shorter than the sampling interval can be missed.
+	///
+	/// ScopedPeaks may be nested.  Resetting the kernel's peak for an inner scope does not lose the peak of an outer one.
+	///
+	class NPAS4_EXPORT ScopedPeak
+	{
+	public:
+		///
+		/// 'interval' is the sampling interval used only when the kernel's peak cannot be reset.  Each sample reads several procfs files, so
+		/// very short intervals cost a noticeable share of a core.
+		///
+		explicit ScopedPeak(std::chrono::nanoseconds interval = std::chrono::milliseconds(5));
+		~ScopedPeak();
+
+		ScopedPeak(const ScopedPeak&) = delete;
+		ScopedPeak& operator=(const ScopedPeak&) = delete;
+
+		///
+		/// True if the peak is the kernel's rather than sampled.
+		///
+		bool IsExact() const;
+
+		///
+		/// The resident set size when the object was constructed.
+		///
+		int64_t GetStart() const;
+
+		///
+		/// The largest resident set size since the object was constructed.
+		///
+		int64_t GetPeak() const;
+
+		///
+		/// GetPeak() - GetStart().
+		///
+		int64_t GetPeakIncrease() const;
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+} // namespace npas4
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef H_NPAS4_POOL_H
+#define H_NPAS4_POOL_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Fixed size pools with per-thread caches.  Reported with the arenas, by GetArenaReports().
+///
+
+#include <npas4/Arena.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// \class FixedPool
+		///
+		/// Blocks of one size, carved from 64 KB (or larger, for large blocks) slabs obtained from malloc() and never returned until the
+		/// pool is destroyed.  Each thread allocates from and frees to a cache of its own, and only takes or returns a batch of blocks
+		/// under the pool's lock when its cache runs empty or grows large.
+		///
+		class NPAS4_EXPORT FixedPool
+		{
+		public:
+			///
+			/// 'alignment' must be a power of two.
+			///
+			FixedPool(const char* name, size_t size, size_t alignment);
+			~FixedPool();
+
+			FixedPool(const FixedPool&) = delete;
+			FixedPool& operator=(const FixedPool&) = delete;
+
+			///
+			/// Throws std::bad_alloc if a new slab cannot be obtained.
+			///
+			void* Allocate();
+
+			void Deallocate(void* x);
+
+			npas4::ArenaReport GetReport() const;
+
+		private:
+			class Impl;
+			std::unique_ptr<Impl> pimpl;
+		};
+	} // namespace impl
+
+	///
+	/// \class Pool
+	///
+	/// A thread safe pool of T.  Objects still alive when the pool is destroyed are not destroyed, but their memory is freed.
+	///
+	/// \code
+	/// npas4::Pool<Node> nodes("nodes");
+	/// auto x = nodes.Create(key, value);
+	/// nodes.Destroy(x);
+	/// \endcode
+	///
+	template <typename T>
+	class Pool
+	{
+	public:
+		explicit Pool(const char* name = "pool") : pool{name, sizeof(T), alignof(T)}
+		{
+		}
+
+		template <typename... Args>
+		T* Create(Args&&... args)
+		{
+			auto x = this->pool.Allocate();
+
+			try
+			{
+				return new(x) T(std::forward<Args>(args)...);
+			}
+			catch(...)
+			{
+				this->pool.Deallocate(x);
+				throw;
+			}
+		}
+
+		void Destroy(T* x)
+		{
+			if(x != nullptr)
+			{
+				x->~T();
+				this->pool.Deallocate(x);
+			}
+		}
+
+		npas4::ArenaReport GetReport() const
+		{
+			return this->pool.GetReport();
+		}
+
+	private:
+		npas4::impl::FixedPool pool;
+	};
+} // namespace npas4
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef H_NPAS4_PROCESSHANDLE_H
+#define H_NPAS4_PROCESSHANDLE_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace npas4
+{
+	///
+	/// Memory used by one process, in bytes.
+	///
+	struct ProcessReport
+	{
+		int64_t RamPhysicalUsed{0};
+		int64_t RamPhysicalUsedPeak{0};
+		int64_t RamVirtualUsed{0};
+
+		///
+		/// The proportional (PSS) and unique (USS) set sizes.  Linux only.  See GetRAMProportionalUsedByCurrentProcess().
+		///
+		int64_t RamProportionalUsed{0};
+		int64_t RamUniqueUsed{0};
+
+		operator std::string();
+		npas4::ProcessReport operator-(const npas4::ProcessReport& x);
+	};
+
+	///
+	/// \class ProcessHandle
+	///
+	/// Repeated sampling of one, possibly different, process.
+	///
+	/// On Linux the handle opens a directory descriptor on /proc/<pid> when constructed and opens status, statm, and smaps_rollup relative to
+	/// it with openat(), so sampling re-reads already open descriptors with no path resolution.  The directory descriptor refers to the
+	/// process, not the number: once the process exits every read fails, even if the pid is later reused.  On Windows the handle holds a
+	/// process handle.  On other platforms only the current process can be sampled.
+	///
+	/// When the process exits, including part way through a read, queries return zero (or false) rather than partial values.
+	///
+	/// A ProcessHandle is not thread safe.  Use one handle per sampling thread.
+	///
+	class NPAS4_EXPORT ProcessHandle
+	{
+	public:
+		explicit ProcessHandle(int64_t pid);
+		~ProcessHandle();
+
+		ProcessHandle(const ProcessHandle&) = delete;
+		ProcessHandle& operator=(const ProcessHandle&) = delete;
+
+		int64_t GetPid() const;
+
+		///
+		/// False if the process did not exist, or could not be opened, when the handle was constructed.
+		///
+		bool IsOpen() const;
+
+		///
+		/// True if the process is still running.  A zombie (exited but not yet reaped) is not alive.
+		///
+		bool IsAlive();
+
+		///
+		/// Populates the report with one read of status.  PSS and USS are only read, with one more read of smaps_rollup, when 'smaps' is
+		/// true, and are otherwise zero: smaps_rollup walks the process's page tables under its mmap lock, so is far costlier than status
+		/// and stalls the process's own page faults while it runs.  Returns false, leaving 'x' zeroed, if the process has exited.
+		///
+		bool GetReport(npas4::ProcessReport& x, bool smaps = false);
+
+		///
+		/// One read of statm.
+		///
+		int64_t GetRAMPhysicalUsed();
+
+		///
+		/// One read of status.
+		///
+		int64_t GetRAMPhysicalUsedPeak();
+
+		///
+		/// One read of statm.
+		///
+		int64_t GetRAMVirtualUsed();
+
+		///
+		/// One read of smaps_rollup.
+		///
+		int64_t GetRAMProportionalUsed();
+
+		///
+		/// One read of smaps_rollup.
+		///
+		int64_t GetRAMUniqueUsed();
+
+	private:
+		friend class ProcessSet;
+
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+
+	///
+	/// \class ProcessSet
+	///
+	/// A group of processes sampled together.  On Linux, GetReports() reads the status (and, if asked, smaps_rollup) of every process as one
+	/// batch: when built with NPAS4_ENABLE_IO_URING and the kernel permits io_uring, a single io_uring_enter() rather than a read per file.
+	///
+	/// A ProcessSet is not thread safe.
+	///
+	class NPAS4_EXPORT ProcessSet
+	{
+	public:
+		ProcessSet();
+		~ProcessSet();
+
+		ProcessSet(const ProcessSet&) = delete;
+		ProcessSet& operator=(const ProcessSet&) = delete;
+
+		///
+		/// Opens a ProcessHandle on a process.  Returns the index of the process in the set.
+		///
+		size_t Add(int64_t pid);
+
+		size_t Size() const;
+
+		npas4::ProcessHandle& GetHandle(size_t i);
+
+		///
+		/// Samples every process.  'x' is resized to Size(), and x[i] describes the i'th process added.  The report of a process that has
+		/// exited is zeroed.  PSS and USS are only read when 'smaps' is true (see ProcessHandle::GetReport()).  Returns the number of
+		/// processes that are still alive.
+		///
+		size_t GetReports(std::vector<npas4::ProcessReport>& x, bool smaps = false);
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+} // namespace npas4
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef H_NPAS4_PROCESSSCANNER_H
+#define H_NPAS4_PROCESSSCANNER_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace npas4
+{
+	///
+	/// The value a ProcessScanner sorts by.
+	///
+	enum class ScanKey : int
+	{
+		PhysicalUsed,
+		VirtualUsed,
+		ProportionalUsed,
+		UniqueUsed
+	};
+
+	struct ScanOptions
+	{
+		///
+		/// Processes are sorted by this value, largest first.
+		///
+		npas4::ScanKey SortBy{npas4::ScanKey::PhysicalUsed};
+
+		///
+		/// The number of processes to return.  Zero returns every process.
+		///
+		size_t Top{0};
+
+		///
+		/// Read smaps_rollup for the proportional and unique set sizes.  This is many times more expensive than the statm read that provides
+		/// the physical and virtual sizes, so it is off by default.  It is implied when sorting by ProportionalUsed or UniqueUsed.
+		///
+		bool Smaps{false};
+	};
+
+	///
+	/// The result of a scan, stored as a struct of arrays: row i of every column describes the same process.  All values are in bytes.
+	/// Proportional and unique columns are zero unless smaps was read.
+	///
+	struct ProcessTable
+	{
+		std::vector<int64_t> Pid;
+		std::vector<int64_t> RamPhysicalUsed;
+		std::vector<int64_t> RamVirtualUsed;
+		std::vector<int64_t> RamProportionalUsed;
+		std::vector<int64_t> RamUniqueUsed;
+
+		size_t Size() const;
+	};
+
+	///
+	/// \class ProcessScanner
+	///
+	/// Reads the memory of every process on the machine in parallel.  Linux only; elsewhere a scan returns no processes.
+	///
+	/// A scan enumerates the proc root with getdents64(), partitions the pids into one range per thread, and reads each process's statm (and
+	/// optionally smaps_rollup) relative to a directory descriptor on the proc root, into buffers that every thread reuses.  Threads that
+	/// finish their range steal chunks from the ranges of the others.  Processes that exit during the scan are dropped.
+	///
+	/// The threads are started once, when the scanner is constructed, and sleep between scans.  The thread that calls Scan() does its share
+	/// of the work.  A ProcessScanner is not thread safe: call Scan() from one thread at a time.
+	///
+	class NPAS4_EXPORT ProcessScanner
+	{
+	public:
+		///
+		/// 'threads' is the total number of threads to scan with, including the calling thread.  Zero uses one per hardware thread.
+		///
+		explicit ProcessScanner(size_t threads = 0);
+
+		///
+		/// Scans a directory laid out like /proc (numeric directories holding statm and smaps_rollup) instead of /proc.  Intended for
+		/// testing and benchmarking against a synthetic tree.
+		///
+		ProcessScanner(size_t threads, const std::string& procRoot);
+
+		~ProcessScanner();
+
+		ProcessScanner(const ProcessScanner&) = delete;
+		ProcessScanner& operator=(const ProcessScanner&) = delete;
+
+		size_t GetThreadCount() const;
+
+		npas4::ProcessTable Scan(const npas4::ScanOptions& x = npas4::ScanOptions());
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+} // namespace npas4
+
+#endif
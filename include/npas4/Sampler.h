@@ -0,0 +1,114 @@
+#ifndef H_NPAS4_SAMPLER_H
+#define H_NPAS4_SAMPLER_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+#include <npas4/Usage.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+namespace npas4
+{
+	///
+	/// A RAMReport, the process's fault and context switch counters, and the time they were taken.
+	///
+	struct Sample
+	{
+		std::chrono::steady_clock::time_point Time;
+		npas4::RAMReport Report;
+		npas4::UsageReport Usage;
+	};
+
+	///
+	/// \class Sampler
+	///
+	/// Samples GetRAMReport() on a dedicated thread at a fixed interval and publishes the results into a lock-free ring buffer of the most
+	/// recent Sampler::Capacity samples.
+	///
+	/// Readers never touch procfs, never make a system call, and never block the sampling thread: reading the latest sample is a handful of
+	/// atomic loads.  Any number of threads may read concurrently.
+	///
+	/// Each sample is a SnapshotReader::GetRAMReport() and a SnapshotReader::GetUsageReport(): on Linux, one read each of /proc/meminfo,
+	/// /proc/self/status, the cgroup memory files, and /proc/self/stat, plus one getrusage().  PSS and USS are not sampled.
+	///
+	/// On Linux the thread is driven by a timerfd, so the sampling period does not drift with the cost of taking each sample.  Should
+	/// polling the timerfd fail, the thread falls back to a timed wait.
+	///
+	class NPAS4_EXPORT Sampler
+	{
+	public:
+		static constexpr size_t Capacity{64};
+
+		///
+		/// Starts sampling immediately.  The first sample is taken before the constructor returns.
+		///
+		explicit Sampler(std::chrono::nanoseconds interval = std::chrono::milliseconds(100));
+
+		///
+		/// Stops the sampling thread.
+		///
+		~Sampler();
+
+		Sampler(const Sampler&) = delete;
+		Sampler& operator=(const Sampler&) = delete;
+
+		///
+		/// Copies the most recent sample.  Lock free.
+		///
+		npas4::Sample GetLatest() const;
+
+		///
+		/// Copies up to 'count' of the most recent samples into 'x', newest first.  Returns the number copied, which is at most Capacity.
+		///
+		size_t GetHistory(npas4::Sample* x, size_t count) const;
+
+		///
+		/// Fault and context switch rates over the most recent 'intervals' sampling intervals (at most Capacity - 1).  Zero until two
+		/// samples have been taken.
+		///
+		npas4::UsageRates GetRates(size_t intervals = 1) const;
+
+		///
+		/// The total number of samples taken since construction.
+		///
+		uint64_t GetSampleCount() const;
+
+		std::chrono::nanoseconds GetInterval() const;
+
+		///
+		/// The largest RamPhysicalUsedByCurrentProcess of any sample since construction or the last ResetPeak().  Unlike the kernel's peak
+		/// this can be reset on every platform, but it misses spikes shorter than the sampling interval.  Lock free.
+		///
+		int64_t GetPeak() const;
+
+		///
+		/// Restarts GetPeak() from the most recent sample.
+		///
+		void ResetPeak();
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+} // namespace npas4
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef H_NPAS4_SCOPEDMEASUREMENT_H
+#define H_NPAS4_SCOPEDMEASUREMENT_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace npas4
+{
+	///
+	/// The change in the current process's memory over a ScopedMeasurement.  Memory values are in bytes.
+	///
+	struct MeasurementReport
+	{
+		///
+		/// The change in resident set size.
+		///
+		int64_t RamPhysicalUsed{0};
+
+		///
+		/// The change in virtual size (VmSize on Linux, private bytes on Windows).
+		///
+		int64_t RamVirtualUsed{0};
+
+		///
+		/// How far the resident set size peaked above its value at the start.  Never negative.
+		///
+		int64_t RamPhysicalUsedPeak{0};
+
+		int64_t MinorFaults{0};
+		int64_t MajorFaults{0};
+
+		std::chrono::nanoseconds Elapsed{0};
+
+		operator std::string();
+		npas4::MeasurementReport operator-(const npas4::MeasurementReport& x);
+	};
+
+	///
+	/// \class ScopedMeasurement
+	///
+	/// Measures the change in the current process's memory between construction and destruction (or Stop()).
+	///
+	/// The measurer keeps its own /proc/self/status open and reads it once before the starting snapshot, so that its buffers and stack are
+	/// already resident and the snapshots themselves allocate nothing.  What footprint remains is calibrated once per process, as the
+	/// smallest delta over several empty measurements, and subtracted from every report.  See GetOverhead().
+	///
+	/// The peak is measured with a ScopedPeak, so it is exact where ResetPeak() is supported and sampled elsewhere.
+	///
+	/// Measurements are process wide: allocations by other threads during the measurement are included.
+	///
+	class NPAS4_EXPORT ScopedMeasurement
+	{
+	public:
+		ScopedMeasurement();
+
+		///
+		/// Writes the report to 'x' when the measurement stops.  'x' must outlive this object.
+		///
+		explicit ScopedMeasurement(npas4::MeasurementReport& x);
+
+		///
+		/// Stops the measurement, if Stop() has not been called.
+		///
+		~ScopedMeasurement();
+
+		ScopedMeasurement(const ScopedMeasurement&) = delete;
+		ScopedMeasurement& operator=(const ScopedMeasurement&) = delete;
+
+		///
+		/// Ends the measurement and returns its report.  Later calls return the same report.
+		///
+		npas4::MeasurementReport Stop();
+
+		bool IsStopped() const;
+
+		///
+		/// The measurer's own footprint, as subtracted from every report.  Calibrated on first use.
+		///
+		static npas4::MeasurementReport GetOverhead();
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+} // namespace npas4
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef H_NPAS4_SNAPSHOTREADER_H
+#define H_NPAS4_SNAPSHOTREADER_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Meminfo.h>
+#include <npas4/Npas4.h>
+#include <npas4/Usage.h>
+
+#include <memory>
+
+namespace npas4
+{
+	///
+	/// \class SnapshotReader
+	///
+	/// A reader for repeated, high frequency sampling.
+	///
+	/// On Linux, /proc/self/status, /proc/self/statm, /proc/self/stat, /proc/self/smaps_rollup, /proc/meminfo, and the process's cgroup memory files are
+	/// opened once when the reader is constructed.  Each query re-reads only the files it needs with pread() into preallocated buffers
+	/// (listed on each function below); smaps_rollup, whose read walks the page tables, only when PSS or USS is requested.  Sampling performs
+	/// no open/close, no stdio buffering, and no heap allocation.
+	/// When built with NPAS4_ENABLE_IO_URING and the kernel permits io_uring, GetRAMReport() submits all of its reads in one io_uring_enter()
+	/// instead of one pread() per file.
+	/// On other platforms the reader forwards to the free functions.
+	///
+	/// A SnapshotReader is not thread safe.  Use one reader per sampling thread.
+	///
+	class NPAS4_EXPORT SnapshotReader
+	{
+	public:
+		SnapshotReader();
+		~SnapshotReader();
+
+		SnapshotReader(const SnapshotReader&) = delete;
+		SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+		///
+		/// True if every procfs file the reader depends on was opened successfully.  The cgroup files and smaps_rollup (absent
+		/// before Linux 4.14) are optional and not considered.
+		///
+		bool IsOpen() const;
+
+		///
+		/// Equivalent to npas4::GetRAMReport(), using one read each of /proc/meminfo, /proc/self/status, and the cgroup memory files, issued
+		/// as a single batch.  Like npas4::GetRAMReport(), it leaves PSS and USS zero.
+		///
+		npas4::RAMReport GetRAMReport();
+
+		///
+		/// Equivalent to npas4::GetRAMReport(uint32_t), batching only the reads the requested fields need.  /proc/self/smaps_rollup is read
+		/// only when ProportionalUsedByCurrentProcess or UniqueUsedByCurrentProcess is requested.
+		///
+		npas4::RAMReport GetRAMReport(uint32_t fields);
+
+		///
+		/// Equivalent to npas4::GetMeminfoReport(), using one read of /proc/meminfo.
+		///
+		npas4::MeminfoReport GetMeminfoReport();
+
+		///
+		/// Equivalent to npas4::GetRAMPhysicalUsedByCurrentProcess(), using one read of /proc/self/statm.
+		///
+		int64_t GetRAMPhysicalUsedByCurrentProcess();
+
+		///
+		/// Equivalent to npas4::GetRAMVirtualUsedByCurrentProcess(), using one read of /proc/self/statm.
+		///
+		int64_t GetRAMVirtualUsedByCurrentProcess();
+
+		///
+		/// Equivalent to npas4::GetUsageReport(), using one getrusage() and one read of /proc/self/stat.
+		///
+		npas4::UsageReport GetUsageReport();
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> pimpl;
+	};
+} // namespace npas4
+
+#endif
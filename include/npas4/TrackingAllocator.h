@@ -0,0 +1,189 @@
+#ifndef H_NPAS4_TRACKINGALLOCATOR_H
+#define H_NPAS4_TRACKINGALLOCATOR_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// A standard allocator that counts what each kind of container holds, for code that uses neither the operator new hooks nor std::pmr.
+///
+
+#include <npas4/Npas4.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace npas4
+{
+	///
+	/// One tag's counts, in bytes requested (n * sizeof(T)): the allocator's own overhead per block is not included.
+	///
+	struct TrackingReport
+	{
+		std::string Name;
+
+		int64_t LiveBytes{0};
+		int64_t PeakBytes{0};
+		int64_t AllocatedBytes{0};
+		int64_t Allocations{0};
+		int64_t Deallocations{0};
+
+		operator std::string();
+	};
+
+	namespace impl
+	{
+		///
+		/// Zero initialized, so counting works before static constructors (including the one registering the counters) have run.
+		///
+		struct TrackingCounters
+		{
+			std::atomic<int64_t> LiveBytes;
+			std::atomic<int64_t> PeakBytes;
+			std::atomic<int64_t> AllocatedBytes;
+			std::atomic<int64_t> Allocations;
+			std::atomic<int64_t> Deallocations;
+			const char* Name;
+			npas4::impl::TrackingCounters* Next;
+		};
+
+		NPAS4_EXPORT void RegisterTrackingCounters(npas4::impl::TrackingCounters* x);
+		NPAS4_EXPORT npas4::TrackingReport GetTrackingReport(const npas4::impl::TrackingCounters& x);
+
+		///
+		/// One set of counters per tag type, found at compile time.  Registered, for GetTrackingReports(), by a static constructor.
+		///
+		template <typename Tag>
+		struct TrackingTag
+		{
+			struct Registrar
+			{
+				Registrar()
+				{
+					Counters.Name = Tag::Name();
+					npas4::impl::RegisterTrackingCounters(&Counters);
+				}
+			};
+
+			static npas4::impl::TrackingCounters Counters;
+			static Registrar Registration;
+		};
+
+		template <typename Tag>
+		npas4::impl::TrackingCounters TrackingTag<Tag>::Counters;
+
+		template <typename Tag>
+		typename TrackingTag<Tag>::Registrar TrackingTag<Tag>::Registration;
+	} // namespace impl
+
+	///
+	/// \class TrackingAllocator
+	///
+	/// Forwards to std::allocator<T>, counting against the tag type 'Tag', which names itself with a static Name() function.  There is
+	/// one set of counters per tag, resolved when the allocator is compiled: counting costs a few relaxed atomic additions, and no lookup.
+	///
+	/// \code
+	/// struct SymbolTable
+	/// {
+	///		static const char* Name() { return "symbol table"; }
+	/// };
+	///
+	/// std::unordered_map<std::string, int, std::hash<std::string>, std::equal_to<std::string>,
+	///					   npas4::TrackingAllocator<std::pair<const std::string, int>, SymbolTable>> symbols;
+	/// \endcode
+	///
+	/// Only the container's own blocks are counted: the characters of the std::string keys above are not, unless the strings use a
+	/// TrackingAllocator too.
+	///
+	template <typename T, typename Tag>
+	class TrackingAllocator
+	{
+	public:
+		typedef T value_type;
+
+		TrackingAllocator() = default;
+
+		template <typename U>
+		TrackingAllocator(const TrackingAllocator<U, Tag>&)
+		{
+		}
+
+		T* allocate(size_t n)
+		{
+			auto x = std::allocator<T>().allocate(n);
+
+			// Naming the registrar is what instantiates, and so runs, its constructor.
+			(void)&npas4::impl::TrackingTag<Tag>::Registration;
+
+			auto& counters = npas4::impl::TrackingTag<Tag>::Counters;
+			const auto bytes = static_cast<int64_t>(n * sizeof(T));
+			const auto live = counters.LiveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+			counters.AllocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+			counters.Allocations.fetch_add(1, std::memory_order_relaxed);
+
+			auto peak = counters.PeakBytes.load(std::memory_order_relaxed);
+
+			while(live > peak && counters.PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed) == false)
+			{
+			}
+
+			return x;
+		}
+
+		void deallocate(T* x, size_t n)
+		{
+			auto& counters = npas4::impl::TrackingTag<Tag>::Counters;
+			counters.LiveBytes.fetch_sub(static_cast<int64_t>(n * sizeof(T)), std::memory_order_relaxed);
+			counters.Deallocations.fetch_add(1, std::memory_order_relaxed);
+
+			std::allocator<T>().deallocate(x, n);
+		}
+	};
+
+	template <typename T, typename U, typename Tag>
+	bool operator==(const TrackingAllocator<T, Tag>&, const TrackingAllocator<U, Tag>&)
+	{
+		return true;
+	}
+
+	template <typename T, typename U, typename Tag>
+	bool operator!=(const TrackingAllocator<T, Tag>&, const TrackingAllocator<U, Tag>&)
+	{
+		return false;
+	}
+
+	///
+	/// The counts for one tag.
+	///
+	template <typename Tag>
+	npas4::TrackingReport GetTrackingReport()
+	{
+		auto x = npas4::impl::GetTrackingReport(npas4::impl::TrackingTag<Tag>::Counters);
+		x.Name = Tag::Name();
+		return x;
+	}
+
+	///
+	/// Every tag a TrackingAllocator in the program is compiled for, largest LiveBytes first.  Their sum can be compared to
+	/// RamPhysicalUsedByCurrentProcess to see how much of the process's memory the tracked containers account for.
+	///
+	NPAS4_EXPORT std::vector<npas4::TrackingReport> GetTrackingReports();
+} // namespace npas4
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef H_NPAS4_USAGE_H
+#define H_NPAS4_USAGE_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Npas4.h>
+
+#include <string>
+
+namespace npas4
+{
+	///
+	/// Page fault and scheduling counters, cumulative since the process (or thread) started.  Memory growth often shows up as faults before it
+	/// shows up in the resident set size: every first touch of a newly allocated page is a minor fault.
+	///
+	/// https://man7.org/linux/man-pages/man2/getrusage.2.html
+	///
+	struct UsageReport
+	{
+		///
+		/// Faults serviced without I/O: the first touch of an anonymous page, or a page already in the page cache.
+		///
+		int64_t MinorFaults{0};
+
+		///
+		/// Faults that had to read from disk or swap.
+		///
+		int64_t MajorFaults{0};
+
+		///
+		/// Faults of children that have been waited for.  Linux only, from /proc/self/stat.  Zero for UsageScope::Thread.
+		///
+		int64_t ChildMinorFaults{0};
+		int64_t ChildMajorFaults{0};
+
+		///
+		/// The peak resident set size (ru_maxrss), in bytes.
+		///
+		int64_t RamPhysicalUsedPeak{0};
+
+		///
+		/// Context switches because the thread blocked (e.g. on I/O or a lock), and because the scheduler preempted it.  POSIX only.
+		///
+		int64_t VoluntaryContextSwitches{0};
+		int64_t InvoluntaryContextSwitches{0};
+
+		operator std::string();
+		npas4::UsageReport operator-(const npas4::UsageReport& x);
+	};
+
+	///
+	/// UsageReport counters per second.
+	///
+	struct UsageRates
+	{
+		double MinorFaults{0.0};
+		double MajorFaults{0.0};
+		double VoluntaryContextSwitches{0.0};
+		double InvoluntaryContextSwitches{0.0};
+	};
+
+	enum class UsageScope : int
+	{
+		Process,
+
+		///
+		/// The calling thread (RUSAGE_THREAD).  Linux only; elsewhere the process is reported.
+		///
+		Thread
+	};
+
+	///
+	/// One getrusage() and, for UsageScope::Process on Linux, one read of /proc/self/stat.  On Windows only MinorFaults (every page fault)
+	/// and RamPhysicalUsedPeak are populated.
+	///
+	NPAS4_EXPORT npas4::UsageReport GetUsageReport(npas4::UsageScope x = npas4::UsageScope::Process);
+} // namespace npas4
+
+#endif
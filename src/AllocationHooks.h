@@ -0,0 +1,154 @@
+#ifndef H_NPAS4_ALLOCATIONHOOKS_H
+#define H_NPAS4_ALLOCATIONHOOKS_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// What the replacement operator new and delete (Allocations.cpp) call into.  Nothing declared here may allocate with operator new.
+///
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// Threads given counters of their own.  Further threads share one more slot, index SlotCount.
+		///
+		const size_t SlotCount{256};
+
+		///
+		/// Memory tags (MemoryTag.h), including the untagged tag, zero.
+		///
+		const size_t MaxMemoryTags{128};
+
+		///
+		/// One tag's counters in one slot.  Written as Allocations.cpp writes its own slot counters: a relaxed load and store by the slot's
+		/// thread, or an atomic addition in the shared slot.
+		///
+		struct TagCounters
+		{
+			std::atomic<int64_t> AllocatedBytes;
+			std::atomic<int64_t> FreedBytes;
+			std::atomic<int64_t> Allocations;
+			std::atomic<int64_t> Deallocations;
+		};
+
+		///
+		/// Zero initialized.  One row per slot, indexed by tag.
+		///
+		extern TagCounters TagShards[SlotCount + 1][MaxMemoryTags];
+
+		///
+		/// Each tag's live bytes, updated by each thread in batches, and the highest value it has reached.  Only used to track the peak:
+		/// TagShards gives the exact live bytes.
+		///
+		extern std::atomic<int64_t> TagLive[MaxMemoryTags];
+		extern std::atomic<int64_t> TagPeak[MaxMemoryTags];
+
+		///
+		/// Each tag's budget (zero for none), whether TagLive was over it when last updated, and how many times it has gone over.  Checked
+		/// each time a thread adds its batch to TagLive.
+		///
+		extern std::atomic<int64_t> TagBudget[MaxMemoryTags];
+		extern std::atomic<bool> TagOverBudget[MaxMemoryTags];
+		extern std::atomic<int64_t> TagBudgetExceeded[MaxMemoryTags];
+
+		///
+		/// Records whether a tag's live bytes are over its budget.
+		///
+		inline void CheckMemoryTagBudget(uint32_t tag, int64_t live)
+		{
+			const auto budget = TagBudget[tag].load(std::memory_order_relaxed);
+			const auto over = (budget > 0 && live > budget);
+
+			// Only a change is written, so that flushes of a tag within its budget leave its cache line shared.
+			if(TagOverBudget[tag].load(std::memory_order_relaxed) == over)
+			{
+				return;
+			}
+
+			if(TagOverBudget[tag].exchange(over, std::memory_order_relaxed) != over && over == true)
+			{
+				TagBudgetExceeded[tag].fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		///
+		/// The calling thread's tag stack.  Pushing beyond its capacity keeps the innermost tag that fitted.
+		///
+		void PushMemoryTag(uint32_t x);
+		void PopMemoryTag();
+		uint32_t GetMemoryTag();
+
+		///
+		/// Whether the heap profiler is running.  operator new only gives a block the heap profile alignment while it is.
+		///
+		extern std::atomic<bool> HeapProfileRunning;
+
+		///
+		/// The number of sampled allocations in the heap profiler's live table.  operator delete only looks a pointer up while it is non-zero.
+		///
+		extern std::atomic<int64_t> HeapProfileLive;
+
+		///
+		/// The alignment of every block the heap profiler may sample, so that operator delete passes over almost every other block without a
+		/// single load.  (On Windows, where a block from _aligned_malloc() cannot be passed to free(), sampled blocks are ordinary ones, and
+		/// this is the alignment of every block.)
+		///
+#ifdef WIN32
+		const size_t HeapProfileAlignment{16};
+#else
+		const size_t HeapProfileAlignment{256};
+#endif
+
+		inline bool IsHeapProfileAligned(const void* block)
+		{
+			return (reinterpret_cast<uintptr_t>(block) & (HeapProfileAlignment - 1)) == 0;
+		}
+
+		///
+		/// Counts of live samples by address, so that operator delete can skip the live table for almost every aligned pointer.  The address's
+		/// low bits, without hashing, pick the entry.
+		///
+		const size_t HeapProfileFilterSize{16384};
+		extern std::atomic<uint32_t> HeapProfileFilter[HeapProfileFilterSize];
+
+		inline std::atomic<uint32_t>& GetHeapProfileFilter(const void* x)
+		{
+			return HeapProfileFilter[(reinterpret_cast<uintptr_t>(x) / HeapProfileAlignment) & (HeapProfileFilterSize - 1)];
+		}
+
+		///
+		/// Called by operator new once the calling thread has allocated the bytes it was told to wait for.  Records 'x' (of usable size
+		/// 'size') if the profiler is running and 'x' is not null, and returns the number of bytes to allocate before the next call.  Only
+		/// blocks allocated with HeapProfileAlignment may be passed.
+		///
+		int64_t SampleAllocation(void* x, size_t size);
+
+		///
+		/// Called by operator delete, before the memory is freed, when the block is aligned, a sample is live, and the pointer's filter entry
+		/// is set.
+		///
+		void SampleDeallocation(void* x);
+	} // namespace impl
+} // namespace npas4
+
+#endif
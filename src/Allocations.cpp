@@ -0,0 +1,490 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// The replacement global operator new and operator delete, built into the npas4hooks library only.
+///
+/// Nothing here may allocate with operator new, and everything here may run before main() and after static destructors: the counters are
+/// zero initialized statics, and thread cleanup relies only on a thread_local destructor.
+///
+/// Also built, with NPAS4_MEMORY_TAGS defined, into the npas4tags library, which adds memory tags (MemoryTag.h).  There every block carries
+/// a header (one max_align_t, so the block stays suitably aligned) recording the tag it was allocated under, so that it is freed from the
+/// same tag.  npas4hooks adds nothing to a block.
+///
+
+#include <npas4/Allocations.h>
+
+#include "AllocationHooks.h"
+#include "ThreadIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#ifdef WIN32
+#include <malloc.h>
+#elif defined(__APPLE__) && defined(__MACH__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace
+{
+	///
+	/// One thread's counters, on a cache line of its own so that threads allocating in parallel never write to the same line.
+	///
+	/// Only the thread holding the slot writes to it, with a relaxed load and store rather than a locked read-modify-write.  Readers load
+	/// each counter relaxed.  A slot released by an exiting thread keeps its counts, and the next thread to claim it carries on from them, so
+	/// the sum over all slots is always the process total.
+	///
+	struct alignas(64) Slot
+	{
+		std::atomic<int64_t> AllocatedBytes;
+		std::atomic<int64_t> FreedBytes;
+		std::atomic<int64_t> Allocations;
+		std::atomic<int64_t> Deallocations;
+	};
+
+	using npas4::impl::MaxMemoryTags;
+	using npas4::impl::SlotCount;
+
+	///
+	/// Zero initialized before any code runs.  Slots are indexed by ThreadIndex.  The last slot, Overflow, is shared, with atomic additions,
+	/// by threads that found every other slot taken.
+	///
+	Slot Slots[SlotCount + 1];
+	Slot* const Overflow{&Slots[SlotCount]};
+
+#ifdef NPAS4_MEMORY_TAGS
+	struct Header
+	{
+		uint32_t Tag;
+	};
+
+	const size_t HeaderSize{alignof(std::max_align_t)};
+	static_assert(HeaderSize >= sizeof(Header), "The block header does not fit in its alignment.");
+
+	///
+	/// A thread's share of a tag's live bytes is added to TagLive (and its peak updated) once it changes by this much.
+	///
+	const int64_t TagBatch{64 * 1024};
+#else
+	const size_t HeaderSize{0};
+#endif
+
+	///
+	/// The values of the calling thread's counters when it was given them.
+	///
+	thread_local int64_t ThreadBase[4]{0, 0, 0, 0};
+
+	///
+	/// Bytes the thread may allocate before calling into the heap profiler.
+	///
+	thread_local int64_t ThreadSampleCountdown{0};
+
+#ifdef NPAS4_MEMORY_TAGS
+	///
+	/// The thread's memory tag stack, and its changes to each tag's live bytes not yet added to TagLive.
+	///
+	const size_t TagStackCapacity{64};
+	thread_local uint32_t TagStack[TagStackCapacity];
+	thread_local size_t TagDepth{0};
+	thread_local int64_t TagPending[MaxMemoryTags];
+
+	void FlushTag(uint32_t tag)
+	{
+		const auto pending = TagPending[tag];
+		TagPending[tag] = 0;
+
+		const auto live = npas4::impl::TagLive[tag].fetch_add(pending, std::memory_order_relaxed) + pending;
+		auto peak = npas4::impl::TagPeak[tag].load(std::memory_order_relaxed);
+
+		while(live > peak && npas4::impl::TagPeak[tag].compare_exchange_weak(peak, live, std::memory_order_relaxed) == false)
+		{
+		}
+
+		npas4::impl::CheckMemoryTagBudget(tag, live);
+	}
+#endif
+
+	struct SlotTag : npas4::impl::ThreadIndexHooks
+	{
+		///
+		/// Records where the slot's counters stand, so that GetThreadAllocationReport() counts only this thread's allocations.
+		///
+		static void OnClaim(size_t x)
+		{
+			const auto& slot = Slots[x];
+			ThreadBase[0] = slot.AllocatedBytes.load(std::memory_order_relaxed);
+			ThreadBase[1] = slot.FreedBytes.load(std::memory_order_relaxed);
+			ThreadBase[2] = slot.Allocations.load(std::memory_order_relaxed);
+			ThreadBase[3] = slot.Deallocations.load(std::memory_order_relaxed);
+		}
+
+		///
+		/// The thread is exiting.  Allocations it makes after this (in later thread_local destructors) go to Overflow.
+		///
+		static void OnRelease(size_t)
+		{
+#ifdef NPAS4_MEMORY_TAGS
+			for(uint32_t i = 0; i < MaxMemoryTags; ++i)
+			{
+				if(TagPending[i] != 0)
+				{
+					FlushTag(i);
+				}
+			}
+#endif
+		}
+	};
+
+	inline Slot* GetSlot()
+	{
+		return &Slots[npas4::impl::ThreadIndex<SlotTag, SlotCount>::Get()];
+	}
+
+	inline void Add(std::atomic<int64_t>& counter, int64_t x, bool shared)
+	{
+		if(shared == true)
+		{
+			counter.fetch_add(x, std::memory_order_relaxed);
+		}
+		else
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + x, std::memory_order_relaxed);
+		}
+	}
+
+	inline size_t UsableSize(void* x)
+	{
+#ifdef WIN32
+		return _msize(x);
+#elif defined(__APPLE__) && defined(__MACH__)
+		return malloc_size(x);
+#else
+		return malloc_usable_size(x);
+#endif
+	}
+
+	///
+	/// A block with the heap profile alignment, for an allocation the heap profiler will sample.
+	///
+	inline void* AllocateAligned(size_t bytes)
+	{
+#ifdef WIN32
+		return malloc(bytes);
+#else
+		void* x{nullptr};
+		return (posix_memalign(&x, npas4::impl::HeapProfileAlignment, bytes) == 0) ? x : nullptr;
+#endif
+	}
+
+#ifdef NPAS4_MEMORY_TAGS
+	inline uint32_t CurrentTag()
+	{
+		return (TagDepth == 0) ? 0 : TagStack[std::min(TagDepth, TagStackCapacity) - 1];
+	}
+
+	inline void CountTag(Slot* slot, uint32_t tag, int64_t bytes, bool allocated)
+	{
+		auto& counters = npas4::impl::TagShards[slot - Slots][tag];
+		const auto shared = (slot == Overflow);
+
+		if(allocated == true)
+		{
+			Add(counters.AllocatedBytes, bytes, shared);
+			Add(counters.Allocations, 1, shared);
+			TagPending[tag] += bytes;
+		}
+		else
+		{
+			Add(counters.FreedBytes, bytes, shared);
+			Add(counters.Deallocations, 1, shared);
+			TagPending[tag] -= bytes;
+		}
+
+		if(TagPending[tag] >= TagBatch || TagPending[tag] <= -TagBatch)
+		{
+			FlushTag(tag);
+		}
+	}
+#endif
+
+	inline void* Allocate(size_t size)
+	{
+#ifdef NPAS4_MEMORY_TAGS
+		if(size > static_cast<size_t>(-1) - HeaderSize)
+		{
+			return nullptr;
+		}
+#endif
+
+		// The allocation that takes the thread past its countdown is the one sampled, so while the profiler runs it is given the alignment
+		// operator delete looks for.
+		ThreadSampleCountdown -= static_cast<int64_t>(size);
+		const auto sampled = (ThreadSampleCountdown < 0);
+		const auto aligned = (sampled == true && npas4::impl::HeapProfileRunning.load(std::memory_order_relaxed) == true);
+
+		// malloc(0) may return null, which operator new may not.
+		const auto bytes = std::max(size + HeaderSize, size_t(1));
+		auto block = (aligned == true) ? AllocateAligned(bytes) : malloc(bytes);
+
+		if(block == nullptr)
+		{
+			return nullptr;
+		}
+
+		auto x = static_cast<char*>(block) + HeaderSize;
+		const auto usable = UsableSize(block) - HeaderSize;
+
+		auto slot = GetSlot();
+		const auto shared = (slot == Overflow);
+		Add(slot->AllocatedBytes, static_cast<int64_t>(usable), shared);
+		Add(slot->Allocations, 1, shared);
+
+#ifdef NPAS4_MEMORY_TAGS
+		const auto tag = CurrentTag();
+		static_cast<Header*>(block)->Tag = tag;
+		CountTag(slot, tag, static_cast<int64_t>(usable), true);
+#endif
+
+		if(sampled == true)
+		{
+			ThreadSampleCountdown = npas4::impl::SampleAllocation((aligned == true) ? x : nullptr, usable);
+		}
+
+		return x;
+	}
+
+	inline void Deallocate(void* x)
+	{
+		if(x == nullptr)
+		{
+			return;
+		}
+
+		auto block = static_cast<char*>(x) - HeaderSize;
+		const auto usable = static_cast<int64_t>(UsableSize(block) - HeaderSize);
+
+		auto slot = GetSlot();
+		const auto shared = (slot == Overflow);
+		Add(slot->FreedBytes, usable, shared);
+		Add(slot->Deallocations, 1, shared);
+
+#ifdef NPAS4_MEMORY_TAGS
+		CountTag(slot, reinterpret_cast<Header*>(block)->Tag, usable, false);
+#endif
+
+		if(npas4::impl::IsHeapProfileAligned(block) == true && npas4::impl::HeapProfileLive.load(std::memory_order_relaxed) != 0
+		   && npas4::impl::GetHeapProfileFilter(x).load(std::memory_order_relaxed) != 0)
+		{
+			npas4::impl::SampleDeallocation(x);
+		}
+
+		free(block);
+	}
+
+	void* AllocateOrThrow(size_t size)
+	{
+		while(true)
+		{
+			auto x = Allocate(size);
+
+			if(x != nullptr)
+			{
+				return x;
+			}
+
+			const auto handler = std::get_new_handler();
+
+			if(handler == nullptr)
+			{
+				throw std::bad_alloc();
+			}
+
+			handler();
+		}
+	}
+
+	void* AllocateNoThrow(size_t size) noexcept
+	{
+		try
+		{
+			return AllocateOrThrow(size);
+		}
+		catch(...)
+		{
+			return nullptr;
+		}
+	}
+
+	void Accumulate(const Slot& slot, npas4::AllocationReport& x)
+	{
+		x.AllocatedBytes += slot.AllocatedBytes.load(std::memory_order_relaxed);
+		x.FreedBytes += slot.FreedBytes.load(std::memory_order_relaxed);
+		x.Allocations += slot.Allocations.load(std::memory_order_relaxed);
+		x.Deallocations += slot.Deallocations.load(std::memory_order_relaxed);
+	}
+} // namespace
+
+#ifdef NPAS4_MEMORY_TAGS
+void npas4::impl::PushMemoryTag(uint32_t x)
+{
+	if(TagDepth < TagStackCapacity)
+	{
+		TagStack[TagDepth] = x;
+	}
+
+	++TagDepth;
+}
+
+void npas4::impl::PopMemoryTag()
+{
+	if(TagDepth > 0)
+	{
+		--TagDepth;
+	}
+}
+
+uint32_t npas4::impl::GetMemoryTag()
+{
+	return CurrentTag();
+}
+#endif
+
+void* operator new(size_t size)
+{
+	return AllocateOrThrow(size);
+}
+
+void* operator new[](size_t size)
+{
+	return AllocateOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocateNoThrow(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocateNoThrow(size);
+}
+
+void operator delete(void* x) noexcept
+{
+	Deallocate(x);
+}
+
+void operator delete[](void* x) noexcept
+{
+	Deallocate(x);
+}
+
+void operator delete(void* x, const std::nothrow_t&) noexcept
+{
+	Deallocate(x);
+}
+
+void operator delete[](void* x, const std::nothrow_t&) noexcept
+{
+	Deallocate(x);
+}
+
+npas4::AllocationReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Live Bytes:                        " << this->LiveBytes << std::endl;
+	ss << "Allocated Bytes:                   " << this->AllocatedBytes << std::endl;
+	ss << "Freed Bytes:                       " << this->FreedBytes << std::endl;
+	ss << "Allocations:                       " << this->Allocations << std::endl;
+	ss << "Deallocations:                     " << this->Deallocations << std::endl;
+
+	return ss.str();
+}
+
+npas4::AllocationReport npas4::AllocationReport::operator-(const AllocationReport& x)
+{
+	npas4::AllocationReport r;
+	r.LiveBytes = this->LiveBytes - x.LiveBytes;
+	r.AllocatedBytes = this->AllocatedBytes - x.AllocatedBytes;
+	r.FreedBytes = this->FreedBytes - x.FreedBytes;
+	r.Allocations = this->Allocations - x.Allocations;
+	r.Deallocations = this->Deallocations - x.Deallocations;
+	r.Time = this->Time;
+
+	return r;
+}
+
+npas4::AllocationReport npas4::GetAllocationReport()
+{
+	npas4::AllocationReport x;
+	x.Time = std::chrono::steady_clock::now();
+
+	for(const auto& slot : Slots)
+	{
+		Accumulate(slot, x);
+	}
+
+	x.LiveBytes = x.AllocatedBytes - x.FreedBytes;
+	return x;
+}
+
+npas4::AllocationReport npas4::GetThreadAllocationReport()
+{
+	npas4::AllocationReport x;
+	x.Time = std::chrono::steady_clock::now();
+
+	const auto slot = GetSlot();
+
+	if(slot == Overflow)
+	{
+		return x;
+	}
+
+	Accumulate(*slot, x);
+	x.AllocatedBytes -= ThreadBase[0];
+	x.FreedBytes -= ThreadBase[1];
+	x.Allocations -= ThreadBase[2];
+	x.Deallocations -= ThreadBase[3];
+
+	x.LiveBytes = x.AllocatedBytes - x.FreedBytes;
+	return x;
+}
+
+npas4::AllocationRates npas4::GetAllocationRates(const npas4::AllocationReport& before, const npas4::AllocationReport& after)
+{
+	npas4::AllocationRates x;
+
+	const auto seconds = std::chrono::duration<double>(after.Time - before.Time).count();
+
+	if(seconds <= 0.0)
+	{
+		return x;
+	}
+
+	x.Allocations = static_cast<double>(after.Allocations - before.Allocations) / seconds;
+	x.Deallocations = static_cast<double>(after.Deallocations - before.Deallocations) / seconds;
+	x.AllocatedBytes = static_cast<double>(after.AllocatedBytes - before.AllocatedBytes) / seconds;
+	x.FreedBytes = static_cast<double>(after.FreedBytes - before.FreedBytes) / seconds;
+	return x;
+}
@@ -0,0 +1,268 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Arena.h>
+
+#include "ArenaRegistry.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <sstream>
+
+namespace
+{
+	struct Registry
+	{
+		std::mutex Mutex;
+		std::vector<npas4::impl::ArenaSource*> Sources;
+	};
+
+	///
+	/// Constructed on first use, so arenas may be created by static constructors.
+	///
+	Registry& GetRegistry()
+	{
+		static Registry x;
+		return x;
+	}
+
+	struct Chunk
+	{
+		Chunk* Next;
+		size_t Size;
+	};
+
+	///
+	/// A chunk's data starts after its header, suitably aligned for anything.
+	///
+	const size_t ChunkHeader{(sizeof(Chunk) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t)};
+
+	inline char* GetData(Chunk* x)
+	{
+		return reinterpret_cast<char*>(x) + ChunkHeader;
+	}
+
+	Chunk* NewChunk(size_t size)
+	{
+		auto x = static_cast<Chunk*>(malloc(ChunkHeader + size));
+
+		if(x == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+
+		x->Next = nullptr;
+		x->Size = size;
+		return x;
+	}
+} // namespace
+
+void npas4::impl::RegisterArena(npas4::impl::ArenaSource* x)
+{
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	registry.Sources.push_back(x);
+}
+
+void npas4::impl::UnregisterArena(npas4::impl::ArenaSource* x)
+{
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	registry.Sources.erase(std::remove(std::begin(registry.Sources), std::end(registry.Sources), x), std::end(registry.Sources));
+}
+
+npas4::ArenaReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Name:                              " << this->Name << std::endl;
+	ss << "Type:                              " << this->Type << std::endl;
+	ss << "Committed Bytes:                   " << this->CommittedBytes << std::endl;
+	ss << "Used Bytes:                        " << this->UsedBytes << std::endl;
+	ss << "Peak Used Bytes:                   " << this->PeakUsedBytes << std::endl;
+
+	return ss.str();
+}
+
+std::vector<npas4::ArenaReport> npas4::GetArenaReports()
+{
+	std::vector<npas4::ArenaReport> reports;
+
+	{
+		auto& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+
+		for(const auto& i : registry.Sources)
+		{
+			reports.push_back(i->GetReport());
+		}
+	}
+
+	std::stable_sort(std::begin(reports), std::end(reports),
+					 [](const npas4::ArenaReport& a, const npas4::ArenaReport& b) { return a.CommittedBytes > b.CommittedBytes; });
+
+	return reports;
+}
+
+///
+/// The chunk list, and what the report needs that the allocating thread keeps up to date.
+///
+class npas4::Arena::Impl : public npas4::impl::ArenaSource
+{
+public:
+	Impl(const npas4::Arena* arena, const char* name, size_t chunkSize)
+		: arena{arena}, name{name != nullptr ? name : "arena"}, chunkSize{std::max(chunkSize, sizeof(Chunk))}
+	{
+	}
+
+	npas4::ArenaReport GetReport() const override
+	{
+		npas4::ArenaReport x;
+		x.Name = this->name;
+		x.Type = "arena";
+		x.CommittedBytes = this->Committed.load(std::memory_order_relaxed);
+		x.UsedBytes = this->GetUsed();
+		x.PeakUsedBytes = std::max(x.UsedBytes, this->Peak.load(std::memory_order_relaxed));
+		return x;
+	}
+
+	int64_t GetUsed() const
+	{
+		return this->UsedBefore.load(std::memory_order_relaxed)
+			   + (this->arena->current.load(std::memory_order_relaxed) - this->Begin.load(std::memory_order_relaxed));
+	}
+
+	void UpdatePeak()
+	{
+		this->Peak.store(std::max(this->Peak.load(std::memory_order_relaxed), this->GetUsed()), std::memory_order_relaxed);
+	}
+
+	Chunk* Allocate(size_t size)
+	{
+		auto x = NewChunk(size);
+		this->Committed.fetch_add(static_cast<int64_t>(ChunkHeader + size), std::memory_order_relaxed);
+		return x;
+	}
+
+	const npas4::Arena* const arena;
+	const std::string name;
+	const size_t chunkSize;
+
+	Chunk* First{nullptr};
+	Chunk* Current{nullptr};
+
+	///
+	/// The start of the current chunk, and the bytes used in the chunks before it.
+	///
+	std::atomic<char*> Begin{nullptr};
+	std::atomic<int64_t> UsedBefore{0};
+
+	std::atomic<int64_t> Committed{0};
+	std::atomic<int64_t> Peak{0};
+};
+
+npas4::Arena::Arena(const char* name, size_t chunkSize) : pimpl{new Impl(this, name, chunkSize)}
+{
+	this->pimpl->First = this->pimpl->Allocate(this->pimpl->chunkSize);
+	this->pimpl->Current = this->pimpl->First;
+	this->Reset();
+
+	npas4::impl::RegisterArena(this->pimpl.get());
+}
+
+npas4::Arena::~Arena()
+{
+	npas4::impl::UnregisterArena(this->pimpl.get());
+
+	auto x = this->pimpl->First;
+
+	while(x != nullptr)
+	{
+		auto next = x->Next;
+		free(x);
+		x = next;
+	}
+}
+
+void npas4::Arena::Reset()
+{
+	this->pimpl->UpdatePeak();
+
+	auto first = this->pimpl->First;
+	this->pimpl->Current = first;
+	this->pimpl->UsedBefore.store(0, std::memory_order_relaxed);
+	this->pimpl->Begin.store(GetData(first), std::memory_order_relaxed);
+	this->current.store(GetData(first), std::memory_order_relaxed);
+	this->end = reinterpret_cast<uintptr_t>(GetData(first) + first->Size);
+}
+
+void npas4::Arena::Release()
+{
+	this->Reset();
+
+	auto x = this->pimpl->First->Next;
+	this->pimpl->First->Next = nullptr;
+
+	while(x != nullptr)
+	{
+		auto next = x->Next;
+		this->pimpl->Committed.fetch_sub(static_cast<int64_t>(ChunkHeader + x->Size), std::memory_order_relaxed);
+		free(x);
+		x = next;
+	}
+}
+
+npas4::ArenaReport npas4::Arena::GetReport() const
+{
+	return this->pimpl->GetReport();
+}
+
+void* npas4::Arena::grow(size_t bytes, size_t alignment)
+{
+	// Room for the allocation however its chunk's data happens to be aligned.
+	const auto needed = bytes + (alignment > alignof(std::max_align_t) ? alignment : 0);
+
+	if(needed < bytes)
+	{
+		throw std::bad_alloc();
+	}
+
+	// Use the next chunk if it is big enough (as after a Reset()), or else insert a new one before it.  The rest of the current chunk is
+	// left unused.
+	auto current = this->pimpl->Current;
+	auto next = current->Next;
+
+	if(next == nullptr || next->Size < needed)
+	{
+		auto x = this->pimpl->Allocate(std::max(this->pimpl->chunkSize, needed));
+		x->Next = next;
+		current->Next = x;
+		next = x;
+	}
+
+	this->pimpl->UpdatePeak();
+	this->pimpl->UsedBefore.store(this->pimpl->GetUsed(), std::memory_order_relaxed);
+	this->pimpl->Current = next;
+	this->pimpl->Begin.store(GetData(next), std::memory_order_relaxed);
+	this->current.store(GetData(next), std::memory_order_relaxed);
+	this->end = reinterpret_cast<uintptr_t>(GetData(next) + next->Size);
+
+	return this->Allocate(bytes, alignment);
+}
@@ -0,0 +1,46 @@
+#ifndef H_NPAS4_ARENAREGISTRY_H
+#define H_NPAS4_ARENAREGISTRY_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// The list of arenas and pools behind GetArenaReports().
+///
+
+#include <npas4/Arena.h>
+
+namespace npas4
+{
+	namespace impl
+	{
+		class ArenaSource
+		{
+		public:
+			virtual ~ArenaSource() = default;
+
+			///
+			/// Called from any thread, under the registry's lock.
+			///
+			virtual npas4::ArenaReport GetReport() const = 0;
+		};
+
+		void RegisterArena(npas4::impl::ArenaSource* x);
+		void UnregisterArena(npas4::impl::ArenaSource* x);
+	} // namespace impl
+} // namespace npas4
+
+#endif
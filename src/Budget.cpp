@@ -0,0 +1,264 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Budget.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	const int64_t Unlimited{std::numeric_limits<int64_t>::max()};
+} // namespace
+
+class npas4::Budget::Impl
+{
+public:
+	explicit Impl(const npas4::BudgetOptions& x) : options(x)
+	{
+		this->cap.store(x.Cap, std::memory_order_relaxed);
+		this->Refresh();
+
+		if(x.Interval > std::chrono::nanoseconds(0))
+		{
+			this->thread = std::thread([this]() { this->Run(); });
+		}
+	}
+
+	~Impl()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+
+		this->wake.notify_all();
+
+		if(this->thread.joinable() == true)
+		{
+			this->thread.join();
+		}
+	}
+
+	void Run()
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+
+		while(this->wake.wait_for(lock, this->options.Interval, [this]() { return this->stopping; }) == false)
+		{
+			lock.unlock();
+			this->Refresh();
+			lock.lock();
+		}
+	}
+
+	void Refresh()
+	{
+		uint32_t fields{0};
+
+		if(this->options.UsePhysicalAvailable == true)
+		{
+			fields |= npas4::RAMReportField::PhysicalAvailable;
+		}
+
+		if(this->options.UseCgroupAvailable == true)
+		{
+			fields |= npas4::RAMReportField::CgroupAvailable;
+		}
+
+		int64_t x{-1};
+
+		// What reserved work has already allocated is missing from the available memory, so the limit adds back what was reserved when
+		// it was read.  Taking the smaller of the totals before and after keeps a reservation made or released meanwhile from being added
+		// back without its memory having been taken from (or returned to) the available memory.
+		auto reservedNow = this->reserved.load(std::memory_order_relaxed);
+
+		if(fields != 0)
+		{
+			const auto report = npas4::GetRAMReport(fields);
+
+			if(this->options.UsePhysicalAvailable == true)
+			{
+				x = report.RamPhysicalAvailable;
+			}
+
+			if(this->options.UseCgroupAvailable == true)
+			{
+				x = (x < 0) ? report.RamCgroupAvailable : std::min(x, report.RamCgroupAvailable);
+			}
+		}
+
+		reservedNow = std::min(reservedNow, this->reserved.load(std::memory_order_relaxed));
+
+		{
+			std::lock_guard<std::mutex> lock(this->limitMutex);
+			this->available.store(x, std::memory_order_relaxed);
+			this->reservedAtRefresh = reservedNow;
+		}
+
+		this->UpdateLimit();
+		this->refreshes.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	///
+	/// Serialized, so that a refresh and a change of cap cannot leave the limit of whichever computed it first.
+	///
+	void UpdateLimit()
+	{
+		std::lock_guard<std::mutex> lock(this->limitMutex);
+
+		auto x = Unlimited;
+		const auto availableNow = this->available.load(std::memory_order_relaxed);
+		const auto capNow = this->cap.load(std::memory_order_relaxed);
+
+		if(availableNow >= 0)
+		{
+			x = std::max(int64_t(0), availableNow - this->options.Headroom) + this->reservedAtRefresh;
+		}
+
+		if(capNow > 0)
+		{
+			x = std::min(x, capNow);
+		}
+
+		this->limit.store(x, std::memory_order_relaxed);
+	}
+
+	const npas4::BudgetOptions options;
+
+	std::atomic<int64_t> reserved{0};
+	std::atomic<int64_t> limit{Unlimited};
+	std::atomic<int64_t> available{-1};
+	std::atomic<int64_t> cap{0};
+	std::atomic<int64_t> reservations{0};
+	std::atomic<int64_t> refused{0};
+	std::atomic<int64_t> refreshes{0};
+
+	std::mutex limitMutex;
+
+	///
+	/// The total reserved when the available memory was last read.  Guarded by limitMutex.
+	///
+	int64_t reservedAtRefresh{0};
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping{false};
+
+	std::thread thread;
+};
+
+npas4::BudgetReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Limit:                             " << this->Limit << std::endl;
+	ss << "Available:                         " << this->Available << std::endl;
+	ss << "Reserved:                          " << this->Reserved << std::endl;
+	ss << "Reservations:                      " << this->Reservations << std::endl;
+	ss << "Refused:                           " << this->Refused << std::endl;
+	ss << "Refreshes:                         " << this->Refreshes << std::endl;
+
+	return ss.str();
+}
+
+npas4::Budget::Budget(const npas4::BudgetOptions& x) : pimpl(new Impl(x))
+{
+}
+
+npas4::Budget::~Budget()
+{
+}
+
+bool npas4::Budget::Reserve(int64_t bytes)
+{
+	if(bytes > 0)
+	{
+		const auto limit = this->pimpl->limit.load(std::memory_order_relaxed);
+		auto reserved = this->pimpl->reserved.load(std::memory_order_relaxed);
+
+		do
+		{
+			// Written so as not to overflow when the limit is Unlimited.
+			if(bytes > limit - reserved)
+			{
+				this->pimpl->refused.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		} while(this->pimpl->reserved.compare_exchange_weak(reserved, reserved + bytes, std::memory_order_relaxed) == false);
+	}
+
+	this->pimpl->reservations.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void npas4::Budget::Release(int64_t bytes)
+{
+	if(bytes > 0)
+	{
+		this->pimpl->reserved.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+}
+
+void npas4::Budget::Refresh()
+{
+	this->pimpl->Refresh();
+}
+
+void npas4::Budget::SetCap(int64_t x)
+{
+	this->pimpl->cap.store(x, std::memory_order_relaxed);
+	this->pimpl->UpdateLimit();
+}
+
+npas4::BudgetReport npas4::Budget::GetReport() const
+{
+	npas4::BudgetReport x;
+
+	const auto limit = this->pimpl->limit.load(std::memory_order_relaxed);
+	x.Limit = (limit == Unlimited) ? -1 : limit;
+	x.Available = this->pimpl->available.load(std::memory_order_relaxed);
+	x.Reserved = this->pimpl->reserved.load(std::memory_order_relaxed);
+	x.Reservations = this->pimpl->reservations.load(std::memory_order_relaxed);
+	x.Refused = this->pimpl->refused.load(std::memory_order_relaxed);
+	x.Refreshes = this->pimpl->refreshes.load(std::memory_order_relaxed);
+	return x;
+}
+
+npas4::ScopedReservation::ScopedReservation(npas4::Budget& budget, int64_t bytes)
+	: budget(budget), bytes{bytes}, reserved{budget.Reserve(bytes)}
+{
+}
+
+npas4::ScopedReservation::~ScopedReservation()
+{
+	if(this->reserved == true)
+	{
+		this->budget.Release(this->bytes);
+	}
+}
+
+bool npas4::ScopedReservation::IsReserved() const
+{
+	return this->reserved;
+}
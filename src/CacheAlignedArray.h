@@ -0,0 +1,98 @@
+#ifndef H_NPAS4_CACHEALIGNEDARRAY_H
+#define H_NPAS4_CACHEALIGNEDARRAY_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// \class CacheAlignedArray
+		///
+		/// A fixed size heap array of value initialized elements that honours the elements' alignment.  Before C++17, operator new only
+		/// aligns to alignof(std::max_align_t), so an array of alignas(64) per-thread structures made with new[] can straddle cache lines.
+		///
+		template <typename T>
+		class CacheAlignedArray
+		{
+		public:
+			explicit CacheAlignedArray(size_t count) : count{count}, block{malloc(count * sizeof(T) + alignof(T))}
+			{
+				if(this->block == nullptr)
+				{
+					throw std::bad_alloc();
+				}
+
+				const auto aligned = (reinterpret_cast<uintptr_t>(this->block) + alignof(T) - 1) & ~(static_cast<uintptr_t>(alignof(T)) - 1);
+				this->data = reinterpret_cast<T*>(aligned);
+
+				for(size_t i = 0; i < this->count; ++i)
+				{
+					new(this->data + i) T();
+				}
+			}
+
+			~CacheAlignedArray()
+			{
+				for(size_t i = 0; i < this->count; ++i)
+				{
+					this->data[i].~T();
+				}
+
+				free(this->block);
+			}
+
+			CacheAlignedArray(const CacheAlignedArray&) = delete;
+			CacheAlignedArray& operator=(const CacheAlignedArray&) = delete;
+
+			T& operator[](size_t i)
+			{
+				return this->data[i];
+			}
+
+			const T& operator[](size_t i) const
+			{
+				return this->data[i];
+			}
+
+			const T* begin() const
+			{
+				return this->data;
+			}
+
+			const T* end() const
+			{
+				return this->data + this->count;
+			}
+
+		private:
+			const size_t count;
+			void* const block;
+			T* data{nullptr};
+		};
+	} // namespace impl
+} // namespace npas4
+
+#endif
@@ -0,0 +1,282 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Cached.h>
+
+#include "CgroupFiles.h"
+#include "RingBuffer.h"
+#include "Snapshot.h"
+
+#include <atomic>
+
+namespace npas4
+{
+	namespace impl
+	{
+		std::atomic<int64_t> CacheTTL{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(10)).count()};
+
+		int64_t Now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		///
+		/// \class CachedSource
+		///
+		/// One snapshot source shared by every thread.  The first caller to observe an expired value wins a compare-and-swap and refreshes it;
+		/// everyone else returns the previous value without waiting.  Only before the very first refresh has completed does a losing caller
+		/// query the operating system itself.
+		///
+		template <typename T>
+		class CachedSource
+		{
+		public:
+			explicit CachedSource(bool (*x)(T&)) : read(x)
+			{
+			}
+
+			T Get()
+			{
+				const auto now = npas4::impl::Now();
+
+				if(now >= this->expires.load(std::memory_order_acquire))
+				{
+					auto expected = false;
+
+					if(this->refreshing.compare_exchange_strong(expected, true, std::memory_order_acquire) == true)
+					{
+						// Another caller may have completed a refresh between our expiry check and the compare-and-swap.
+						if(now < this->expires.load(std::memory_order_acquire))
+						{
+							this->refreshing.store(false, std::memory_order_release);
+							T x;
+							this->value.Load(x);
+							return x;
+						}
+
+						const auto generation = this->generation.load();
+
+						T x;
+						this->read(x);
+						this->value.Store(x);
+						this->populated.store(true, std::memory_order_release);
+						this->expires.store(now + npas4::impl::CacheTTL.load(std::memory_order_relaxed));
+
+						// An Invalidate() since the read began may be for a change the read missed, so the value is published already
+						// expired.  (Checked after the store: either this sees the new generation, or Invalidate()'s store comes later.)
+						if(this->generation.load() != generation)
+						{
+							this->expires.store(0);
+						}
+
+						this->refreshing.store(false, std::memory_order_release);
+						return x;
+					}
+
+					if(this->populated.load(std::memory_order_acquire) == false)
+					{
+						T x;
+						this->read(x);
+						return x;
+					}
+				}
+
+				T x;
+				this->value.Load(x);
+				return x;
+			}
+
+			void Invalidate()
+			{
+				this->generation.fetch_add(1);
+				this->expires.store(0);
+			}
+
+		private:
+			bool (*read)(T&);
+			npas4::impl::SeqLock<T> value;
+			std::atomic<int64_t> expires{0};
+
+			///
+			/// Advanced by each Invalidate(), so that a refresh running at the time does not publish a value that is not yet expired.
+			///
+			std::atomic<uint64_t> generation{0};
+			std::atomic<bool> populated{false};
+			std::atomic<bool> refreshing{false};
+		};
+
+		CachedSource<npas4::impl::SystemSnapshot>& CachedSystem()
+		{
+			static CachedSource<npas4::impl::SystemSnapshot> source(&npas4::impl::ReadSystemSnapshot);
+			return source;
+		}
+
+		CachedSource<npas4::impl::ProcessSnapshot>& CachedProcess()
+		{
+			static CachedSource<npas4::impl::ProcessSnapshot> source(&npas4::impl::ReadProcessSnapshot);
+			return source;
+		}
+
+		CachedSource<npas4::CgroupReport>& CachedCgroup()
+		{
+			static CachedSource<npas4::CgroupReport> source(&npas4::impl::ReadCgroupSnapshot);
+			return source;
+		}
+
+		CachedSource<npas4::impl::SmapsSnapshot>& CachedSmaps()
+		{
+			static CachedSource<npas4::impl::SmapsSnapshot> source(&npas4::impl::ReadSmapsSnapshot);
+			return source;
+		}
+
+		npas4::RAMReport CachedCgroupReport()
+		{
+			npas4::impl::Snapshot x;
+			x.System = npas4::impl::CachedSystem().Get();
+			x.Cgroup = npas4::impl::CachedCgroup().Get();
+
+			npas4::RAMReport r;
+			npas4::impl::FillReport(x, r);
+			return r;
+		}
+	} // namespace impl
+} // namespace npas4
+
+void npas4::cached::SetTTL(std::chrono::nanoseconds x)
+{
+	npas4::impl::CacheTTL.store((x.count() > 0) ? x.count() : 0, std::memory_order_relaxed);
+	npas4::cached::Invalidate();
+}
+
+std::chrono::nanoseconds npas4::cached::GetTTL()
+{
+	return std::chrono::nanoseconds(npas4::impl::CacheTTL.load(std::memory_order_relaxed));
+}
+
+void npas4::cached::Invalidate()
+{
+	npas4::impl::CachedSystem().Invalidate();
+	npas4::impl::CachedProcess().Invalidate();
+	npas4::impl::CachedCgroup().Invalidate();
+	npas4::impl::CachedSmaps().Invalidate();
+}
+
+int64_t npas4::cached::GetRAMSystemTotal()
+{
+	return npas4::impl::CachedSystem().Get().SystemTotal;
+}
+
+int64_t npas4::cached::GetRAMSystemAvailable()
+{
+	return npas4::impl::CachedSystem().Get().SystemAvailable;
+}
+
+int64_t npas4::cached::GetRAMSystemUsed()
+{
+	const auto x = npas4::impl::CachedSystem().Get();
+	return x.SystemTotal - x.SystemAvailable;
+}
+
+int64_t npas4::cached::GetRAMSystemUsedByCurrentProcess()
+{
+	return npas4::impl::SystemUsedByCurrentProcess(npas4::impl::CachedProcess().Get());
+}
+
+int64_t npas4::cached::GetRAMPhysicalTotal()
+{
+	return npas4::impl::CachedSystem().Get().PhysicalTotal;
+}
+
+int64_t npas4::cached::GetRAMPhysicalAvailable()
+{
+	return npas4::impl::CachedSystem().Get().PhysicalAvailable;
+}
+
+int64_t npas4::cached::GetRAMPhysicalUsed()
+{
+	const auto x = npas4::impl::CachedSystem().Get();
+	return x.PhysicalTotal - x.PhysicalAvailable;
+}
+
+int64_t npas4::cached::GetRAMPhysicalUsedByCurrentProcess()
+{
+	return npas4::impl::CachedProcess().Get().Physical;
+}
+
+int64_t npas4::cached::GetRAMPhysicalUsedByCurrentProcessPeak()
+{
+	return npas4::impl::CachedProcess().Get().PhysicalPeak;
+}
+
+int64_t npas4::cached::GetRAMVirtualTotal()
+{
+	return npas4::impl::CachedSystem().Get().VirtualTotal;
+}
+
+int64_t npas4::cached::GetRAMVirtualAvailable()
+{
+	return npas4::impl::CachedSystem().Get().VirtualAvailable;
+}
+
+int64_t npas4::cached::GetRAMVirtualUsed()
+{
+	const auto x = npas4::impl::CachedSystem().Get();
+	return x.VirtualTotal - x.VirtualAvailable;
+}
+
+int64_t npas4::cached::GetRAMVirtualUsedByCurrentProcess()
+{
+	return npas4::impl::CachedProcess().Get().Virtual;
+}
+
+int64_t npas4::cached::GetRAMProportionalUsedByCurrentProcess()
+{
+	return npas4::impl::CachedSmaps().Get().Pss;
+}
+
+int64_t npas4::cached::GetRAMUniqueUsedByCurrentProcess()
+{
+	return npas4::impl::CachedSmaps().Get().Uss;
+}
+
+int64_t npas4::cached::GetRAMCgroupTotal()
+{
+	return npas4::impl::CachedCgroupReport().RamCgroupTotal;
+}
+
+int64_t npas4::cached::GetRAMCgroupAvailable()
+{
+	return npas4::impl::CachedCgroupReport().RamCgroupAvailable;
+}
+
+int64_t npas4::cached::GetRAMCgroupUsed()
+{
+	return npas4::impl::CachedCgroupReport().RamCgroupUsed;
+}
+
+npas4::RAMReport npas4::cached::GetRAMReport()
+{
+	npas4::impl::Snapshot x;
+	x.System = npas4::impl::CachedSystem().Get();
+	x.Process = npas4::impl::CachedProcess().Get();
+	x.Cgroup = npas4::impl::CachedCgroup().Get();
+
+	npas4::RAMReport r;
+	npas4::impl::FillReport(x, r);
+	return r;
+}
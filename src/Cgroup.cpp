@@ -0,0 +1,515 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Cgroup.h>
+
+#include "CgroupFiles.h"
+#include "ProcFile.h"
+#include "ProcParser.h"
+#include "ReadBatch.h"
+
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#ifndef WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+///
+/// References:
+/// https://www.kernel.org/doc/Documentation/cgroup-v2.txt
+/// https://www.kernel.org/doc/Documentation/cgroup-v1/memory.txt
+///
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// The files of one cgroup version.  v1 has no swap-only files; its "swap" files count memory plus swap.
+		///
+		struct CgroupFileNames
+		{
+			const char* Max;
+			const char* High;
+			const char* SwapMax;
+			const char* Current;
+			const char* SwapCurrent;
+
+			///
+			/// The memory.stat key of the inactive page cache.  v1 counts it hierarchically under a separate key.
+			///
+			const char* InactiveFile;
+		};
+
+		const CgroupFileNames& FileNames(npas4::CgroupVersion x)
+		{
+			static const CgroupFileNames v1{"memory.limit_in_bytes", "memory.soft_limit_in_bytes", "memory.memsw.limit_in_bytes",
+											"memory.usage_in_bytes", "memory.memsw.usage_in_bytes", "total_inactive_file"};
+			static const CgroupFileNames v2{"memory.max", "memory.high", "memory.swap.max", "memory.current", "memory.swap.current",
+											"inactive_file"};
+			return (x == npas4::CgroupVersion::V1) ? v1 : v2;
+		}
+
+		bool Exists(const std::string& x)
+		{
+#ifdef WIN32
+			(void)x;
+			return false;
+#else
+			return access(x.c_str(), F_OK) == 0;
+#endif
+		}
+
+		int OpenValue(const std::string& directory, const char* name)
+		{
+#ifdef WIN32
+			(void)directory;
+			(void)name;
+			return -1;
+#else
+			return open((directory + "/" + name).c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+		}
+
+		void CloseValue(int& fd)
+		{
+#ifndef WIN32
+			if(fd >= 0)
+			{
+				close(fd);
+			}
+#endif
+
+			fd = -1;
+		}
+
+		///
+		/// Every cgroup memory file is a single value, so one small pread() reads it.  Returns the bytes read, or -1.
+		///
+		int64_t ReadValue(int fd, char* buffer, size_t size)
+		{
+#ifdef WIN32
+			(void)fd;
+			(void)buffer;
+			(void)size;
+			return -1;
+#else
+			if(fd < 0)
+			{
+				return -1;
+			}
+
+			ssize_t bytes;
+
+			do
+			{
+				bytes = pread(fd, buffer, size, 0);
+			} while(bytes < 0 && errno == EINTR);
+
+			return (bytes >= 0) ? static_cast<int64_t>(bytes) : -1;
+#endif
+		}
+
+		///
+		/// The positions of each file within CgroupFiles::files.
+		///
+		constexpr size_t CurrentFile{0};
+		constexpr size_t SwapCurrentFile{1};
+		constexpr size_t FirstLimitFile{2};
+		constexpr size_t FilesPerLevel{3};
+	} // namespace impl
+} // namespace npas4
+
+void npas4::impl::ParseCgroupMembership(const char* data, size_t size, npas4::impl::CgroupMembership& x)
+{
+	x = CgroupMembership();
+
+	const auto end = data + size;
+	auto p = data;
+
+	while(p < end)
+	{
+		auto eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+
+		if(eol == nullptr)
+		{
+			eol = end;
+		}
+
+		const auto first = static_cast<const char*>(memchr(p, ':', static_cast<size_t>(eol - p)));
+		const auto second = (first != nullptr) ? static_cast<const char*>(memchr(first + 1, ':', static_cast<size_t>(eol - first - 1))) : nullptr;
+
+		if(second != nullptr)
+		{
+			const auto hierarchy = std::string(p, first);
+			const auto controllers = std::string(first + 1, second);
+			const auto path = std::string(second + 1, eol);
+
+			if(hierarchy == "0" && controllers.empty() == true)
+			{
+				x.V2 = true;
+				x.V2Path = path;
+			}
+			else
+			{
+				// The controller list is comma separated, e.g. "cpu,cpuacct".
+				const auto list = "," + controllers + ",";
+
+				if(list.find(",memory,") != std::string::npos)
+				{
+					x.V1 = true;
+					x.V1Path = path;
+				}
+			}
+		}
+
+		p = eol + 1;
+	}
+}
+
+bool npas4::impl::ParseCgroupValue(const char* data, size_t size, int64_t& x)
+{
+	const auto end = data + size;
+
+	if(size >= 3 && memcmp(data, "max", 3) == 0)
+	{
+		x = -1;
+		return true;
+	}
+
+	auto p = data;
+	const auto value = npas4::impl::ParseInt64(p, end);
+
+	if(p == data)
+	{
+		return false;
+	}
+
+	// v1 reports "no limit" as LLONG_MAX rounded down to a page.
+	constexpr int64_t Unlimited{int64_t(1) << 62};
+	x = (value >= Unlimited) ? -1 : value;
+	return true;
+}
+
+bool npas4::impl::ParseCgroupStat(const char* data, size_t size, const char* key, int64_t& x)
+{
+	const auto end = data + size;
+	const auto length = strlen(key);
+	auto p = data;
+
+	while(p < end)
+	{
+		auto eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+
+		if(eol == nullptr)
+		{
+			eol = end;
+		}
+
+		if(static_cast<size_t>(eol - p) > length && memcmp(p, key, length) == 0 && p[length] == ' ')
+		{
+			auto v = p + length + 1;
+			x = npas4::impl::ParseInt64(v, eol);
+			return v != p + length + 1;
+		}
+
+		p = eol + 1;
+	}
+
+	return false;
+}
+
+npas4::impl::CgroupLocation npas4::impl::FindCgroup(const std::string& root)
+{
+	npas4::impl::CgroupLocation x;
+	npas4::impl::ProcFile file((root + "/proc/self/cgroup").c_str());
+
+	if(file.Read() == false)
+	{
+		return x;
+	}
+
+	npas4::impl::CgroupMembership membership;
+	npas4::impl::ParseCgroupMembership(file.Data(), file.Size(), membership);
+
+	std::string mount;
+	std::string path;
+
+	if(membership.V1 == true && npas4::impl::Exists(root + "/sys/fs/cgroup/memory") == true)
+	{
+		x.Version = npas4::CgroupVersion::V1;
+		mount = root + "/sys/fs/cgroup/memory";
+		path = membership.V1Path;
+	}
+	else if(membership.V2 == true && npas4::impl::Exists(root + "/sys/fs/cgroup/cgroup.controllers") == true)
+	{
+		x.Version = npas4::CgroupVersion::V2;
+		mount = root + "/sys/fs/cgroup";
+		path = membership.V2Path;
+	}
+	else
+	{
+		return x;
+	}
+
+	while(path.empty() == false && path.back() == '/')
+	{
+		path.pop_back();
+	}
+
+	const auto current = npas4::impl::FileNames(x.Version).Current;
+	auto directory = mount + path;
+
+	if(npas4::impl::Exists(directory + "/" + current) == false)
+	{
+		directory = mount;
+
+		// The root of the v2 hierarchy has no memory.current: the process is not in a memory controlled cgroup.
+		if(npas4::impl::Exists(directory + "/" + current) == false)
+		{
+			x.Version = npas4::CgroupVersion::None;
+			return x;
+		}
+	}
+
+	while(directory.size() > mount.size())
+	{
+		x.Directories.push_back(directory);
+		directory.erase(directory.rfind('/'));
+	}
+
+	x.Directories.push_back(mount);
+	return x;
+}
+
+const npas4::impl::CgroupLocation& npas4::impl::SelfCgroup()
+{
+	static const auto location = npas4::impl::FindCgroup(std::string());
+	return location;
+}
+
+constexpr size_t npas4::impl::CgroupFiles::ValueSize;
+
+npas4::impl::CgroupFiles::CgroupFiles()
+{
+}
+
+npas4::impl::CgroupFiles::~CgroupFiles()
+{
+	this->Close();
+}
+
+bool npas4::impl::CgroupFiles::Open(const npas4::impl::CgroupLocation& x)
+{
+	this->Close();
+
+	if(x.Version == npas4::CgroupVersion::None || x.Directories.empty() == true)
+	{
+		return false;
+	}
+
+	const auto& names = npas4::impl::FileNames(x.Version);
+
+	this->files.push_back(npas4::impl::OpenValue(x.Directories.front(), names.Current));
+	this->files.push_back(npas4::impl::OpenValue(x.Directories.front(), names.SwapCurrent));
+
+	for(const auto& directory : x.Directories)
+	{
+		this->files.push_back(npas4::impl::OpenValue(directory, names.Max));
+		this->files.push_back(npas4::impl::OpenValue(directory, names.High));
+		this->files.push_back(npas4::impl::OpenValue(directory, names.SwapMax));
+	}
+
+	this->stat.Open((x.Directories.front() + "/memory.stat").c_str());
+
+	this->buffers.resize(this->files.size() * ValueSize);
+	this->sizes.resize(this->files.size());
+	this->version = x.Version;
+	return this->IsOpen();
+}
+
+void npas4::impl::CgroupFiles::Close()
+{
+	for(auto& fd : this->files)
+	{
+		npas4::impl::CloseValue(fd);
+	}
+
+	this->stat.Close();
+	this->files.clear();
+	this->buffers.clear();
+	this->sizes.clear();
+	this->version = npas4::CgroupVersion::None;
+}
+
+bool npas4::impl::CgroupFiles::IsOpen() const
+{
+	return this->files.empty() == false && this->files[npas4::impl::CurrentFile] >= 0;
+}
+
+bool npas4::impl::CgroupFiles::Read(npas4::CgroupReport& x) const
+{
+	for(size_t i = 0; i < this->files.size(); ++i)
+	{
+		this->sizes[i] = npas4::impl::ReadValue(this->files[i], &this->buffers[i * ValueSize], ValueSize);
+	}
+
+	this->stat.Read();
+	return this->Parse(x);
+}
+
+void npas4::impl::CgroupFiles::Enqueue(npas4::impl::ReadBatch& x)
+{
+	this->first = x.Size();
+
+	for(size_t i = 0; i < this->files.size(); ++i)
+	{
+		x.Add(this->files[i], &this->buffers[i * ValueSize], ValueSize);
+	}
+
+	this->statIndex = this->stat.Enqueue(x);
+}
+
+bool npas4::impl::CgroupFiles::Complete(const npas4::impl::ReadBatch& x, npas4::CgroupReport& r) const
+{
+	for(size_t i = 0; i < this->files.size(); ++i)
+	{
+		this->sizes[i] = x.Result(this->first + i);
+	}
+
+	this->stat.Complete(x.Result(this->statIndex));
+	return this->Parse(r);
+}
+
+bool npas4::impl::CgroupFiles::Parse(npas4::CgroupReport& x) const
+{
+	x = npas4::CgroupReport();
+
+	const auto value = [this](size_t i, int64_t& v) {
+		return this->sizes[i] > 0 && npas4::impl::ParseCgroupValue(&this->buffers[i * ValueSize], static_cast<size_t>(this->sizes[i]), v);
+	};
+
+	// Folds one more level of the hierarchy into an effective limit.
+	const auto limit = [&value](size_t i, int64_t& v) {
+		int64_t level;
+
+		if(value(i, level) == true && level >= 0 && (v < 0 || level < v))
+		{
+			v = level;
+		}
+	};
+
+	int64_t current;
+
+	if(this->IsOpen() == false || value(npas4::impl::CurrentFile, current) == false)
+	{
+		return false;
+	}
+
+	for(auto i = npas4::impl::FirstLimitFile; i < this->files.size(); i += npas4::impl::FilesPerLevel)
+	{
+		limit(i, x.MemoryMax);
+		limit(i + 1, x.MemoryHigh);
+		limit(i + 2, x.SwapMax);
+	}
+
+	int64_t swapCurrent;
+
+	if(value(npas4::impl::SwapCurrentFile, swapCurrent) == false)
+	{
+		swapCurrent = 0;
+	}
+
+	if(this->version == npas4::CgroupVersion::V1)
+	{
+		// memsw counts memory plus swap.
+		x.SwapMax = (x.SwapMax >= 0 && x.MemoryMax >= 0) ? x.SwapMax - x.MemoryMax : -1;
+		swapCurrent = (swapCurrent > current) ? swapCurrent - current : 0;
+	}
+
+	int64_t inactiveFile;
+
+	if(npas4::impl::ParseCgroupStat(this->stat.Data(), this->stat.Size(), npas4::impl::FileNames(this->version).InactiveFile, inactiveFile)
+	   == false)
+	{
+		inactiveFile = 0;
+	}
+
+	x.Version = this->version;
+	x.MemoryCurrent = current;
+	x.InactiveFile = (inactiveFile < current) ? inactiveFile : current;
+	x.SwapCurrent = swapCurrent;
+	return true;
+}
+
+bool npas4::impl::ReadCgroupSnapshot(npas4::CgroupReport& x)
+{
+	// Opened once, like SelfCgroup(), so a read costs one pread() per file rather than an open() and a path per file.  The files share one
+	// set of buffers, so readers take turns.
+	static npas4::impl::CgroupFiles files;
+	static const auto opened = files.Open(npas4::impl::SelfCgroup());
+	static std::mutex lock;
+
+	if(opened == false)
+	{
+		x = npas4::CgroupReport();
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	return files.Read(x);
+}
+
+npas4::CgroupReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Cgroup Version:                    " << static_cast<int>(this->Version) << std::endl;
+	ss << "Cgroup MemoryMax:                  " << this->MemoryMax << std::endl;
+	ss << "Cgroup MemoryHigh:                 " << this->MemoryHigh << std::endl;
+	ss << "Cgroup MemoryCurrent:              " << this->MemoryCurrent << std::endl;
+	ss << "Cgroup InactiveFile:               " << this->InactiveFile << std::endl;
+	ss << "Cgroup SwapMax:                    " << this->SwapMax << std::endl;
+	ss << "Cgroup SwapCurrent:                " << this->SwapCurrent << std::endl;
+
+	return ss.str();
+}
+
+npas4::CgroupReport npas4::GetCgroupReport()
+{
+	npas4::CgroupReport x;
+	npas4::impl::ReadCgroupSnapshot(x);
+	return x;
+}
+
+npas4::CgroupReport npas4::GetCgroupReport(const std::string& root)
+{
+	npas4::CgroupReport x;
+	npas4::impl::CgroupFiles files;
+
+	if(files.Open(npas4::impl::FindCgroup(root)) == true)
+	{
+		files.Read(x);
+	}
+
+	return x;
+}
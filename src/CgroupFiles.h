@@ -0,0 +1,165 @@
+#ifndef H_NPAS4_CGROUPFILES_H
+#define H_NPAS4_CGROUPFILES_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Cgroup.h>
+
+#include "ProcFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace npas4
+{
+	namespace impl
+	{
+		class ReadBatch;
+
+		///
+		/// The cgroup paths named in /proc/self/cgroup.
+		///
+		struct CgroupMembership
+		{
+			///
+			/// True if a v1 hierarchy has the memory controller attached.
+			///
+			bool V1{false};
+			std::string V1Path;
+
+			///
+			/// True if the process is in the unified (v2) hierarchy.
+			///
+			bool V2{false};
+			std::string V2Path;
+		};
+
+		///
+		/// Where the memory files of a process's cgroup live.
+		///
+		struct CgroupLocation
+		{
+			npas4::CgroupVersion Version{npas4::CgroupVersion::None};
+
+			///
+			/// The cgroup's directory followed by each of its ancestors, ending at the hierarchy's mount point.
+			///
+			std::vector<std::string> Directories;
+		};
+
+		///
+		/// Parses the text of /proc/<pid>/cgroup ("hierarchy-ID:controller-list:cgroup-path" lines).
+		///
+		void ParseCgroupMembership(const char* data, size_t size, CgroupMembership& x);
+
+		///
+		/// Parses one cgroup memory value.  "max", and the near-LLONG_MAX values v1 uses for "no limit", become -1.
+		/// Returns false if the text is not a number.
+		///
+		bool ParseCgroupValue(const char* data, size_t size, int64_t& x);
+
+		///
+		/// Finds the value of 'key' in the text of a memory.stat file ("key value" lines).  Returns false if the key is missing.
+		///
+		bool ParseCgroupStat(const char* data, size_t size, const char* key, int64_t& x);
+
+		///
+		/// Locates the memory cgroup of the process described by <root>/proc/self/cgroup.  A v1 memory controller is preferred over the
+		/// unified hierarchy, since on hybrid systems memory is only accounted in v1.
+		///
+		/// When the cgroup's directory is not visible (e.g. inside a container without a cgroup namespace, where /proc/self/cgroup names the
+		/// host's path but the container only mounts its own cgroup), the mount point itself is used.
+		///
+		CgroupLocation FindCgroup(const std::string& root);
+
+		///
+		/// The location of the current process's memory cgroup, found the first time this is called.
+		///
+		const CgroupLocation& SelfCgroup();
+
+		///
+		/// \class CgroupFiles
+		///
+		/// The memory files of one cgroup and its ancestors, held open for repeated sampling like ProcFile.  Missing files (limits that the
+		/// kernel does not expose at a given level) are skipped.  Besides the single value files, the cgroup's memory.stat is read for its
+		/// inactive page cache.
+		///
+		class CgroupFiles
+		{
+		public:
+			CgroupFiles();
+			~CgroupFiles();
+
+			CgroupFiles(const CgroupFiles&) = delete;
+			CgroupFiles& operator=(const CgroupFiles&) = delete;
+
+			///
+			/// Returns false if the cgroup's usage file could not be opened.
+			///
+			bool Open(const CgroupLocation& x);
+
+			void Close();
+
+			bool IsOpen() const;
+
+			///
+			/// Re-reads every file.  Returns false (leaving 'x' default constructed) if the usage could not be read.
+			///
+			bool Read(npas4::CgroupReport& x) const;
+
+			///
+			/// Queues a read of every file on a batch.  Once the batch is submitted, Complete() parses the results as Read() would.
+			///
+			void Enqueue(npas4::impl::ReadBatch& x);
+			bool Complete(const npas4::impl::ReadBatch& x, npas4::CgroupReport& r) const;
+
+		private:
+			///
+			/// Every cgroup memory file holds a single value, which fits in this many bytes.
+			///
+			static constexpr size_t ValueSize{32};
+
+			bool Parse(npas4::CgroupReport& x) const;
+
+			npas4::CgroupVersion version{npas4::CgroupVersion::None};
+
+			///
+			/// The usage, the swap usage, then the limit, high limit, and swap limit of each level from the cgroup up.  Missing files are -1.
+			///
+			std::vector<int> files;
+
+			mutable std::vector<char> buffers;
+			mutable std::vector<int64_t> sizes;
+			size_t first{0};
+
+			mutable npas4::impl::ProcFile stat;
+			size_t statIndex{0};
+		};
+
+		///
+		/// Reads the current process's cgroup.  Returns false if the process is not in a memory controlled cgroup.  The cgroup's files are
+		/// opened the first time this is called and stay open for the life of the process.  Thread safe.
+		///
+		bool ReadCgroupSnapshot(npas4::CgroupReport& x);
+	} // namespace impl
+} // namespace npas4
+
+#endif
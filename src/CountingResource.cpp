@@ -0,0 +1,320 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/CountingResource.h>
+
+#include "ThreadIndex.h"
+
+#include <algorithm>
+#include <new>
+#include <sstream>
+
+namespace
+{
+	using npas4::CountingResource;
+
+	const int64_t MaxChunk{64 * 1024};
+
+	///
+	/// Shard indexes are claimed per thread, for every CountingResource at once: only the thread holding an index writes to any resource's
+	/// shard of that index.  The next thread to claim a released index carries on from the counts it left.
+	///
+	struct ShardTag : npas4::impl::ThreadIndexHooks
+	{
+	};
+
+	inline size_t GetShard()
+	{
+		return npas4::impl::ThreadIndex<ShardTag, CountingResource::ShardCount>::Get();
+	}
+
+	inline void Add(std::atomic<int64_t>& counter, int64_t x)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + x, std::memory_order_relaxed);
+	}
+
+	///
+	/// Small budgets are drawn on in smaller chunks, so that what other threads hold unused is at most an eighth of the budget.
+	///
+	int64_t GetChunk(int64_t budget)
+	{
+		if(budget <= 0)
+		{
+			return MaxChunk;
+		}
+
+		return std::min(MaxChunk, budget / static_cast<int64_t>(16 * CountingResource::ShardCount));
+	}
+
+	void UpdatePeak(std::atomic<int64_t>& peak, int64_t x)
+	{
+		auto highest = peak.load(std::memory_order_relaxed);
+
+		while(x > highest && peak.compare_exchange_weak(highest, x, std::memory_order_relaxed) == false)
+		{
+		}
+	}
+} // namespace
+
+npas4::CountingResourceReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Live Bytes:                        " << this->LiveBytes << std::endl;
+	ss << "Peak Bytes:                        " << this->PeakBytes << std::endl;
+	ss << "Allocated Bytes:                   " << this->AllocatedBytes << std::endl;
+	ss << "Allocations:                       " << this->Allocations << std::endl;
+	ss << "Deallocations:                     " << this->Deallocations << std::endl;
+	ss << "Fallback Live Bytes:               " << this->FallbackLiveBytes << std::endl;
+	ss << "Fallback Allocations:              " << this->FallbackAllocations << std::endl;
+	ss << "Refused:                           " << this->Refused << std::endl;
+
+	return ss.str();
+}
+
+npas4::CountingResourceReport npas4::CountingResourceReport::operator-(const CountingResourceReport& x)
+{
+	npas4::CountingResourceReport r;
+	r.LiveBytes = this->LiveBytes - x.LiveBytes;
+	r.PeakBytes = this->PeakBytes;
+	r.AllocatedBytes = this->AllocatedBytes - x.AllocatedBytes;
+	r.Allocations = this->Allocations - x.Allocations;
+	r.Deallocations = this->Deallocations - x.Deallocations;
+	r.FallbackLiveBytes = this->FallbackLiveBytes - x.FallbackLiveBytes;
+	r.FallbackAllocations = this->FallbackAllocations - x.FallbackAllocations;
+	r.Refused = this->Refused - x.Refused;
+
+	return r;
+}
+
+npas4::CountingResource::CountingResource(std::pmr::memory_resource* upstream, const npas4::CountingResourceOptions& x)
+	: upstream{upstream != nullptr ? upstream : std::pmr::get_default_resource()}, fallback{x.Fallback}
+{
+	this->SetBudget(x.Budget);
+}
+
+npas4::CountingResource::~CountingResource() = default;
+
+std::pmr::memory_resource* npas4::CountingResource::GetUpstream() const
+{
+	return this->upstream;
+}
+
+void npas4::CountingResource::SetBudget(int64_t x)
+{
+	this->budget.store(x, std::memory_order_relaxed);
+	this->chunk.store(GetChunk(x), std::memory_order_relaxed);
+}
+
+int64_t npas4::CountingResource::GetBudget() const
+{
+	return this->budget.load(std::memory_order_relaxed);
+}
+
+npas4::CountingResourceReport npas4::CountingResource::GetReport() const
+{
+	npas4::CountingResourceReport x;
+
+	for(const auto& shard : this->shards)
+	{
+		x.LiveBytes += shard.Live.load(std::memory_order_relaxed);
+		x.AllocatedBytes += shard.AllocatedBytes.load(std::memory_order_relaxed);
+		x.Allocations += shard.Allocations.load(std::memory_order_relaxed);
+		x.Deallocations += shard.Deallocations.load(std::memory_order_relaxed);
+	}
+
+	x.PeakBytes = std::max(x.LiveBytes, this->peak.load(std::memory_order_relaxed));
+	x.FallbackLiveBytes = this->fallbackLive.load(std::memory_order_relaxed);
+	x.FallbackAllocations = this->fallbackAllocations.load(std::memory_order_relaxed);
+	x.Refused = this->refused.load(std::memory_order_relaxed);
+	return x;
+}
+
+void* npas4::CountingResource::do_allocate(size_t bytes, size_t alignment)
+{
+	const auto index = GetShard();
+
+	if(index == ShardCount)
+	{
+		return this->allocateShared(bytes, alignment);
+	}
+
+	auto& shard = this->shards[index];
+	const auto size = static_cast<int64_t>(bytes);
+	const auto live = shard.Live.load(std::memory_order_relaxed) + size;
+
+	if(live > shard.Reserved.load(std::memory_order_relaxed) && this->reserve(shard, live) == false)
+	{
+		return this->allocateFallback(bytes, alignment);
+	}
+
+	// If this throws, the thread keeps the reservation for its next allocation.
+	auto x = this->upstream->allocate(bytes, alignment);
+
+	shard.Live.store(live, std::memory_order_relaxed);
+	Add(shard.AllocatedBytes, size);
+	Add(shard.Allocations, 1);
+	return x;
+}
+
+void npas4::CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+	if(this->fallbackCount.load(std::memory_order_acquire) != 0)
+	{
+		std::unique_lock<std::mutex> lock(this->fallbackLock);
+
+		if(this->fallbackBlocks.erase(p) != 0)
+		{
+			this->fallbackCount.fetch_sub(1, std::memory_order_relaxed);
+			this->fallbackLive.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+			lock.unlock();
+
+			this->fallback->deallocate(p, bytes, alignment);
+			return;
+		}
+	}
+
+	const auto index = GetShard();
+
+	if(index == ShardCount)
+	{
+		this->deallocateShared(p, bytes, alignment);
+		return;
+	}
+
+	this->upstream->deallocate(p, bytes, alignment);
+
+	auto& shard = this->shards[index];
+	const auto live = shard.Live.load(std::memory_order_relaxed) - static_cast<int64_t>(bytes);
+	shard.Live.store(live, std::memory_order_relaxed);
+	Add(shard.Deallocations, 1);
+
+	// Return all but one chunk of what the thread is not using.  (Live goes negative in a thread freeing what others allocated.)
+	const auto chunkSize = this->chunk.load(std::memory_order_relaxed);
+	const auto unused = shard.Reserved.load(std::memory_order_relaxed) - live;
+
+	if(unused > 2 * chunkSize)
+	{
+		Add(shard.Reserved, chunkSize - unused);
+		this->reserved.fetch_sub(unused - chunkSize, std::memory_order_relaxed);
+	}
+}
+
+bool npas4::CountingResource::do_is_equal(const std::pmr::memory_resource& x) const noexcept
+{
+	return this == &x;
+}
+
+bool npas4::CountingResource::reserve(Shard& shard, int64_t live)
+{
+	const auto limit = this->budget.load(std::memory_order_relaxed);
+	const auto needed = live - shard.Reserved.load(std::memory_order_relaxed);
+
+	// A chunk beyond what is needed, if the budget allows it, or else just what is needed.
+	auto amount = needed + this->chunk.load(std::memory_order_relaxed);
+	auto total = this->reserved.fetch_add(amount, std::memory_order_relaxed) + amount;
+
+	if(limit != 0 && total > limit)
+	{
+		this->reserved.fetch_sub(amount - needed, std::memory_order_relaxed);
+		total -= amount - needed;
+		amount = needed;
+
+		if(total > limit)
+		{
+			this->reserved.fetch_sub(amount, std::memory_order_relaxed);
+			this->refused.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+	}
+
+	Add(shard.Reserved, amount);
+
+	// Everything reserved, less what this thread has reserved but is not using.
+	UpdatePeak(this->peak, total - (shard.Reserved.load(std::memory_order_relaxed) - live));
+	return true;
+}
+
+void* npas4::CountingResource::allocateShared(size_t bytes, size_t alignment)
+{
+	auto& shard = this->shards[ShardCount];
+	const auto size = static_cast<int64_t>(bytes);
+	const auto limit = this->budget.load(std::memory_order_relaxed);
+	const auto total = this->reserved.fetch_add(size, std::memory_order_relaxed) + size;
+
+	if(limit != 0 && total > limit)
+	{
+		this->reserved.fetch_sub(size, std::memory_order_relaxed);
+		this->refused.fetch_add(1, std::memory_order_relaxed);
+		return this->allocateFallback(bytes, alignment);
+	}
+
+	void* x{nullptr};
+
+	try
+	{
+		x = this->upstream->allocate(bytes, alignment);
+	}
+	catch(...)
+	{
+		this->reserved.fetch_sub(size, std::memory_order_relaxed);
+		throw;
+	}
+
+	shard.Live.fetch_add(size, std::memory_order_relaxed);
+	shard.AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	shard.Allocations.fetch_add(1, std::memory_order_relaxed);
+	UpdatePeak(this->peak, total);
+	return x;
+}
+
+void npas4::CountingResource::deallocateShared(void* p, size_t bytes, size_t alignment)
+{
+	this->upstream->deallocate(p, bytes, alignment);
+
+	auto& shard = this->shards[ShardCount];
+	shard.Live.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+	shard.Deallocations.fetch_add(1, std::memory_order_relaxed);
+	this->reserved.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+void* npas4::CountingResource::allocateFallback(size_t bytes, size_t alignment)
+{
+	if(this->fallback == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	auto x = this->fallback->allocate(bytes, alignment);
+
+	try
+	{
+		std::lock_guard<std::mutex> lock(this->fallbackLock);
+		this->fallbackBlocks.insert(x);
+	}
+	catch(...)
+	{
+		this->fallback->deallocate(x, bytes, alignment);
+		throw;
+	}
+
+	this->fallbackCount.fetch_add(1, std::memory_order_release);
+	this->fallbackLive.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+	this->fallbackAllocations.fetch_add(1, std::memory_order_relaxed);
+	return x;
+}
@@ -0,0 +1,233 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Heap.h>
+
+#include "MallocInfo.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace
+{
+	const char* Find(const char* begin, const char* end, const char* x)
+	{
+		const auto found = std::search(begin, end, x, x + strlen(x));
+		return (found == end) ? nullptr : found;
+	}
+
+	///
+	/// Returns the integer value of 'name="..."' within [begin, end), or zero.
+	///
+	int64_t GetAttribute(const char* begin, const char* end, const char* name)
+	{
+		char key[32];
+		snprintf(key, sizeof(key), " %s=\"", name);
+
+		const auto found = Find(begin, end, key);
+
+		if(found == nullptr)
+		{
+			return 0;
+		}
+
+		return strtoll(found + strlen(key), nullptr, 10);
+	}
+
+	///
+	/// Finds the element '<tag type="x" .../>' within [begin, end) and returns the value of its attribute 'name', or zero.
+	///
+	int64_t GetTyped(const char* begin, const char* end, const char* tag, const char* type, const char* name)
+	{
+		char key[64];
+		snprintf(key, sizeof(key), "<%s type=\"%s\"", tag, type);
+
+		const auto found = Find(begin, end, key);
+
+		if(found == nullptr)
+		{
+			return 0;
+		}
+
+		const auto close = Find(found, end, "/>");
+		return GetAttribute(found, (close == nullptr) ? end : close, name);
+	}
+} // namespace
+
+double npas4::HeapReport::GetFragmentation() const
+{
+	if(this->Arena <= 0)
+	{
+		return 0.0;
+	}
+
+	return static_cast<double>(this->Free) / static_cast<double>(this->Arena);
+}
+
+npas4::HeapReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Heap Arena:                        " << this->Arena << std::endl;
+	ss << "Heap Mmap:                         " << this->Mmap << std::endl;
+	ss << "Heap Mmap Count:                   " << this->MmapCount << std::endl;
+	ss << "Heap In Use:                       " << this->InUse << std::endl;
+	ss << "Heap Free:                         " << this->Free << std::endl;
+	ss << "Heap Free Count:                   " << this->FreeCount << std::endl;
+	ss << "Heap Free Fast Bins:               " << this->FreeFastBins << std::endl;
+	ss << "Heap Top Releasable:               " << this->TopReleasable << std::endl;
+	ss << "Heap Fragmentation:                " << this->GetFragmentation() << std::endl;
+
+	return ss.str();
+}
+
+npas4::HeapReport npas4::HeapReport::operator-(const HeapReport& x)
+{
+	npas4::HeapReport r;
+	r.Arena = this->Arena - x.Arena;
+	r.Mmap = this->Mmap - x.Mmap;
+	r.MmapCount = this->MmapCount - x.MmapCount;
+	r.InUse = this->InUse - x.InUse;
+	r.Free = this->Free - x.Free;
+	r.FreeCount = this->FreeCount - x.FreeCount;
+	r.FreeFastBins = this->FreeFastBins - x.FreeFastBins;
+	r.TopReleasable = this->TopReleasable - x.TopReleasable;
+
+	return r;
+}
+
+double npas4::HeapArenaReport::GetFragmentation() const
+{
+	if(this->System <= 0)
+	{
+		return 0.0;
+	}
+
+	return static_cast<double>(this->Free) / static_cast<double>(this->System);
+}
+
+bool npas4::impl::ParseMallocInfo(const char* x, size_t size, std::vector<npas4::HeapArenaReport>& reports)
+{
+	const auto end = x + size;
+	auto current = x;
+	auto found = false;
+
+	while(true)
+	{
+		const auto begin = Find(current, end, "<heap nr=\"");
+
+		if(begin == nullptr)
+		{
+			break;
+		}
+
+		auto close = Find(begin, end, "</heap>");
+
+		if(close == nullptr)
+		{
+			close = end;
+		}
+
+		npas4::HeapArenaReport r;
+		r.Index = strtoll(begin + strlen("<heap nr=\""), nullptr, 10);
+		r.Free = GetTyped(begin, close, "total", "fast", "size") + GetTyped(begin, close, "total", "rest", "size");
+		r.FreeCount = GetTyped(begin, close, "total", "fast", "count") + GetTyped(begin, close, "total", "rest", "count");
+		r.System = GetTyped(begin, close, "system", "current", "size");
+		r.SystemMax = GetTyped(begin, close, "system", "max", "size");
+		r.AddressSpace = GetTyped(begin, close, "aspace", "total", "size");
+		reports.push_back(r);
+
+		found = true;
+		current = close;
+	}
+
+	return found;
+}
+
+npas4::HeapReport npas4::GetHeapReport()
+{
+	npas4::HeapReport r;
+
+#if defined(__GLIBC__)
+#ifdef NPAS4_HAVE_MALLINFO2
+	const auto x = mallinfo2();
+#else
+	const auto x = mallinfo();
+#endif
+
+	r.Arena = static_cast<int64_t>(x.arena);
+	r.Mmap = static_cast<int64_t>(x.hblkhd);
+	r.MmapCount = static_cast<int64_t>(x.hblks);
+	r.InUse = static_cast<int64_t>(x.uordblks);
+	r.Free = static_cast<int64_t>(x.fordblks);
+	r.FreeCount = static_cast<int64_t>(x.ordblks);
+	r.FreeFastBins = static_cast<int64_t>(x.fsmblks);
+	r.TopReleasable = static_cast<int64_t>(x.keepcost);
+#endif
+
+	return r;
+}
+
+std::vector<npas4::HeapArenaReport> npas4::GetHeapArenaReports()
+{
+	std::vector<npas4::HeapArenaReport> reports;
+
+#if defined(__GLIBC__)
+	char* buffer{nullptr};
+	size_t size{0};
+
+	auto stream = open_memstream(&buffer, &size);
+
+	if(stream == nullptr)
+	{
+		return reports;
+	}
+
+	const auto result = malloc_info(0, stream);
+	fclose(stream);
+
+	if(result == 0)
+	{
+		npas4::impl::ParseMallocInfo(buffer, size, reports);
+	}
+
+	free(buffer);
+#endif
+
+	return reports;
+}
+
+int64_t npas4::TrimHeap()
+{
+#if defined(__GLIBC__)
+	const auto before = npas4::GetRAMPhysicalUsedByCurrentProcess();
+	malloc_trim(0);
+	const auto after = npas4::GetRAMPhysicalUsedByCurrentProcess();
+
+	return std::max(before - after, int64_t(0));
+#else
+	return 0;
+#endif
+}
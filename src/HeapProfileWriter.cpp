@@ -0,0 +1,643 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// The pprof and folded stack writers, built into the npas4hooks library only.
+///
+/// A protobuf message's fields may be written in any order, and a repeated field's elements may be interleaved with other fields.  So the
+/// profile is written as it is visited: each string, function and location the first time a stack refers to it, then the stack's sample.
+///
+
+#include <npas4/HeapProfileWriter.h>
+
+#include <npas4/HeapProfiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <dlfcn.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+#ifdef NPAS4_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+	///
+	/// Buffers, optionally compresses, and writes to a file descriptor.
+	///
+	class Output
+	{
+	public:
+		Output(int fd, bool gzip) : fd{fd}, buffer(64 * 1024)
+		{
+#ifdef NPAS4_HAVE_ZLIB
+			if(gzip == true)
+			{
+				memset(&this->stream, 0, sizeof(this->stream));
+
+				// 15 + 16 selects a gzip header and trailer rather than zlib's.
+				this->gzip = (deflateInit2(&this->stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+				this->compressed.resize(this->buffer.size());
+			}
+#else
+			(void)gzip;
+#endif
+		}
+
+		~Output()
+		{
+#ifdef NPAS4_HAVE_ZLIB
+			if(this->gzip == true)
+			{
+				deflateEnd(&this->stream);
+			}
+#endif
+		}
+
+		void Write(const char* data, size_t size)
+		{
+			while(size > 0)
+			{
+				const auto n = std::min(size, this->buffer.size() - this->used);
+				memcpy(this->buffer.data() + this->used, data, n);
+				this->used += n;
+				data += n;
+				size -= n;
+
+				if(this->used == this->buffer.size())
+				{
+					this->Drain(false);
+				}
+			}
+		}
+
+		void Write(const std::string& x)
+		{
+			this->Write(x.data(), x.size());
+		}
+
+		///
+		/// Writes everything buffered (and, with gzip, the trailer).  Returns false if any write failed.
+		///
+		bool Finish()
+		{
+			this->Drain(true);
+			return this->failed == false;
+		}
+
+	private:
+		void Drain(bool finish)
+		{
+#ifdef NPAS4_HAVE_ZLIB
+			if(this->gzip == true)
+			{
+				this->stream.next_in = reinterpret_cast<Bytef*>(this->buffer.data());
+				this->stream.avail_in = static_cast<uInt>(this->used);
+
+				while(true)
+				{
+					this->stream.next_out = reinterpret_cast<Bytef*>(this->compressed.data());
+					this->stream.avail_out = static_cast<uInt>(this->compressed.size());
+
+					const auto result = deflate(&this->stream, (finish == true) ? Z_FINISH : Z_NO_FLUSH);
+					this->WriteFd(this->compressed.data(), this->compressed.size() - this->stream.avail_out);
+
+					if(result == Z_STREAM_ERROR)
+					{
+						this->failed = true;
+						break;
+					}
+
+					// Done once deflate() has room to spare: all input consumed, and (when finishing) the trailer written.
+					if(this->stream.avail_out != 0 && (finish == false || result == Z_STREAM_END))
+					{
+						break;
+					}
+				}
+
+				this->used = 0;
+				return;
+			}
+#else
+			(void)finish;
+#endif
+
+			this->WriteFd(this->buffer.data(), this->used);
+			this->used = 0;
+		}
+
+		void WriteFd(const char* data, size_t size)
+		{
+			while(size > 0 && this->failed == false)
+			{
+#ifdef WIN32
+				const auto n = _write(this->fd, data, static_cast<unsigned int>(size));
+#else
+				const auto n = write(this->fd, data, size);
+
+				if(n < 0 && errno == EINTR)
+				{
+					continue;
+				}
+#endif
+
+				if(n <= 0)
+				{
+					this->failed = true;
+					break;
+				}
+
+				data += n;
+				size -= static_cast<size_t>(n);
+			}
+		}
+
+		int fd{-1};
+		bool failed{false};
+		std::vector<char> buffer;
+		size_t used{0};
+
+#ifdef NPAS4_HAVE_ZLIB
+		bool gzip{false};
+		z_stream stream;
+		std::vector<char> compressed;
+#endif
+	};
+
+	///
+	/// A symbol's name (demangled where possible), its raw name, and its address.
+	///
+	struct Symbol
+	{
+		std::string Name;
+		std::string SystemName;
+		uintptr_t Address{0};
+	};
+
+	bool Symbolize(uintptr_t address, Symbol& x)
+	{
+#ifdef WIN32
+		(void)address;
+		(void)x;
+		return false;
+#else
+		Dl_info info;
+
+		if(dladdr(reinterpret_cast<void*>(address), &info) == 0 || info.dli_sname == nullptr)
+		{
+			return false;
+		}
+
+		x.SystemName = info.dli_sname;
+		x.Name = x.SystemName;
+		x.Address = reinterpret_cast<uintptr_t>(info.dli_saddr);
+
+#if defined(__GNUC__)
+		auto status = 0;
+		auto demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+
+		if(demangled != nullptr)
+		{
+			if(status == 0)
+			{
+				x.Name = demangled;
+			}
+
+			free(demangled);
+		}
+#endif
+
+		return true;
+#endif
+	}
+
+	///
+	/// Frames are return addresses; the call is in the instruction before.  (pprof and addr2line expect the address of the call.)
+	///
+	inline uintptr_t CallAddress(void* x)
+	{
+		return reinterpret_cast<uintptr_t>(x) - 1;
+	}
+
+	void AppendVarint(std::string& x, uint64_t value)
+	{
+		while(value >= 0x80)
+		{
+			x.push_back(static_cast<char>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+
+		x.push_back(static_cast<char>(value));
+	}
+
+	void AppendKey(std::string& x, int field, int wireType)
+	{
+		AppendVarint(x, (static_cast<uint64_t>(field) << 3) | static_cast<uint64_t>(wireType));
+	}
+
+	void AppendInt(std::string& x, int field, uint64_t value)
+	{
+		AppendKey(x, field, 0);
+		AppendVarint(x, value);
+	}
+
+	void AppendBytes(std::string& x, int field, const char* data, size_t size)
+	{
+		AppendKey(x, field, 2);
+		AppendVarint(x, size);
+		x.append(data, size);
+	}
+
+	void AppendBytes(std::string& x, int field, const std::string& value)
+	{
+		AppendBytes(x, field, value.data(), value.size());
+	}
+
+	struct Mapping
+	{
+		uint64_t Id{0};
+		uintptr_t Start{0};
+		uintptr_t Limit{0};
+		uint64_t Offset{0};
+		std::string File;
+	};
+
+	///
+	/// The executable, file backed mappings of /proc/self/maps, in address order.
+	///
+	std::vector<Mapping> ReadMappings()
+	{
+		std::vector<Mapping> mappings;
+
+#ifdef __linux__
+		auto file = fopen("/proc/self/maps", "r");
+
+		if(file == nullptr)
+		{
+			return mappings;
+		}
+
+		char line[4096];
+
+		while(fgets(line, sizeof(line), file) != nullptr)
+		{
+			unsigned long long start{0};
+			unsigned long long limit{0};
+			unsigned long long offset{0};
+			char permissions[8] = {};
+			auto path = 0;
+
+			if(sscanf(line, "%llx-%llx %7s %llx %*s %*s %n", &start, &limit, permissions, &offset, &path) < 4 || path <= 0)
+			{
+				continue;
+			}
+
+			if(strchr(permissions, 'x') == nullptr || line[path] != '/')
+			{
+				continue;
+			}
+
+			Mapping x;
+			x.Id = mappings.size() + 1;
+			x.Start = static_cast<uintptr_t>(start);
+			x.Limit = static_cast<uintptr_t>(limit);
+			x.Offset = static_cast<uint64_t>(offset);
+			x.File.assign(line + path, strcspn(line + path, "\n"));
+			mappings.push_back(x);
+		}
+
+		fclose(file);
+#endif
+
+		return mappings;
+	}
+
+	///
+	/// Writes profile.proto's Profile message.  Field numbers are from profile.proto.
+	///
+	class ProtoWriter
+	{
+	public:
+		ProtoWriter(Output& x, bool symbolize) : output(x), symbolize{symbolize}
+		{
+			// The string table must start with the empty string.
+			this->String("");
+		}
+
+		void WriteHeader()
+		{
+			const char* types[][2] = {{"alloc_objects", "count"}, {"alloc_space", "bytes"}, {"inuse_objects", "count"}, {"inuse_space", "bytes"}};
+
+			for(const auto& i : types)
+			{
+				this->WriteField(1, this->ValueType(i[0], i[1]));
+			}
+
+			this->mappings = ReadMappings();
+
+			for(const auto& i : this->mappings)
+			{
+				std::string x;
+				AppendInt(x, 1, i.Id);
+				AppendInt(x, 2, i.Start);
+				AppendInt(x, 3, i.Limit);
+				AppendInt(x, 4, i.Offset);
+				AppendInt(x, 5, this->String(i.File));
+				this->WriteField(3, x);
+			}
+		}
+
+		void WriteSample(const npas4::HeapProfileStack& x)
+		{
+			std::vector<uint64_t> locations(x.Depth);
+
+			for(size_t i = 0; i < x.Depth; ++i)
+			{
+				locations[i] = this->Location(CallAddress(x.Frames[i]));
+			}
+
+			std::string packed;
+
+			for(const auto i : locations)
+			{
+				AppendVarint(packed, i);
+			}
+
+			std::string sample;
+			AppendBytes(sample, 1, packed);
+
+			packed.clear();
+			AppendVarint(packed, static_cast<uint64_t>(x.AllocatedCount));
+			AppendVarint(packed, static_cast<uint64_t>(x.AllocatedBytes));
+			AppendVarint(packed, static_cast<uint64_t>(x.LiveCount));
+			AppendVarint(packed, static_cast<uint64_t>(x.LiveBytes));
+			AppendBytes(sample, 2, packed);
+
+			this->WriteField(2, sample);
+		}
+
+		void WriteFooter(int64_t interval)
+		{
+			// Hides the allocator hooks: drops operator new and everything it calls.
+			AppendInt(this->scratch, 7, this->String("operator new.*"));
+
+			const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+			AppendInt(this->scratch, 9, static_cast<uint64_t>(now.count()));
+
+			AppendBytes(this->scratch, 11, this->ValueType("space", "bytes"));
+			AppendInt(this->scratch, 12, static_cast<uint64_t>(interval));
+			AppendInt(this->scratch, 14, this->String("inuse_space"));
+
+			this->output.Write(this->scratch);
+			this->scratch.clear();
+		}
+
+	private:
+		void WriteField(int field, const std::string& message)
+		{
+			this->scratch.clear();
+			AppendBytes(this->scratch, field, message);
+			this->output.Write(this->scratch);
+			this->scratch.clear();
+		}
+
+		std::string ValueType(const char* type, const char* unit)
+		{
+			std::string x;
+			AppendInt(x, 1, this->String(type));
+			AppendInt(x, 2, this->String(unit));
+			return x;
+		}
+
+		///
+		/// Returns the string's index in the string table, writing it the first time.
+		///
+		uint64_t String(const std::string& x)
+		{
+			const auto found = this->strings.find(x);
+
+			if(found != std::end(this->strings))
+			{
+				return found->second;
+			}
+
+			const auto index = static_cast<uint64_t>(this->strings.size());
+			this->strings.emplace(x, index);
+
+			std::string field;
+			AppendBytes(field, 6, x);
+			this->output.Write(field);
+			return index;
+		}
+
+		uint64_t MappingId(uintptr_t address) const
+		{
+			const auto found = std::upper_bound(std::begin(this->mappings), std::end(this->mappings), address,
+												[](uintptr_t a, const Mapping& m) { return a < m.Start; });
+
+			if(found == std::begin(this->mappings) || address >= (found - 1)->Limit)
+			{
+				return 0;
+			}
+
+			return (found - 1)->Id;
+		}
+
+		uint64_t Function(const Symbol& x)
+		{
+			const auto found = this->functions.find(x.Address);
+
+			if(found != std::end(this->functions))
+			{
+				return found->second;
+			}
+
+			const auto id = static_cast<uint64_t>(this->functions.size() + 1);
+			this->functions.emplace(x.Address, id);
+
+			std::string function;
+			AppendInt(function, 1, id);
+			AppendInt(function, 2, this->String(x.Name));
+			AppendInt(function, 3, this->String(x.SystemName));
+			this->WriteField(5, function);
+			return id;
+		}
+
+		uint64_t Location(uintptr_t address)
+		{
+			const auto found = this->locations.find(address);
+
+			if(found != std::end(this->locations))
+			{
+				return found->second;
+			}
+
+			const auto id = static_cast<uint64_t>(this->locations.size() + 1);
+			this->locations.emplace(address, id);
+
+			std::string location;
+			AppendInt(location, 1, id);
+			AppendInt(location, 2, this->MappingId(address));
+			AppendInt(location, 3, address);
+
+			Symbol symbol;
+
+			if(this->symbolize == true && Symbolize(address, symbol) == true)
+			{
+				std::string line;
+				AppendInt(line, 1, this->Function(symbol));
+				AppendBytes(location, 4, line);
+			}
+
+			this->WriteField(4, location);
+			return id;
+		}
+
+		Output& output;
+		bool symbolize{true};
+		std::string scratch;
+		std::vector<Mapping> mappings;
+		std::unordered_map<std::string, uint64_t> strings;
+		std::unordered_map<uintptr_t, uint64_t> functions;
+		std::unordered_map<uintptr_t, uint64_t> locations;
+	};
+
+	int64_t GetValue(const npas4::HeapProfileStack& x, npas4::HeapProfileValue value)
+	{
+		switch(value)
+		{
+			case npas4::HeapProfileValue::InUseSpace:
+				return x.LiveBytes;
+			case npas4::HeapProfileValue::InUseObjects:
+				return x.LiveCount;
+			case npas4::HeapProfileValue::AllocSpace:
+				return x.AllocatedBytes;
+			case npas4::HeapProfileValue::AllocObjects:
+				return x.AllocatedCount;
+		}
+
+		return 0;
+	}
+} // namespace
+
+bool npas4::WriteHeapProfile(int fd, const npas4::HeapProfileWriteOptions& x)
+{
+	Output output(fd, x.Gzip);
+	ProtoWriter writer(output, x.Symbolize);
+
+	writer.WriteHeader();
+	npas4::VisitHeapProfile([&writer](const npas4::HeapProfileStack& stack) { writer.WriteSample(stack); });
+	writer.WriteFooter(npas4::GetHeapProfileReport().Interval);
+
+	return output.Finish();
+}
+
+bool npas4::WriteHeapProfileFolded(int fd, npas4::HeapProfileValue x)
+{
+	Output output(fd, false);
+	std::unordered_map<uintptr_t, std::string> names;
+	std::vector<const std::string*> frames;
+	std::string line;
+
+	npas4::VisitHeapProfile([&](const npas4::HeapProfileStack& stack) {
+		const auto value = GetValue(stack, x);
+
+		if(value <= 0)
+		{
+			return;
+		}
+
+		frames.clear();
+
+		for(size_t i = 0; i < stack.Depth; ++i)
+		{
+			const auto address = CallAddress(stack.Frames[i]);
+			auto found = names.find(address);
+
+			if(found == std::end(names))
+			{
+				Symbol symbol;
+				std::string name;
+
+				if(Symbolize(address, symbol) == true)
+				{
+					name = symbol.Name;
+
+					// ';' separates frames.
+					std::replace(std::begin(name), std::end(name), ';', ':');
+				}
+				else
+				{
+					char hex[32];
+					snprintf(hex, sizeof(hex), "0x%llx", static_cast<unsigned long long>(address));
+					name = hex;
+				}
+
+				found = names.emplace(address, name).first;
+			}
+
+			// Hides the allocator hooks: drops operator new and everything it calls.
+			if(found->second.compare(0, 12, "operator new") == 0)
+			{
+				frames.clear();
+				continue;
+			}
+
+			frames.push_back(&found->second);
+		}
+
+		line.clear();
+
+		for(auto i = frames.rbegin(); i != frames.rend(); ++i)
+		{
+			if(line.empty() == false)
+			{
+				line.push_back(';');
+			}
+
+			line.append(**i);
+		}
+
+		if(line.empty() == true)
+		{
+			line = "[unknown]";
+		}
+
+		line.push_back(' ');
+		line.append(std::to_string(value));
+		line.push_back('\n');
+		output.Write(line);
+	});
+
+	return output.Finish();
+}
@@ -0,0 +1,565 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// The sampling heap profiler, built into the npas4hooks library only.
+///
+/// Both tables are open addressed arrays, allocated with calloc() so that recording a sample never calls operator new, and never freed so
+/// that no thread can be left holding a pointer into them.  Entries are claimed with a compare and swap and are never moved.
+///
+
+#include <npas4/HeapProfiler.h>
+
+#include "AllocationHooks.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#if defined(__GLIBC__) || (defined(__APPLE__) && defined(__MACH__))
+#include <execinfo.h>
+#define NPAS4_HAVE_BACKTRACE
+#endif
+#endif
+
+std::atomic<bool> npas4::impl::HeapProfileRunning{false};
+std::atomic<int64_t> npas4::impl::HeapProfileLive{0};
+std::atomic<uint32_t> npas4::impl::HeapProfileFilter[npas4::impl::HeapProfileFilterSize];
+
+namespace
+{
+	const size_t MaxDepth{32};
+
+	///
+	/// How often a thread checks whether the profiler has been started.
+	///
+	const int64_t IdleCountdown{64 * 1024};
+
+	///
+	/// How far an insertion or lookup probes before giving up.
+	///
+	const size_t MaxProbe{64};
+
+	struct Stack
+	{
+		///
+		/// Zero while the entry is free.  Depth and Frames are written once, by the thread that claims the entry, before Ready is set.
+		///
+		std::atomic<uint64_t> Hash;
+		std::atomic<bool> Ready;
+		size_t Depth;
+		void* Frames[MaxDepth];
+
+		std::atomic<int64_t> AllocatedSamples;
+		std::atomic<int64_t> AllocatedSampleBytes;
+		std::atomic<int64_t> LiveSamples;
+		std::atomic<int64_t> LiveSampleBytes;
+	};
+
+	///
+	/// A sampled allocation that has not been freed.  Key is the allocation's address, zero for a never used entry, or Tombstone for a
+	/// freed one (so that lookups keep probing past it).
+	///
+	struct Live
+	{
+		std::atomic<uintptr_t> Key;
+		std::atomic<size_t> Stack;
+		std::atomic<int64_t> Size;
+	};
+
+	const uintptr_t Tombstone{1};
+
+	struct Profiler
+	{
+		std::mutex StartLock;
+		std::atomic<bool> FramePointers;
+		std::atomic<int64_t> Interval;
+
+		///
+		/// Published (with release) after the tables are allocated and their capacities set.
+		///
+		std::atomic<bool> Allocated;
+		Stack* Stacks;
+		size_t StackCapacity;
+		Live* Lives;
+		size_t LiveCapacity;
+
+		std::atomic<int64_t> Samples;
+		std::atomic<int64_t> Dropped;
+		std::atomic<int64_t> StackCount;
+	};
+
+	Profiler State;
+
+	///
+	/// Per thread state.  InSample stops a sample from being taken while one is being recorded (backtrace() may allocate the first time it is
+	/// called).
+	///
+	thread_local uint64_t Random{0};
+	thread_local bool InSample{false};
+
+	inline uint64_t Mix(uint64_t x)
+	{
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ULL;
+		x ^= x >> 33;
+		return x;
+	}
+
+	size_t RoundUpToPowerOfTwo(size_t x)
+	{
+		size_t r{1};
+
+		while(r < x)
+		{
+			r <<= 1;
+		}
+
+		return r;
+	}
+
+	///
+	/// An exponentially distributed number of bytes with the given mean, at least one.
+	///
+	int64_t NextInterval(int64_t mean)
+	{
+		if(Random == 0)
+		{
+			Random = Mix(reinterpret_cast<uintptr_t>(&Random) ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+			Random |= 1;
+		}
+
+		// xorshift64*
+		Random ^= Random >> 12;
+		Random ^= Random << 25;
+		Random ^= Random >> 27;
+		const auto r = Random * 0x2545f4914f6cdd1dULL;
+
+		// Uniform on (0, 1].
+		const auto u = static_cast<double>((r >> 11) + 1) * (1.0 / 9007199254740992.0);
+		const auto x = -std::log(u) * static_cast<double>(mean);
+
+		return (x < 1.0) ? 1 : static_cast<int64_t>(x);
+	}
+
+#ifdef NPAS4_HAVE_FRAME_POINTER_WALK
+	thread_local uintptr_t StackHigh{0};
+
+	uintptr_t GetStackHigh()
+	{
+		if(StackHigh == 0)
+		{
+#if defined(__APPLE__) && defined(__MACH__)
+			StackHigh = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(pthread_self()));
+#else
+			pthread_attr_t attr;
+
+			if(pthread_getattr_np(pthread_self(), &attr) == 0)
+			{
+				void* address{nullptr};
+				size_t size{0};
+
+				if(pthread_attr_getstack(&attr, &address, &size) == 0)
+				{
+					StackHigh = reinterpret_cast<uintptr_t>(address) + size;
+				}
+
+				pthread_attr_destroy(&attr);
+			}
+#endif
+		}
+
+		return StackHigh;
+	}
+
+	///
+	/// Follows the chain of saved frame pointers, checking that each lies on this thread's stack above the last, so that a function built
+	/// without frame pointers ends the walk rather than faulting.
+	///
+	__attribute__((noinline)) size_t WalkFramePointers(void** frames, size_t capacity)
+	{
+		const auto low = reinterpret_cast<uintptr_t>(&frames);
+		const auto high = GetStackHigh();
+
+		auto frame = reinterpret_cast<uintptr_t*>(__builtin_frame_address(0));
+		size_t depth{0};
+
+		while(depth < capacity)
+		{
+			const auto address = reinterpret_cast<uintptr_t>(frame);
+
+			if(address < low || address + 2 * sizeof(uintptr_t) > high || address % sizeof(uintptr_t) != 0)
+			{
+				break;
+			}
+
+			const auto ret = frame[1];
+
+			if(ret == 0)
+			{
+				break;
+			}
+
+			frames[depth++] = reinterpret_cast<void*>(ret);
+
+			const auto next = reinterpret_cast<uintptr_t*>(frame[0]);
+
+			if(reinterpret_cast<uintptr_t>(next) <= address)
+			{
+				break;
+			}
+
+			frame = next;
+		}
+
+		return depth;
+	}
+#endif
+
+	///
+	/// Captures the stack of SampleAllocation()'s caller.
+	///
+#ifndef WIN32
+	__attribute__((noinline))
+#endif
+	size_t CaptureStack(void** frames, size_t capacity)
+	{
+		void* buffer[MaxDepth + 2];
+
+#ifdef NPAS4_HAVE_FRAME_POINTER_WALK
+		if(State.FramePointers.load(std::memory_order_relaxed) == true)
+		{
+			// Skips the return address into CaptureStack().
+			const auto depth = WalkFramePointers(buffer, capacity + 1);
+
+			if(depth > 1)
+			{
+				memcpy(frames, buffer + 1, (depth - 1) * sizeof(void*));
+				return depth - 1;
+			}
+		}
+#endif
+
+		// Skips the return addresses into CaptureStack() and SampleAllocation().
+		size_t depth{0};
+
+#ifdef WIN32
+		depth = CaptureStackBackTrace(0, static_cast<DWORD>(capacity + 2), buffer, nullptr);
+#elif defined(NPAS4_HAVE_BACKTRACE)
+		depth = static_cast<size_t>(backtrace(buffer, static_cast<int>(capacity + 2)));
+#endif
+
+		if(depth <= 2)
+		{
+			return 0;
+		}
+
+		memcpy(frames, buffer + 2, (depth - 2) * sizeof(void*));
+		return depth - 2;
+	}
+
+	uint64_t HashStack(void* const* frames, size_t depth)
+	{
+		uint64_t h{depth};
+
+		for(size_t i = 0; i < depth; ++i)
+		{
+			h = Mix(h ^ reinterpret_cast<uintptr_t>(frames[i]));
+		}
+
+		return (h == 0) ? 1 : h;
+	}
+
+	///
+	/// Returns the index of the stack's entry, adding it if needed, or StackCapacity if the table has no room.
+	///
+	size_t FindOrAddStack(void* const* frames, size_t depth)
+	{
+		const auto hash = HashStack(frames, depth);
+		const auto mask = State.StackCapacity - 1;
+
+		for(size_t i = 0; i < MaxProbe; ++i)
+		{
+			const auto index = (hash + i) & mask;
+			auto& entry = State.Stacks[index];
+			auto current = entry.Hash.load(std::memory_order_acquire);
+
+			if(current == 0 && entry.Hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel) == true)
+			{
+				entry.Depth = depth;
+				memcpy(entry.Frames, frames, depth * sizeof(void*));
+				entry.Ready.store(true, std::memory_order_release);
+				State.StackCount.fetch_add(1, std::memory_order_relaxed);
+				return index;
+			}
+
+			// Equal hashes are taken to be equal stacks.  The counters can be updated before the claiming thread sets Ready.
+			if(current == hash)
+			{
+				return index;
+			}
+		}
+
+		return State.StackCapacity;
+	}
+
+	bool AddLive(uintptr_t x, size_t stack, int64_t size)
+	{
+		const auto mask = State.LiveCapacity - 1;
+		const auto hash = Mix(x);
+
+		for(size_t i = 0; i < MaxProbe; ++i)
+		{
+			auto& entry = State.Lives[(hash + i) & mask];
+			auto current = entry.Key.load(std::memory_order_relaxed);
+
+			if((current == 0 || current == Tombstone) && entry.Key.compare_exchange_strong(current, x, std::memory_order_acq_rel) == true)
+			{
+				entry.Stack.store(stack, std::memory_order_relaxed);
+				entry.Size.store(size, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	///
+	/// Scales sample counts up to an estimate for the whole program.  (The same correction as pprof's and Go's heap profiles.)
+	///
+	void Estimate(int64_t samples, int64_t bytes, int64_t interval, int64_t& count, int64_t& total)
+	{
+		if(samples <= 0 || bytes <= 0 || interval <= 0)
+		{
+			count = 0;
+			total = 0;
+			return;
+		}
+
+		const auto mean = static_cast<double>(bytes) / static_cast<double>(samples);
+		const auto scale = 1.0 / (1.0 - std::exp(-mean / static_cast<double>(interval)));
+
+		count = static_cast<int64_t>(static_cast<double>(samples) * scale + 0.5);
+		total = static_cast<int64_t>(static_cast<double>(bytes) * scale + 0.5);
+	}
+} // namespace
+
+int64_t npas4::impl::SampleAllocation(void* x, size_t size)
+{
+	if(npas4::impl::HeapProfileRunning.load(std::memory_order_relaxed) == false)
+	{
+		return IdleCountdown;
+	}
+
+	const auto interval = State.Interval.load(std::memory_order_relaxed);
+
+	if(x == nullptr || InSample == true || State.Allocated.load(std::memory_order_acquire) == false)
+	{
+		return NextInterval(interval);
+	}
+
+	InSample = true;
+
+	void* frames[MaxDepth];
+	const auto depth = CaptureStack(frames, MaxDepth);
+	const auto stack = FindOrAddStack(frames, depth);
+
+	State.Samples.fetch_add(1, std::memory_order_relaxed);
+
+	if(stack == State.StackCapacity)
+	{
+		State.Dropped.fetch_add(1, std::memory_order_relaxed);
+		InSample = false;
+		return NextInterval(interval);
+	}
+
+	auto& entry = State.Stacks[stack];
+	const auto bytes = static_cast<int64_t>(size);
+	entry.AllocatedSamples.fetch_add(1, std::memory_order_relaxed);
+	entry.AllocatedSampleBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+	const auto key = reinterpret_cast<uintptr_t>(x);
+
+	// The filter is raised before the entry exists, so operator delete can never miss it.
+	auto& filter = npas4::impl::GetHeapProfileFilter(x);
+	filter.fetch_add(1, std::memory_order_relaxed);
+	npas4::impl::HeapProfileLive.fetch_add(1, std::memory_order_relaxed);
+
+	if(AddLive(key, stack, bytes) == true)
+	{
+		entry.LiveSamples.fetch_add(1, std::memory_order_relaxed);
+		entry.LiveSampleBytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+	else
+	{
+		filter.fetch_sub(1, std::memory_order_relaxed);
+		npas4::impl::HeapProfileLive.fetch_sub(1, std::memory_order_relaxed);
+		State.Dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	InSample = false;
+	return NextInterval(interval);
+}
+
+void npas4::impl::SampleDeallocation(void* x)
+{
+	const auto key = reinterpret_cast<uintptr_t>(x);
+	auto& filter = npas4::impl::GetHeapProfileFilter(x);
+
+	const auto mask = State.LiveCapacity - 1;
+	const auto hash = Mix(key);
+
+	for(size_t i = 0; i < MaxProbe; ++i)
+	{
+		auto& entry = State.Lives[(hash + i) & mask];
+		const auto current = entry.Key.load(std::memory_order_acquire);
+
+		if(current == 0)
+		{
+			return;
+		}
+
+		if(current == key)
+		{
+			auto& stack = State.Stacks[entry.Stack.load(std::memory_order_relaxed)];
+			stack.LiveSamples.fetch_sub(1, std::memory_order_relaxed);
+			stack.LiveSampleBytes.fetch_sub(entry.Size.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+			entry.Key.store(Tombstone, std::memory_order_release);
+			filter.fetch_sub(1, std::memory_order_relaxed);
+			npas4::impl::HeapProfileLive.fetch_sub(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+}
+
+npas4::HeapProfileReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Heap Profile Interval:             " << this->Interval << std::endl;
+	ss << "Heap Profile Samples:              " << this->Samples << std::endl;
+	ss << "Heap Profile Dropped:              " << this->Dropped << std::endl;
+	ss << "Heap Profile Stacks:               " << this->Stacks << std::endl;
+	ss << "Heap Profile Live Samples:         " << this->LiveSamples << std::endl;
+
+	return ss.str();
+}
+
+bool npas4::StartHeapProfiler(const npas4::HeapProfilerOptions& x)
+{
+	if(x.Interval <= 0 || x.MaxStacks == 0 || x.MaxLive == 0)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(State.StartLock);
+
+	if(State.Allocated.load(std::memory_order_relaxed) == false)
+	{
+		const auto stackCapacity = RoundUpToPowerOfTwo(x.MaxStacks);
+		const auto liveCapacity = RoundUpToPowerOfTwo(x.MaxLive);
+
+		// Zeroed memory is a valid empty table: every atomic in Stack and Live is trivially constructible.
+		State.Stacks = static_cast<Stack*>(calloc(stackCapacity, sizeof(Stack)));
+		State.Lives = static_cast<Live*>(calloc(liveCapacity, sizeof(Live)));
+
+		if(State.Stacks == nullptr || State.Lives == nullptr)
+		{
+			free(State.Stacks);
+			free(State.Lives);
+			State.Stacks = nullptr;
+			State.Lives = nullptr;
+			return false;
+		}
+
+		State.StackCapacity = stackCapacity;
+		State.LiveCapacity = liveCapacity;
+		State.Allocated.store(true, std::memory_order_release);
+	}
+
+	State.Interval.store(x.Interval, std::memory_order_relaxed);
+	State.FramePointers.store(x.FramePointers, std::memory_order_relaxed);
+	npas4::impl::HeapProfileRunning.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+void npas4::StopHeapProfiler()
+{
+	npas4::impl::HeapProfileRunning.store(false, std::memory_order_relaxed);
+}
+
+bool npas4::IsHeapProfilerRunning()
+{
+	return npas4::impl::HeapProfileRunning.load(std::memory_order_relaxed);
+}
+
+npas4::HeapProfileReport npas4::GetHeapProfileReport()
+{
+	npas4::HeapProfileReport x;
+	x.Interval = State.Interval.load(std::memory_order_relaxed);
+	x.Samples = State.Samples.load(std::memory_order_relaxed);
+	x.Dropped = State.Dropped.load(std::memory_order_relaxed);
+	x.Stacks = State.StackCount.load(std::memory_order_relaxed);
+	x.LiveSamples = npas4::impl::HeapProfileLive.load(std::memory_order_relaxed);
+	return x;
+}
+
+size_t npas4::VisitHeapProfile(const std::function<void(const npas4::HeapProfileStack&)>& visitor)
+{
+	if(State.Allocated.load(std::memory_order_acquire) == false)
+	{
+		return 0;
+	}
+
+	const auto interval = State.Interval.load(std::memory_order_relaxed);
+	size_t visited{0};
+
+	for(size_t i = 0; i < State.StackCapacity; ++i)
+	{
+		const auto& entry = State.Stacks[i];
+
+		if(entry.Ready.load(std::memory_order_acquire) == false)
+		{
+			continue;
+		}
+
+		npas4::HeapProfileStack x;
+		x.Frames = entry.Frames;
+		x.Depth = entry.Depth;
+		x.AllocatedSamples = entry.AllocatedSamples.load(std::memory_order_relaxed);
+		x.AllocatedSampleBytes = entry.AllocatedSampleBytes.load(std::memory_order_relaxed);
+		x.LiveSamples = entry.LiveSamples.load(std::memory_order_relaxed);
+		x.LiveSampleBytes = entry.LiveSampleBytes.load(std::memory_order_relaxed);
+
+		Estimate(x.AllocatedSamples, x.AllocatedSampleBytes, interval, x.AllocatedCount, x.AllocatedBytes);
+		Estimate(x.LiveSamples, x.LiveSampleBytes, interval, x.LiveCount, x.LiveBytes);
+
+		visitor(x);
+		++visited;
+	}
+
+	return visited;
+}
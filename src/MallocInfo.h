@@ -0,0 +1,39 @@
+#ifndef H_NPAS4_MALLOCINFO_H
+#define H_NPAS4_MALLOCINFO_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Heap.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// Parses the XML written by glibc's malloc_info(), appending one report per <heap> element.  Only the handful of elements used by
+		/// HeapArenaReport are recognized; this is not a general XML parser.  Returns false if no <heap> element was found.
+		///
+		bool ParseMallocInfo(const char* x, size_t size, std::vector<npas4::HeapArenaReport>& reports);
+	} // namespace impl
+} // namespace npas4
+
+#endif
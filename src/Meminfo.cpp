@@ -0,0 +1,69 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Meminfo.h>
+
+#include "Snapshot.h"
+
+#include <sstream>
+
+npas4::MeminfoReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "MemTotal:                          " << this->MemTotal << std::endl;
+	ss << "MemFree:                           " << this->MemFree << std::endl;
+	ss << "MemAvailable:                      " << this->MemAvailable << std::endl;
+	ss << "Buffers:                           " << this->Buffers << std::endl;
+	ss << "Cached:                            " << this->Cached << std::endl;
+	ss << "SwapCached:                        " << this->SwapCached << std::endl;
+	ss << "SReclaimable:                      " << this->SReclaimable << std::endl;
+	ss << "Shmem:                             " << this->Shmem << std::endl;
+	ss << "Dirty:                             " << this->Dirty << std::endl;
+	ss << "Writeback:                         " << this->Writeback << std::endl;
+	ss << "SwapTotal:                         " << this->SwapTotal << std::endl;
+	ss << "SwapFree:                          " << this->SwapFree << std::endl;
+
+	return ss.str();
+}
+
+npas4::MeminfoReport npas4::MeminfoReport::operator-(const MeminfoReport& x)
+{
+	npas4::MeminfoReport r;
+	r.MemTotal = this->MemTotal - x.MemTotal;
+	r.MemFree = this->MemFree - x.MemFree;
+	r.MemAvailable = this->MemAvailable - x.MemAvailable;
+	r.Buffers = this->Buffers - x.Buffers;
+	r.Cached = this->Cached - x.Cached;
+	r.SwapCached = this->SwapCached - x.SwapCached;
+	r.SReclaimable = this->SReclaimable - x.SReclaimable;
+	r.Shmem = this->Shmem - x.Shmem;
+	r.Dirty = this->Dirty - x.Dirty;
+	r.Writeback = this->Writeback - x.Writeback;
+	r.SwapTotal = this->SwapTotal - x.SwapTotal;
+	r.SwapFree = this->SwapFree - x.SwapFree;
+
+	return r;
+}
+
+npas4::MeminfoReport npas4::GetMeminfoReport()
+{
+	npas4::MeminfoReport x;
+	npas4::impl::ReadMeminfo(x);
+	return x;
+}
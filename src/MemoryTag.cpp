@@ -0,0 +1,206 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Memory tag registration and reports, built into the npas4tags library only.  The counting is done by operator new and delete in
+/// Allocations.cpp.
+///
+
+#include <npas4/MemoryTag.h>
+
+#include "AllocationHooks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+npas4::impl::TagCounters npas4::impl::TagShards[npas4::impl::SlotCount + 1][npas4::impl::MaxMemoryTags];
+std::atomic<int64_t> npas4::impl::TagLive[npas4::impl::MaxMemoryTags];
+std::atomic<int64_t> npas4::impl::TagPeak[npas4::impl::MaxMemoryTags];
+std::atomic<int64_t> npas4::impl::TagBudget[npas4::impl::MaxMemoryTags];
+std::atomic<bool> npas4::impl::TagOverBudget[npas4::impl::MaxMemoryTags];
+std::atomic<int64_t> npas4::impl::TagBudgetExceeded[npas4::impl::MaxMemoryTags];
+
+namespace
+{
+	using npas4::impl::MaxMemoryTags;
+
+	const size_t MaxNameLength{64};
+
+	///
+	/// Names are written once, under RegisterLock, before Count is raised past them.
+	///
+	std::mutex RegisterLock;
+	char Names[MaxMemoryTags][MaxNameLength] = {"untagged"};
+	std::atomic<size_t> Count{1};
+
+	int Find(const char* name, size_t count)
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			if(strncmp(Names[i], name, MaxNameLength - 1) == 0)
+			{
+				return static_cast<int>(i);
+			}
+		}
+
+		return -1;
+	}
+} // namespace
+
+int npas4::RegisterMemoryTag(const char* name)
+{
+	if(name == nullptr)
+	{
+		return 0;
+	}
+
+	auto found = Find(name, Count.load(std::memory_order_acquire));
+
+	if(found >= 0)
+	{
+		return found;
+	}
+
+	std::lock_guard<std::mutex> lock(RegisterLock);
+
+	const auto count = Count.load(std::memory_order_relaxed);
+	found = Find(name, count);
+
+	if(found >= 0)
+	{
+		return found;
+	}
+
+	if(count == MaxMemoryTags)
+	{
+		return 0;
+	}
+
+	strncpy(Names[count], name, MaxNameLength - 1);
+	Count.store(count + 1, std::memory_order_release);
+	return static_cast<int>(count);
+}
+
+void npas4::SetMemoryTagBudget(int id, int64_t bytes)
+{
+	if(id < 0 || static_cast<size_t>(id) >= Count.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	const auto tag = static_cast<uint32_t>(id);
+	npas4::impl::TagBudget[tag].store((bytes > 0) ? bytes : 0, std::memory_order_relaxed);
+	npas4::impl::CheckMemoryTagBudget(tag, npas4::impl::TagLive[tag].load(std::memory_order_relaxed));
+}
+
+int64_t npas4::GetMemoryTagBudget(int id)
+{
+	if(id < 0 || static_cast<size_t>(id) >= MaxMemoryTags)
+	{
+		return 0;
+	}
+
+	return npas4::impl::TagBudget[id].load(std::memory_order_relaxed);
+}
+
+bool npas4::IsMemoryTagOverBudget(int id)
+{
+	if(id < 0 || static_cast<size_t>(id) >= MaxMemoryTags)
+	{
+		return false;
+	}
+
+	return npas4::impl::TagOverBudget[id].load(std::memory_order_relaxed);
+}
+
+npas4::MemoryTag::MemoryTag(const char* name) : MemoryTag(npas4::RegisterMemoryTag(name))
+{
+}
+
+npas4::MemoryTag::MemoryTag(int id)
+{
+	const auto valid = (id > 0 && static_cast<size_t>(id) < Count.load(std::memory_order_acquire));
+	npas4::impl::PushMemoryTag(valid == true ? static_cast<uint32_t>(id) : 0);
+}
+
+npas4::MemoryTag::~MemoryTag()
+{
+	npas4::impl::PopMemoryTag();
+}
+
+int npas4::MemoryTag::GetCurrent()
+{
+	return static_cast<int>(npas4::impl::GetMemoryTag());
+}
+
+npas4::MemoryTagReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Tag:                               " << this->Name << std::endl;
+	ss << "Live Bytes:                        " << this->LiveBytes << std::endl;
+	ss << "Peak Bytes:                        " << this->PeakBytes << std::endl;
+	ss << "Allocated Bytes:                   " << this->AllocatedBytes << std::endl;
+	ss << "Allocations:                       " << this->Allocations << std::endl;
+	ss << "Deallocations:                     " << this->Deallocations << std::endl;
+	ss << "Budget:                            " << this->Budget << std::endl;
+	ss << "Over Budget:                       " << this->OverBudget << std::endl;
+	ss << "Budget Exceeded:                   " << this->BudgetExceeded << std::endl;
+
+	return ss.str();
+}
+
+std::vector<npas4::MemoryTagReport> npas4::GetMemoryTagReports(size_t top)
+{
+	const auto count = Count.load(std::memory_order_acquire);
+
+	std::vector<npas4::MemoryTagReport> reports(count);
+
+	for(size_t tag = 0; tag < count; ++tag)
+	{
+		auto& x = reports[tag];
+		x.Name = Names[tag];
+		x.Id = static_cast<int>(tag);
+
+		int64_t freed{0};
+
+		for(const auto& shard : npas4::impl::TagShards)
+		{
+			x.AllocatedBytes += shard[tag].AllocatedBytes.load(std::memory_order_relaxed);
+			x.Allocations += shard[tag].Allocations.load(std::memory_order_relaxed);
+			x.Deallocations += shard[tag].Deallocations.load(std::memory_order_relaxed);
+			freed += shard[tag].FreedBytes.load(std::memory_order_relaxed);
+		}
+
+		x.LiveBytes = x.AllocatedBytes - freed;
+		x.PeakBytes = std::max(x.LiveBytes, npas4::impl::TagPeak[tag].load(std::memory_order_relaxed));
+		x.Budget = npas4::impl::TagBudget[tag].load(std::memory_order_relaxed);
+		x.OverBudget = npas4::impl::TagOverBudget[tag].load(std::memory_order_relaxed);
+		x.BudgetExceeded = npas4::impl::TagBudgetExceeded[tag].load(std::memory_order_relaxed);
+	}
+
+	std::stable_sort(std::begin(reports), std::end(reports),
+					 [](const npas4::MemoryTagReport& a, const npas4::MemoryTagReport& b) { return a.LiveBytes > b.LiveBytes; });
+
+	if(top != 0 && reports.size() > top)
+	{
+		reports.resize(top);
+	}
+
+	return reports;
+}
@@ -17,21 +17,11 @@
 ///
 
 #include <npas4/Npas4.h>
+#include <atomic>
 #include <sstream>
 
-#ifdef WIN32
-#include <Psapi.h>
-#include <Windows.h>
-#else
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <sys/resource.h>
-#include <sys/sysinfo.h>
-#include <sys/time.h>
-#include <sys/types.h>
-#include <unistd.h>
-#endif
+#include "CgroupFiles.h"
+#include "Snapshot.h"
 
 ///
 /// References:
@@ -43,30 +33,45 @@
 /// https://stackoverflow.com/questions/669438/how-to-get-memory-usage-at-run-time-in-c
 /// https://stackoverflow.com/questions/2513505/how-to-get-available-memory-c-g
 ///
+/// Every function below is a view over a single snapshot query (see Snapshot.h), so each one costs exactly one system or process query and
+/// GetRAMReport() costs exactly one system, one process, and one cgroup query.  The smaps query walks the page tables, so only the functions
+/// that return PSS or USS issue it.
+///
 
-constexpr int64_t Kilobytes2Bytes{1024};
-
-#ifdef WIN32
-#else
 namespace npas4
 {
 	namespace impl
 	{
-		int ParseLine(char* line)
+		std::atomic<npas4::ProcessQueryMode> ProcessQueryModeSetting{npas4::ProcessQueryMode::Status};
+
+		///
+		/// In LowLatency mode, reads /proc/self/statm.  Returns false if the caller should fall back to the process snapshot.
+		///
+		bool ReadLowLatency(npas4::impl::StatmFields& x)
+		{
+			return ProcessQueryModeSetting.load(std::memory_order_relaxed) == npas4::ProcessQueryMode::LowLatency && npas4::impl::ReadStatm(x);
+		}
+
+		bool ReadLowLatency(int64_t pid, npas4::impl::StatmFields& x)
 		{
-			const auto i = strlen(line);
+			return ProcessQueryModeSetting.load(std::memory_order_relaxed) == npas4::ProcessQueryMode::LowLatency && npas4::impl::ReadStatm(pid, x);
+		}
 
-			while(*line < '0' || *line > '9')
-			{
-				line++;
-			}
+		///
+		/// Reads the system and cgroup snapshots and fills the cgroup fields of a report.
+		///
+		npas4::RAMReport ReadCgroupReport()
+		{
+			npas4::impl::Snapshot x;
+			npas4::impl::ReadSystemSnapshot(x.System);
+			npas4::impl::ReadCgroupSnapshot(x.Cgroup);
 
-			line[i - 3] = '\0';
-			return atoi(line);
+			npas4::RAMReport r;
+			npas4::impl::FillReport(x, r);
+			return r;
 		}
 	} // namespace impl
 } // namespace npas4
-#endif
 
 npas4::RAMReport::operator std::string()
 {
@@ -85,6 +90,11 @@ npas4::RAMReport::operator std::string()
 	ss << "Virtual Available:                 " << this->RamVirtualAvailable << std::endl;
 	ss << "Virtual Used:                      " << this->RamVirtualUsed << std::endl;
 	ss << "Virtual UsedByCurrentProcess:      " << this->RamVirtualUsedByCurrentProcess << std::endl;
+	ss << "Cgroup Total:                      " << this->RamCgroupTotal << std::endl;
+	ss << "Cgroup Available:                  " << this->RamCgroupAvailable << std::endl;
+	ss << "Cgroup Used:                       " << this->RamCgroupUsed << std::endl;
+	ss << "Proportional UsedByCurrentProcess: " << this->RamProportionalUsedByCurrentProcess << std::endl;
+	ss << "Unique UsedByCurrentProcess:       " << this->RamUniqueUsedByCurrentProcess << std::endl;
 
 	return ss.str();
 }
@@ -105,246 +115,362 @@ npas4::RAMReport npas4::RAMReport::operator-(const RAMReport& x)
 	r.RamVirtualAvailable = this->RamVirtualAvailable - x.RamVirtualAvailable;
 	r.RamVirtualUsed = this->RamVirtualUsed - x.RamVirtualUsed;
 	r.RamVirtualUsedByCurrentProcess = this->RamVirtualUsedByCurrentProcess - x.RamVirtualUsedByCurrentProcess;
+	r.RamCgroupTotal = this->RamCgroupTotal - x.RamCgroupTotal;
+	r.RamCgroupAvailable = this->RamCgroupAvailable - x.RamCgroupAvailable;
+	r.RamCgroupUsed = this->RamCgroupUsed - x.RamCgroupUsed;
+	r.RamProportionalUsedByCurrentProcess = this->RamProportionalUsedByCurrentProcess - x.RamProportionalUsedByCurrentProcess;
+	r.RamUniqueUsedByCurrentProcess = this->RamUniqueUsedByCurrentProcess - x.RamUniqueUsedByCurrentProcess;
+
+	return r;
+}
+
+npas4::ExtendedReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Physical UsedByCurrentProcess:     " << this->RamPhysicalUsedByCurrentProcess << std::endl;
+	ss << "Virtual UsedByCurrentProcess:      " << this->RamVirtualUsedByCurrentProcess << std::endl;
+	ss << "Shared ByCurrentProcess:           " << this->RamSharedByCurrentProcess << std::endl;
+	ss << "Text ByCurrentProcess:             " << this->RamTextByCurrentProcess << std::endl;
+	ss << "Data ByCurrentProcess:             " << this->RamDataByCurrentProcess << std::endl;
+	ss << "Proportional UsedByCurrentProcess: " << this->RamProportionalUsedByCurrentProcess << std::endl;
+	ss << "Unique UsedByCurrentProcess:       " << this->RamUniqueUsedByCurrentProcess << std::endl;
+	ss << "Swap ByCurrentProcess:             " << this->RamSwapByCurrentProcess << std::endl;
+	ss << "SwapProportional ByCurrentProcess: " << this->RamSwapProportionalByCurrentProcess << std::endl;
+	ss << "Anonymous ByCurrentProcess:        " << this->RamAnonymousByCurrentProcess << std::endl;
+	ss << "AnonHugePages ByCurrentProcess:    " << this->RamAnonHugePagesByCurrentProcess << std::endl;
+	ss << "Locked ByCurrentProcess:           " << this->RamLockedByCurrentProcess << std::endl;
+
+	return ss.str();
+}
+
+npas4::ExtendedReport npas4::ExtendedReport::operator-(const ExtendedReport& x)
+{
+	npas4::ExtendedReport r;
+	r.RamPhysicalUsedByCurrentProcess = this->RamPhysicalUsedByCurrentProcess - x.RamPhysicalUsedByCurrentProcess;
+	r.RamVirtualUsedByCurrentProcess = this->RamVirtualUsedByCurrentProcess - x.RamVirtualUsedByCurrentProcess;
+	r.RamSharedByCurrentProcess = this->RamSharedByCurrentProcess - x.RamSharedByCurrentProcess;
+	r.RamTextByCurrentProcess = this->RamTextByCurrentProcess - x.RamTextByCurrentProcess;
+	r.RamDataByCurrentProcess = this->RamDataByCurrentProcess - x.RamDataByCurrentProcess;
+	r.RamProportionalUsedByCurrentProcess = this->RamProportionalUsedByCurrentProcess - x.RamProportionalUsedByCurrentProcess;
+	r.RamUniqueUsedByCurrentProcess = this->RamUniqueUsedByCurrentProcess - x.RamUniqueUsedByCurrentProcess;
+	r.RamSwapByCurrentProcess = this->RamSwapByCurrentProcess - x.RamSwapByCurrentProcess;
+	r.RamSwapProportionalByCurrentProcess = this->RamSwapProportionalByCurrentProcess - x.RamSwapProportionalByCurrentProcess;
+	r.RamAnonymousByCurrentProcess = this->RamAnonymousByCurrentProcess - x.RamAnonymousByCurrentProcess;
+	r.RamAnonHugePagesByCurrentProcess = this->RamAnonHugePagesByCurrentProcess - x.RamAnonHugePagesByCurrentProcess;
+	r.RamLockedByCurrentProcess = this->RamLockedByCurrentProcess - x.RamLockedByCurrentProcess;
 
 	return r;
 }
 
+void npas4::SetProcessQueryMode(npas4::ProcessQueryMode x)
+{
+	npas4::impl::ProcessQueryModeSetting.store(x, std::memory_order_relaxed);
+}
+
+npas4::ProcessQueryMode npas4::GetProcessQueryMode()
+{
+	return npas4::impl::ProcessQueryModeSetting.load(std::memory_order_relaxed);
+}
+
 int64_t npas4::GetRAMSystemTotal()
 {
-#ifdef WIN32
-	MEMORYSTATUSEX memInfo;
-	memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&memInfo);
-	return static_cast<int64_t>(memInfo.ullTotalPhys) + static_cast<int64_t>(memInfo.ullTotalVirtual);
-#else
-	// Prefer sysctl() over sysconf() except sysctl() HW_REALMEM and HW_PHYSMEM
-	// return static_cast<int64_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<int64_t>(sysconf(_SC_PAGE_SIZE));
-	struct sysinfo memInfo;
-	sysinfo(&memInfo);
-	int64_t total = memInfo.totalram;
-	total += memInfo.totalswap;
-	total += memInfo.totalhigh;
-	return total * static_cast<int64_t>(memInfo.mem_unit);
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.SystemTotal;
 }
 
 int64_t npas4::GetRAMSystemAvailable()
 {
-#ifdef WIN32
-	MEMORYSTATUSEX memInfo;
-	memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&memInfo);
-	return static_cast<int64_t>(memInfo.ullAvailPhys) + static_cast<int64_t>(memInfo.ullAvailVirtual);
-#else
-	return npas4::GetRAMSystemTotal() - npas4::GetRAMSystemUsed();
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.SystemAvailable;
 }
 
 int64_t npas4::GetRAMSystemUsed()
 {
-#ifdef WIN32
-	return npas4::GetRAMSystemTotal() - npas4::GetRAMSystemAvailable();
-#else
-	struct sysinfo memInfo;
-	sysinfo(&memInfo);
-	int64_t total = memInfo.totalram - memInfo.freeram;
-	total += memInfo.totalswap - memInfo.freeswap;
-	total += memInfo.totalhigh - memInfo.freehigh;
-	return total * static_cast<int64_t>(memInfo.mem_unit);
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.SystemTotal - x.SystemAvailable;
 }
 
 int64_t npas4::GetRAMSystemUsedByCurrentProcess()
 {
-#ifdef WIN32
-	PROCESS_MEMORY_COUNTERS_EX pmc;
-	GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc));
-	return static_cast<int64_t>(pmc.WorkingSetSize);
-#elif defined(__APPLE__) && defined(__MACH__)
-	mach_task_basic_info info;
-	mach_msg_type_number_t infoCount = MACH_TASK_BASIC_INFO_COUNT;
+	npas4::impl::StatmFields statm;
 
-	if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &infoCount) == KERN_SUCCESS)
+	if(npas4::impl::ReadLowLatency(statm) == true)
 	{
-		return static_cast<int64_t>(info.resident_size);
+		return statm.Resident + statm.Size;
 	}
 
-	return int64_t(-1);
-#else
-	return npas4::GetRAMPhysicalUsedByCurrentProcess() + npas4::GetRAMVirtualUsedByCurrentProcess();
-#endif
+	npas4::impl::ProcessSnapshot x;
+	npas4::impl::ReadProcessSnapshot(x);
+	return npas4::impl::SystemUsedByCurrentProcess(x);
 }
 
 int64_t npas4::GetRAMPhysicalTotal()
 {
-#ifdef WIN32
-	MEMORYSTATUSEX memInfo;
-	memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&memInfo);
-	return static_cast<int64_t>(memInfo.ullTotalPhys);
-#else
-	struct sysinfo memInfo;
-	sysinfo(&memInfo);
-	return memInfo.totalram * memInfo.mem_unit;
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.PhysicalTotal;
 }
 
 int64_t npas4::GetRAMPhysicalAvailable()
 {
-#ifdef WIN32
-	MEMORYSTATUSEX memInfo;
-	memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&memInfo);
-	return static_cast<int64_t>(memInfo.ullAvailPhys);
-#else
-	return npas4::GetRAMPhysicalTotal() - npas4::GetRAMPhysicalUsed();
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.PhysicalAvailable;
 }
 
 int64_t npas4::GetRAMPhysicalUsed()
 {
-#ifdef WIN32
-	return npas4::GetRAMPhysicalTotal() - npas4::GetRAMPhysicalAvailable();
-#else
-	struct sysinfo memInfo;
-	sysinfo(&memInfo);
-	return  (static_cast<int64_t>(memInfo.totalram) - static_cast<int64_t>(memInfo.freeram)) * static_cast<int64_t>(memInfo.mem_unit);
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.PhysicalTotal - x.PhysicalAvailable;
 }
 
 int64_t npas4::GetRAMPhysicalUsedByCurrentProcess()
 {
-#ifdef WIN32
-	PROCESS_MEMORY_COUNTERS_EX pmc;
-	GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc));
-	return static_cast<int64_t>(pmc.WorkingSetSize);
-#else
-	constexpr int BufferSize{128};
-	int64_t result = 0;
-	auto file = fopen("/proc/self/status", "r");
-	char line[BufferSize];
-
-	while(fgets(line, BufferSize, file) != nullptr)
+	npas4::impl::StatmFields statm;
+
+	if(npas4::impl::ReadLowLatency(statm) == true)
 	{
-		if(strncmp(line, "VmRSS:", 6) == 0)
-		{
-			result += npas4::impl::ParseLine(line) * Kilobytes2Bytes;
-		}
+		return statm.Resident;
 	}
 
-	fclose(file);
-	return static_cast<int64_t>(result);
-#endif
+	npas4::impl::ProcessSnapshot x;
+	npas4::impl::ReadProcessSnapshot(x);
+	return x.Physical;
 }
 
 int64_t npas4::GetRAMPhysicalUsedByCurrentProcessPeak()
 {
-#if defined(_WIN32)
-	PROCESS_MEMORY_COUNTERS pmc;
-	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
-	return static_cast<int64_t>(pmc.PeakWorkingSetSize);
-#elif defined(__APPLE__) && defined(__MACH__)
-	struct rusage rusage;
-	getrusage(RUSAGE_SELF, &rusage);
-	return static_cast<int64_t>(rusage.ru_maxrss);
-#else
-	constexpr int BufferSize{128};
-	int64_t result = 0;
-	auto file = fopen("/proc/self/status", "r");
-	char line[BufferSize];
-
-	while(fgets(line, BufferSize, file) != nullptr)
-	{
-		if(strncmp(line, "VmHWM:", 6) == 0)
-		{
-			result += npas4::impl::ParseLine(line) * Kilobytes2Bytes;
-		}
-	}
-
-	fclose(file);
-	return static_cast<int64_t>(result);
-#endif
+	npas4::impl::ProcessSnapshot x;
+	npas4::impl::ReadProcessSnapshot(x);
+	return x.PhysicalPeak;
 }
 
 int64_t npas4::GetRAMVirtualTotal()
 {
-#ifdef WIN32
-	MEMORYSTATUSEX memInfo;
-	memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&memInfo);
-	return memInfo.ullTotalPageFile;
-#else
-	struct sysinfo memInfo;
-	sysinfo(&memInfo);
-	return static_cast<int64_t>(memInfo.totalswap) * static_cast<int64_t>(memInfo.mem_unit);
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.VirtualTotal;
 }
 
 int64_t npas4::GetRAMVirtualAvailable()
 {
-#ifdef WIN32
-	MEMORYSTATUSEX memInfo;
-	memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&memInfo);
-	return memInfo.ullTotalPageFile;
-#else
-	return npas4::GetRAMVirtualTotal() - npas4::GetRAMVirtualUsed();
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.VirtualAvailable;
 }
 
 int64_t npas4::GetRAMVirtualUsed()
 {
-#ifdef WIN32
-	return npas4::GetRAMVirtualTotal() - npas4::GetRAMVirtualAvailable();
-#else
-	struct sysinfo memInfo;
-	sysinfo(&memInfo);
-	const int64_t total = memInfo.totalswap - memInfo.freeswap;
-	return total * static_cast<int64_t>(memInfo.mem_unit);
-#endif
+	npas4::impl::SystemSnapshot x;
+	npas4::impl::ReadSystemSnapshot(x);
+	return x.VirtualTotal - x.VirtualAvailable;
 }
 
 int64_t npas4::GetRAMVirtualUsedByCurrentProcess()
 {
-#ifdef WIN32
-	PROCESS_MEMORY_COUNTERS_EX pmc;
-	GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc));
-	return pmc.PrivateUsage;
-#else
-	// Verified Correct.
-	constexpr int BufferSize{128};
-	int64_t result = 0;
-	FILE* file = fopen("/proc/self/status", "r");
-	char line[BufferSize];
-
-	while(fgets(line, BufferSize, file) != NULL)
+	npas4::impl::StatmFields statm;
+
+	if(npas4::impl::ReadLowLatency(statm) == true)
 	{
-		if(strncmp(line, "VmSize:", 7) == 0)
-		{
-			result = npas4::impl::ParseLine(line) * Kilobytes2Bytes;
-			break;
-		}
+		return statm.Size;
+	}
+
+	npas4::impl::ProcessSnapshot x;
+	npas4::impl::ReadProcessSnapshot(x);
+	return x.Virtual;
+}
+
+int64_t npas4::GetRAMProportionalUsedByCurrentProcess()
+{
+	npas4::impl::SmapsSnapshot x;
+	npas4::impl::ReadSmapsSnapshot(x);
+	return x.Pss;
+}
+
+int64_t npas4::GetRAMUniqueUsedByCurrentProcess()
+{
+	npas4::impl::SmapsSnapshot x;
+	npas4::impl::ReadSmapsSnapshot(x);
+	return x.Uss;
+}
+
+int64_t npas4::GetRAMSystemUsedByProcess(int64_t pid)
+{
+	npas4::impl::StatmFields statm;
+
+	if(npas4::impl::ReadLowLatency(pid, statm) == true)
+	{
+		return statm.Resident + statm.Size;
+	}
+
+	npas4::impl::ProcessSnapshot x;
+	npas4::impl::ReadProcessSnapshot(pid, x);
+	return npas4::impl::SystemUsedByCurrentProcess(x);
+}
+
+int64_t npas4::GetRAMPhysicalUsedByProcess(int64_t pid)
+{
+	npas4::impl::StatmFields statm;
+
+	if(npas4::impl::ReadLowLatency(pid, statm) == true)
+	{
+		return statm.Resident;
+	}
+
+	npas4::impl::ProcessSnapshot x;
+	npas4::impl::ReadProcessSnapshot(pid, x);
+	return x.Physical;
+}
+
+int64_t npas4::GetRAMPhysicalUsedByProcessPeak(int64_t pid)
+{
+	npas4::impl::ProcessSnapshot x;
+	npas4::impl::ReadProcessSnapshot(pid, x);
+	return x.PhysicalPeak;
+}
+
+int64_t npas4::GetRAMVirtualUsedByProcess(int64_t pid)
+{
+	npas4::impl::StatmFields statm;
+
+	if(npas4::impl::ReadLowLatency(pid, statm) == true)
+	{
+		return statm.Size;
 	}
 
-	fclose(file);
-	return result;
-#endif
+	npas4::impl::ProcessSnapshot x;
+	npas4::impl::ReadProcessSnapshot(pid, x);
+	return x.Virtual;
+}
+
+int64_t npas4::GetRAMProportionalUsedByProcess(int64_t pid)
+{
+	char directory[32];
+	npas4::impl::ProcDirectory(pid, directory);
+
+	npas4::impl::SmapsSnapshot x;
+	npas4::impl::ReadSmaps(directory, x);
+	return x.Pss;
+}
+
+int64_t npas4::GetRAMUniqueUsedByProcess(int64_t pid)
+{
+	char directory[32];
+	npas4::impl::ProcDirectory(pid, directory);
+
+	npas4::impl::SmapsSnapshot x;
+	npas4::impl::ReadSmaps(directory, x);
+	return x.Uss;
+}
+
+int64_t npas4::GetRAMCgroupTotal()
+{
+	return npas4::impl::ReadCgroupReport().RamCgroupTotal;
+}
+
+int64_t npas4::GetRAMCgroupAvailable()
+{
+	return npas4::impl::ReadCgroupReport().RamCgroupAvailable;
+}
+
+int64_t npas4::GetRAMCgroupUsed()
+{
+	return npas4::impl::ReadCgroupReport().RamCgroupUsed;
 }
 
 npas4::RAMReport npas4::GetRAMReport()
 {
+	npas4::impl::Snapshot x;
+	npas4::impl::ReadSnapshot(x);
+
+	npas4::RAMReport r;
+	npas4::impl::FillReport(x, r);
+	return r;
+}
+
+npas4::RAMReport npas4::GetRAMReport(uint32_t fields)
+{
+	npas4::impl::Snapshot x;
+
+	if((fields & npas4::impl::SystemReportFields) != 0)
+	{
+		npas4::impl::ReadSystemSnapshot(x.System);
+	}
+
+	if((fields & npas4::impl::CgroupReportFields) != 0)
+	{
+		npas4::impl::ReadCgroupSnapshot(x.Cgroup);
+	}
+
+	if((fields & npas4::impl::SmapsReportFields) != 0)
+	{
+		npas4::impl::ReadSmapsSnapshot(x.Smaps);
+	}
+
+	if((fields & npas4::RAMReportField::PhysicalUsedByCurrentProcessPeak) != 0)
+	{
+		npas4::impl::ReadProcessSnapshot(x.Process);
+	}
+	else if((fields & npas4::impl::ProcessReportFields) != 0)
+	{
+		// Without the peak, statm carries every per-process field and is far cheaper than status.
+		npas4::impl::StatmFields statm;
+
+		if(npas4::impl::ReadStatm(statm) == true)
+		{
+			x.Process.Physical = statm.Resident;
+			x.Process.Virtual = statm.Size;
+		}
+		else
+		{
+			npas4::impl::ReadProcessSnapshot(x.Process);
+		}
+	}
+
 	npas4::RAMReport r;
-	r.RamSystemTotal = GetRAMSystemTotal();
-	r.RamSystemAvailable = GetRAMSystemAvailable();
-	r.RamSystemUsed = GetRAMSystemUsed();
-	r.RamSystemUsedByCurrentProcess = GetRAMSystemUsedByCurrentProcess();
-	r.RamPhysicalTotal = GetRAMPhysicalTotal();
-	r.RamPhysicalAvailable = GetRAMPhysicalAvailable();
-	r.RamPhysicalUsed = GetRAMPhysicalUsed();
-	r.RamPhysicalUsedByCurrentProcess = GetRAMPhysicalUsedByCurrentProcess();
-	r.RamVirtualTotal = GetRAMVirtualTotal();
-	r.RamVirtualAvailable = GetRAMVirtualAvailable();
-	r.RamVirtualUsed = GetRAMVirtualUsed();
-	r.RamVirtualUsedByCurrentProcess = GetRAMVirtualUsedByCurrentProcess();
+	npas4::impl::FillReport(x, r);
+	npas4::impl::MaskReport(r, fields);
+	return r;
+}
+
+npas4::ExtendedReport npas4::GetExtendedReport()
+{
+	npas4::ExtendedReport r;
+	npas4::impl::StatmFields statm;
+
+	if(npas4::impl::ReadStatm(statm) == true)
+	{
+		r.RamPhysicalUsedByCurrentProcess = statm.Resident;
+		r.RamVirtualUsedByCurrentProcess = statm.Size;
+		r.RamSharedByCurrentProcess = statm.Shared;
+		r.RamTextByCurrentProcess = statm.Text;
+		r.RamDataByCurrentProcess = statm.Data;
+	}
+	else
+	{
+		npas4::impl::ProcessSnapshot x;
+		npas4::impl::ReadProcessSnapshot(x);
+		r.RamPhysicalUsedByCurrentProcess = x.Physical;
+		r.RamVirtualUsedByCurrentProcess = x.Virtual;
+	}
+
+	npas4::impl::SmapsSnapshot smaps;
+
+	if(npas4::impl::ReadSmapsSnapshot(smaps) == true)
+	{
+		r.RamProportionalUsedByCurrentProcess = smaps.Pss;
+		r.RamUniqueUsedByCurrentProcess = smaps.Uss;
+		r.RamSwapByCurrentProcess = smaps.Swap;
+		r.RamSwapProportionalByCurrentProcess = smaps.SwapPss;
+		r.RamAnonymousByCurrentProcess = smaps.Anonymous;
+		r.RamAnonHugePagesByCurrentProcess = smaps.AnonHugePages;
+		r.RamLockedByCurrentProcess = smaps.Locked;
+	}
+
 	return r;
 }
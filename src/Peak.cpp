@@ -0,0 +1,186 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Peak.h>
+#include <npas4/Sampler.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+///
+/// References:
+/// https://www.kernel.org/doc/Documentation/filesystems/proc.txt (clear_refs)
+///
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// The ScopedPeaks currently using the kernel's peak.  Each holds the largest peak it observed before later resets.
+		///
+		struct PeakScopes
+		{
+			std::mutex Mutex;
+			std::vector<int64_t*> Carried;
+		};
+
+		PeakScopes& ActivePeakScopes()
+		{
+			static PeakScopes x;
+			return x;
+		}
+
+		bool ClearPeak()
+		{
+#if defined(__linux__)
+			const auto fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+
+			if(fd < 0)
+			{
+				return false;
+			}
+
+			ssize_t bytes;
+
+			// Kernels before 4.0 reject "5" with EINVAL.
+			do
+			{
+				bytes = write(fd, "5", 1);
+			} while(bytes < 0 && errno == EINTR);
+
+			close(fd);
+			return bytes == 1;
+#else
+			return false;
+#endif
+		}
+
+		///
+		/// Resets the kernel's peak, first folding the peak so far into every active scope.  The caller holds the scopes' mutex.
+		///
+		bool ResetPeak(PeakScopes& scopes)
+		{
+			const auto peak = npas4::GetRAMPhysicalUsedByCurrentProcessPeak();
+
+			if(npas4::impl::ClearPeak() == false)
+			{
+				return false;
+			}
+
+			for(auto carried : scopes.Carried)
+			{
+				*carried = std::max(*carried, peak);
+			}
+
+			return true;
+		}
+	} // namespace impl
+} // namespace npas4
+
+bool npas4::ResetPeak()
+{
+	auto& scopes = npas4::impl::ActivePeakScopes();
+	std::lock_guard<std::mutex> lock(scopes.Mutex);
+	return npas4::impl::ResetPeak(scopes);
+}
+
+class npas4::ScopedPeak::Impl
+{
+public:
+	explicit Impl(std::chrono::nanoseconds interval) : start(npas4::GetRAMPhysicalUsedByCurrentProcess())
+	{
+		{
+			auto& scopes = npas4::impl::ActivePeakScopes();
+			std::lock_guard<std::mutex> lock(scopes.Mutex);
+			this->exact = npas4::impl::ResetPeak(scopes);
+
+			if(this->exact == true)
+			{
+				scopes.Carried.push_back(&this->carried);
+			}
+		}
+
+		if(this->exact == false)
+		{
+			this->sampler.reset(new npas4::Sampler(interval));
+		}
+	}
+
+	~Impl()
+	{
+		if(this->exact == true)
+		{
+			auto& scopes = npas4::impl::ActivePeakScopes();
+			std::lock_guard<std::mutex> lock(scopes.Mutex);
+			scopes.Carried.erase(std::find(std::begin(scopes.Carried), std::end(scopes.Carried), &this->carried));
+		}
+	}
+
+	int64_t GetPeak()
+	{
+		if(this->exact == true)
+		{
+			auto& scopes = npas4::impl::ActivePeakScopes();
+			std::lock_guard<std::mutex> lock(scopes.Mutex);
+			return std::max({this->start, this->carried, npas4::GetRAMPhysicalUsedByCurrentProcessPeak()});
+		}
+
+		return std::max(this->start, this->sampler->GetPeak());
+	}
+
+	const int64_t start;
+	bool exact{false};
+	int64_t carried{0};
+	std::unique_ptr<npas4::Sampler> sampler;
+};
+
+npas4::ScopedPeak::ScopedPeak(std::chrono::nanoseconds interval) : pimpl(new Impl(interval))
+{
+}
+
+npas4::ScopedPeak::~ScopedPeak()
+{
+}
+
+bool npas4::ScopedPeak::IsExact() const
+{
+	return this->pimpl->exact;
+}
+
+int64_t npas4::ScopedPeak::GetStart() const
+{
+	return this->pimpl->start;
+}
+
+int64_t npas4::ScopedPeak::GetPeak() const
+{
+	return this->pimpl->GetPeak();
+}
+
+int64_t npas4::ScopedPeak::GetPeakIncrease() const
+{
+	return this->GetPeak() - this->pimpl->start;
+}
@@ -0,0 +1,271 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Pool.h>
+
+#include "ArenaRegistry.h"
+#include "CacheAlignedArray.h"
+#include "ThreadIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace
+{
+	const size_t ThreadCount{64};
+	const int64_t Batch{32};
+	const size_t SlabSize{64 * 1024};
+
+	///
+	/// Thread indexes are claimed for every pool at once: only the thread holding an index uses any pool's cache of that index.  The next
+	/// thread to claim a released index inherits the blocks it left cached.
+	///
+	struct PoolTag : npas4::impl::ThreadIndexHooks
+	{
+	};
+
+	inline size_t GetThreadIndex()
+	{
+		return npas4::impl::ThreadIndex<PoolTag, ThreadCount>::Get();
+	}
+
+	///
+	/// One thread's free blocks, on a cache line of its own.  The counters are written only by the owning thread (or, for the shared cache,
+	/// under the pool's lock) and read by reports.
+	///
+	struct alignas(64) Cache
+	{
+		void* Free{nullptr};
+		int64_t Count{0};
+		std::atomic<int64_t> Allocations{0};
+		std::atomic<int64_t> Deallocations{0};
+	};
+
+	inline void Add(std::atomic<int64_t>& counter, int64_t x)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + x, std::memory_order_relaxed);
+	}
+
+	inline void Push(void*& list, void* x)
+	{
+		*static_cast<void**>(x) = list;
+		list = x;
+	}
+
+	inline void* Pop(void*& list)
+	{
+		auto x = list;
+		list = *static_cast<void**>(x);
+		return x;
+	}
+} // namespace
+
+class npas4::impl::FixedPool::Impl : public npas4::impl::ArenaSource
+{
+public:
+	Impl(const char* name, size_t size, size_t alignment)
+		: name{name != nullptr ? name : "pool"},
+		  alignment{std::max(alignment, alignof(void*))},
+		  size{(std::max(size, sizeof(void*)) + this->alignment - 1) & ~(this->alignment - 1)},
+		  slabSize{std::max(SlabSize, this->size * static_cast<size_t>(Batch))}
+	{
+	}
+
+	~Impl()
+	{
+		for(auto i : this->slabs)
+		{
+			free(i);
+		}
+	}
+
+	npas4::ArenaReport GetReport() const override
+	{
+		int64_t live{0};
+
+		for(const auto& i : this->Caches)
+		{
+			live += i.Allocations.load(std::memory_order_relaxed) - i.Deallocations.load(std::memory_order_relaxed);
+		}
+
+		npas4::ArenaReport x;
+		x.Name = this->name;
+		x.Type = "pool";
+		x.CommittedBytes = this->committed.load(std::memory_order_relaxed);
+		x.UsedBytes = live * static_cast<int64_t>(this->size);
+		x.PeakUsedBytes = std::max(x.UsedBytes, this->carved.load(std::memory_order_relaxed));
+		return x;
+	}
+
+	///
+	/// A block from the shared free list, or else from the current slab.  Called under Lock.
+	///
+	void* Take()
+	{
+		if(this->freeList != nullptr)
+		{
+			return Pop(this->freeList);
+		}
+
+		if(this->carve == nullptr || static_cast<size_t>(this->carveEnd - this->carve) < this->size)
+		{
+			auto slab = static_cast<char*>(malloc(this->slabSize + this->alignment));
+
+			if(slab == nullptr)
+			{
+				throw std::bad_alloc();
+			}
+
+			this->slabs.push_back(slab);
+			this->committed.fetch_add(static_cast<int64_t>(this->slabSize + this->alignment), std::memory_order_relaxed);
+
+			const auto aligned = (reinterpret_cast<uintptr_t>(slab) + this->alignment - 1) & ~(static_cast<uintptr_t>(this->alignment) - 1);
+			this->carve = reinterpret_cast<char*>(aligned);
+			this->carveEnd = this->carve + this->slabSize;
+		}
+
+		auto x = this->carve;
+		this->carve += this->size;
+		this->carved.fetch_add(static_cast<int64_t>(this->size), std::memory_order_relaxed);
+		return x;
+	}
+
+	///
+	/// Called under Lock.
+	///
+	void Release(void* x)
+	{
+		Push(this->freeList, x);
+	}
+
+	void Refill(Cache& x)
+	{
+		std::lock_guard<std::mutex> lock(this->Lock);
+
+		// The first may throw, leaving the cache empty; later ones only come from the current slab, so cannot.
+		Push(x.Free, this->Take());
+		++x.Count;
+
+		while(x.Count < Batch && (this->freeList != nullptr || static_cast<size_t>(this->carveEnd - this->carve) >= this->size))
+		{
+			Push(x.Free, this->Take());
+			++x.Count;
+		}
+	}
+
+	void Flush(Cache& x)
+	{
+		std::lock_guard<std::mutex> lock(this->Lock);
+
+		for(int64_t i = 0; i < Batch; ++i)
+		{
+			Push(this->freeList, Pop(x.Free));
+			--x.Count;
+		}
+	}
+
+	///
+	/// The last cache counts for threads that found no free index, which use the shared free list directly, under Lock.
+	///
+	npas4::impl::CacheAlignedArray<Cache> Caches{ThreadCount + 1};
+	std::mutex Lock;
+
+private:
+	const std::string name;
+	const size_t alignment;
+	const size_t size;
+	const size_t slabSize;
+
+	void* freeList{nullptr};
+	std::vector<char*> slabs;
+	char* carve{nullptr};
+	char* carveEnd{nullptr};
+
+	std::atomic<int64_t> committed{0};
+	std::atomic<int64_t> carved{0};
+};
+
+npas4::impl::FixedPool::FixedPool(const char* name, size_t size, size_t alignment) : pimpl{new Impl(name, size, alignment)}
+{
+	npas4::impl::RegisterArena(this->pimpl.get());
+}
+
+npas4::impl::FixedPool::~FixedPool()
+{
+	npas4::impl::UnregisterArena(this->pimpl.get());
+}
+
+void* npas4::impl::FixedPool::Allocate()
+{
+	const auto index = GetThreadIndex();
+	auto& cache = this->pimpl->Caches[index];
+
+	if(index == ThreadCount)
+	{
+		std::lock_guard<std::mutex> lock(this->pimpl->Lock);
+		auto x = this->pimpl->Take();
+		Add(cache.Allocations, 1);
+		return x;
+	}
+
+	if(cache.Free == nullptr)
+	{
+		this->pimpl->Refill(cache);
+	}
+
+	--cache.Count;
+	Add(cache.Allocations, 1);
+	return Pop(cache.Free);
+}
+
+void npas4::impl::FixedPool::Deallocate(void* x)
+{
+	if(x == nullptr)
+	{
+		return;
+	}
+
+	const auto index = GetThreadIndex();
+	auto& cache = this->pimpl->Caches[index];
+
+	if(index == ThreadCount)
+	{
+		std::lock_guard<std::mutex> lock(this->pimpl->Lock);
+		this->pimpl->Release(x);
+		Add(cache.Deallocations, 1);
+		return;
+	}
+
+	Push(cache.Free, x);
+	++cache.Count;
+	Add(cache.Deallocations, 1);
+
+	if(cache.Count >= 2 * Batch)
+	{
+		this->pimpl->Flush(cache);
+	}
+}
+
+npas4::ArenaReport npas4::impl::FixedPool::GetReport() const
+{
+	return this->pimpl->GetReport();
+}
@@ -0,0 +1,164 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include "ProcFile.h"
+#include "ReadBatch.h"
+
+#ifndef WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+constexpr size_t npas4::impl::ProcFile::BufferSize;
+
+npas4::impl::ProcFile::ProcFile()
+{
+	this->buffer[0] = '\0';
+}
+
+npas4::impl::ProcFile::ProcFile(const char* path)
+{
+	this->buffer[0] = '\0';
+	this->Open(path);
+}
+
+npas4::impl::ProcFile::~ProcFile()
+{
+	this->Close();
+}
+
+bool npas4::impl::ProcFile::Open(const char* path)
+{
+	this->Close();
+
+#ifdef WIN32
+	(void)path;
+	return false;
+#else
+	this->fd = open(path, O_RDONLY | O_CLOEXEC);
+	return this->fd >= 0;
+#endif
+}
+
+bool npas4::impl::ProcFile::OpenAt(int directory, const char* name)
+{
+	this->Close();
+
+#ifdef WIN32
+	(void)directory;
+	(void)name;
+	return false;
+#else
+	this->fd = openat(directory, name, O_RDONLY | O_CLOEXEC);
+	return this->fd >= 0;
+#endif
+}
+
+void npas4::impl::ProcFile::Close()
+{
+#ifndef WIN32
+	if(this->fd >= 0)
+	{
+		close(this->fd);
+	}
+#endif
+
+	this->fd = -1;
+	this->size = 0;
+	this->buffer[0] = '\0';
+}
+
+bool npas4::impl::ProcFile::IsOpen() const
+{
+	return this->fd >= 0;
+}
+
+bool npas4::impl::ProcFile::Read()
+{
+	this->size = 0;
+	this->buffer[0] = '\0';
+
+#ifdef WIN32
+	return false;
+#else
+	if(this->fd < 0)
+	{
+		return false;
+	}
+
+	// seq_file fills the caller's buffer until it is full or the file is exhausted, so a short read means EOF and a sample costs a single
+	// pread().  The loop only repeats on EINTR.
+	while(this->size < BufferSize - 1)
+	{
+		const auto request = BufferSize - 1 - this->size;
+		const auto bytes = pread(this->fd, this->buffer + this->size, request, static_cast<off_t>(this->size));
+
+		if(bytes < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+
+			this->size = 0;
+			this->buffer[0] = '\0';
+			return false;
+		}
+
+		this->size += static_cast<size_t>(bytes);
+
+		if(static_cast<size_t>(bytes) < request)
+		{
+			break;
+		}
+	}
+
+	this->buffer[this->size] = '\0';
+	return true;
+#endif
+}
+
+size_t npas4::impl::ProcFile::Enqueue(npas4::impl::ReadBatch& x)
+{
+	return x.Add(this->fd, this->buffer, BufferSize - 1);
+}
+
+bool npas4::impl::ProcFile::Complete(int64_t bytes)
+{
+	if(bytes < 0)
+	{
+		this->size = 0;
+		this->buffer[0] = '\0';
+		return false;
+	}
+
+	this->size = static_cast<size_t>(bytes);
+	this->buffer[this->size] = '\0';
+	return true;
+}
+
+const char* npas4::impl::ProcFile::Data() const
+{
+	return this->buffer;
+}
+
+size_t npas4::impl::ProcFile::Size() const
+{
+	return this->size;
+}
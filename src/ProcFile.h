@@ -0,0 +1,93 @@
+#ifndef H_NPAS4_PROCFILE_H
+#define H_NPAS4_PROCFILE_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <cstddef>
+#include <cstdint>
+
+namespace npas4
+{
+	namespace impl
+	{
+		class ReadBatch;
+
+		///
+		/// A procfs file held open for repeated sampling.
+		///
+		/// procfs regenerates a file's contents whenever it is read from offset zero, so the descriptor can be kept open for the lifetime of
+		/// the object and re-read with pread() into a fixed buffer.  A Read() performs no allocation and no open/close.
+		///
+		/// The buffer is sized for the files this library reads (status, statm, meminfo, smaps_rollup).  Content beyond the buffer is dropped.
+		///
+		class ProcFile
+		{
+		public:
+			static constexpr size_t BufferSize{8192};
+
+			ProcFile();
+			explicit ProcFile(const char* path);
+			~ProcFile();
+
+			ProcFile(const ProcFile&) = delete;
+			ProcFile& operator=(const ProcFile&) = delete;
+
+			///
+			/// Opens a file, closing any previously held file.  Returns false if the file could not be opened.
+			///
+			bool Open(const char* path);
+
+			///
+			/// Opens a file relative to an open directory descriptor (e.g. one held on /proc/<pid>), skipping path resolution from the root.
+			///
+			bool OpenAt(int directory, const char* name);
+
+			void Close();
+
+			bool IsOpen() const;
+
+			///
+			/// Re-reads the whole file from offset zero.  Returns false on error (e.g. the process behind the file has exited).
+			/// On success, Data() is null terminated.
+			///
+			bool Read();
+
+			///
+			/// Queues the equivalent of Read() on a batch, returning the read's index in the batch.  Once the batch is submitted, pass the
+			/// read's result to Complete().
+			///
+			size_t Enqueue(npas4::impl::ReadBatch& x);
+
+			///
+			/// Finishes a batched read, given the number of bytes read (negative on failure).  Returns what Read() would have.
+			///
+			bool Complete(int64_t bytes);
+
+			const char* Data() const;
+			size_t Size() const;
+
+		private:
+			int fd{-1};
+			size_t size{0};
+			char buffer[BufferSize];
+		};
+	} // namespace impl
+} // namespace npas4
+
+#endif
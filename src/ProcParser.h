@@ -0,0 +1,358 @@
+#ifndef H_NPAS4_PROCPARSER_H
+#define H_NPAS4_PROCPARSER_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+///
+/// A single pass, allocation free tokenizer for procfs files made of "Key:   value kB" lines (/proc/<pid>/status, /proc/meminfo,
+/// /proc/<pid>/smaps_rollup, memory.stat, ...).
+///
+/// Keys are resolved through a hash of the key's length and its first and last eight bytes, so hashing costs the same for every key.  Every
+/// field struct maps hashes to members with a switch whose case labels are evaluated at compile time, so a collision between two known keys
+/// is a compile error (duplicate case value) and the hash is perfect over each struct's key set.  Unknown keys that happen to share a hash
+/// are rejected by a final byte comparison.
+///
+/// Integers are parsed into int64_t without locale or libc calls.  Values with a "kB" suffix are converted to bytes.
+///
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// Packs up to eight bytes into an integer, first byte most significant.
+		///
+		constexpr uint64_t PackKeyBytes(const char* key, size_t length)
+		{
+			return (length == 0) ? 0 : ((PackKeyBytes(key, length - 1) << 8) | static_cast<uint8_t>(key[length - 1]));
+		}
+
+		constexpr uint32_t MixKey(uint64_t length, uint64_t head, uint64_t tail)
+		{
+			return static_cast<uint32_t>(((head ^ (tail * 0xC2B2AE3D27D4EB4Full) ^ length) * 0x9E3779B97F4A7C15ull) >> 32);
+		}
+
+		///
+		/// The key hash, written as single return statements so it is a C++11 constant expression.
+		///
+		constexpr uint32_t HashKey(const char* key, size_t length)
+		{
+			return MixKey(length, PackKeyBytes(key, (length < 8) ? length : 8), PackKeyBytes(key + ((length < 8) ? 0 : length - 8), (length < 8) ? length : 8));
+		}
+
+		///
+		/// The same hash as HashKey(), written as a loop for use at run time.
+		///
+		inline uint32_t HashKeyRuntime(const char* key, size_t length)
+		{
+			const auto n = (length < 8) ? length : size_t(8);
+			const auto tailKey = key + length - n;
+			uint64_t head = 0;
+			uint64_t tail = 0;
+
+			for(size_t i = 0; i < n; ++i)
+			{
+				head = (head << 8) | static_cast<uint8_t>(key[i]);
+				tail = (tail << 8) | static_cast<uint8_t>(tailKey[i]);
+			}
+
+			return MixKey(length, head, tail);
+		}
+
+		inline bool KeyEquals(const char* key, size_t length, const char* expected, size_t expectedLength)
+		{
+			return length == expectedLength && memcmp(key, expected, length) == 0;
+		}
+
+		///
+		/// Parses a run of decimal digits.  Advances 'p' past the digits.
+		///
+		inline int64_t ParseInt64(const char*& p, const char* end)
+		{
+			int64_t value = 0;
+
+			while(p < end && static_cast<unsigned>(*p - '0') < 10u)
+			{
+				value = value * 10 + (*p - '0');
+				++p;
+			}
+
+			return value;
+		}
+
+		///
+		/// Tokenizes every "Key: value [kB]" line in [data, data + size) and hands each (hash, key, value) to Fields::Find(), which returns a
+		/// pointer to the member to store the value in, or nullptr to ignore the line.  Lines without a ':' are skipped.  When 'Accumulate' is
+		/// true values are added to the member rather than replacing it.
+		///
+		/// Returns the number of values stored.
+		///
+		template <bool Accumulate, typename Fields>
+		size_t TokenizeKeyValues(const char* data, size_t size, Fields& fields)
+		{
+			const auto end = data + size;
+			auto p = data;
+			size_t stored = 0;
+
+			while(p < end)
+			{
+				auto eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+
+				if(eol == nullptr)
+				{
+					eol = end;
+				}
+
+				auto v = static_cast<const char*>(memchr(p, ':', static_cast<size_t>(eol - p)));
+
+				if(v != nullptr)
+				{
+					// Resolve the key first so values of lines nobody asked for are never parsed.
+					const auto keyLength = static_cast<size_t>(v - p);
+					const auto field = fields.Find(npas4::impl::HashKeyRuntime(p, keyLength), p, keyLength);
+
+					if(field != nullptr)
+					{
+						++v;
+
+						while(v < eol && (*v == ' ' || *v == '\t'))
+						{
+							++v;
+						}
+
+						auto value = npas4::impl::ParseInt64(v, eol);
+
+						if(v + 2 < eol && v[0] == ' ' && v[1] == 'k' && v[2] == 'B')
+						{
+							value *= 1024;
+						}
+
+						*field = (Accumulate == true) ? *field + value : value;
+						++stored;
+					}
+				}
+
+				p = eol + 1;
+			}
+
+			return stored;
+		}
+
+		///
+		/// Stores the value of every known key.  See TokenizeKeyValues().
+		///
+		template <typename Fields>
+		size_t ParseKeyValues(const char* data, size_t size, Fields& fields)
+		{
+			return npas4::impl::TokenizeKeyValues<false>(data, size, fields);
+		}
+
+		///
+		/// Sums the values of every known key, for files that repeat keys (e.g. one block per mapping in /proc/<pid>/smaps).
+		/// See TokenizeKeyValues().
+		///
+		template <typename Fields>
+		size_t AccumulateKeyValues(const char* data, size_t size, Fields& fields)
+		{
+			return npas4::impl::TokenizeKeyValues<true>(data, size, fields);
+		}
+	} // namespace impl
+} // namespace npas4
+
+///
+/// Expands to a switch case that maps the key spelled the same as the member to the member.
+///
+#define NPAS4_PROC_FIELD(Name) \
+	case npas4::impl::HashKey(#Name, sizeof(#Name) - 1): \
+		return npas4::impl::KeyEquals(key, length, #Name, sizeof(#Name) - 1) ? &this->Name : nullptr;
+
+///
+/// Expands to a switch case for keys that are not valid C++ identifiers (e.g. "Active(anon)").
+///
+#define NPAS4_PROC_FIELD_KEY(Key, Name) \
+	case npas4::impl::HashKey(Key, sizeof(Key) - 1): \
+		return npas4::impl::KeyEquals(key, length, Key, sizeof(Key) - 1) ? &this->Name : nullptr;
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// The memory related fields of /proc/<pid>/status, in bytes.
+		///
+		struct StatusFields
+		{
+			int64_t VmPeak{0};
+			int64_t VmSize{0};
+			int64_t VmLck{0};
+			int64_t VmPin{0};
+			int64_t VmHWM{0};
+			int64_t VmRSS{0};
+			int64_t RssAnon{0};
+			int64_t RssFile{0};
+			int64_t RssShmem{0};
+			int64_t VmData{0};
+			int64_t VmStk{0};
+			int64_t VmExe{0};
+			int64_t VmLib{0};
+			int64_t VmPTE{0};
+			int64_t VmSwap{0};
+
+			int64_t* Find(uint32_t hash, const char* key, size_t length)
+			{
+				switch(hash)
+				{
+					NPAS4_PROC_FIELD(VmPeak)
+					NPAS4_PROC_FIELD(VmSize)
+					NPAS4_PROC_FIELD(VmLck)
+					NPAS4_PROC_FIELD(VmPin)
+					NPAS4_PROC_FIELD(VmHWM)
+					NPAS4_PROC_FIELD(VmRSS)
+					NPAS4_PROC_FIELD(RssAnon)
+					NPAS4_PROC_FIELD(RssFile)
+					NPAS4_PROC_FIELD(RssShmem)
+					NPAS4_PROC_FIELD(VmData)
+					NPAS4_PROC_FIELD(VmStk)
+					NPAS4_PROC_FIELD(VmExe)
+					NPAS4_PROC_FIELD(VmLib)
+					NPAS4_PROC_FIELD(VmPTE)
+					NPAS4_PROC_FIELD(VmSwap)
+					default:
+						return nullptr;
+				}
+			}
+		};
+
+		///
+		/// The fields of /proc/meminfo, in bytes.
+		///
+		struct MeminfoFields
+		{
+			int64_t MemTotal{0};
+			int64_t MemFree{0};
+			int64_t MemAvailable{0};
+			int64_t Buffers{0};
+			int64_t Cached{0};
+			int64_t SwapCached{0};
+			int64_t ActiveAnon{0};
+			int64_t InactiveAnon{0};
+			int64_t ActiveFile{0};
+			int64_t InactiveFile{0};
+			int64_t HighTotal{0};
+			int64_t HighFree{0};
+			int64_t SwapTotal{0};
+			int64_t SwapFree{0};
+			int64_t Dirty{0};
+			int64_t Writeback{0};
+			int64_t AnonPages{0};
+			int64_t Mapped{0};
+			int64_t Shmem{0};
+			int64_t KReclaimable{0};
+			int64_t Slab{0};
+			int64_t SReclaimable{0};
+			int64_t SUnreclaim{0};
+			int64_t CommitLimit{0};
+			int64_t CommittedAS{0};
+
+			int64_t* Find(uint32_t hash, const char* key, size_t length)
+			{
+				switch(hash)
+				{
+					NPAS4_PROC_FIELD(MemTotal)
+					NPAS4_PROC_FIELD(MemFree)
+					NPAS4_PROC_FIELD(MemAvailable)
+					NPAS4_PROC_FIELD(Buffers)
+					NPAS4_PROC_FIELD(Cached)
+					NPAS4_PROC_FIELD(SwapCached)
+					NPAS4_PROC_FIELD_KEY("Active(anon)", ActiveAnon)
+					NPAS4_PROC_FIELD_KEY("Inactive(anon)", InactiveAnon)
+					NPAS4_PROC_FIELD_KEY("Active(file)", ActiveFile)
+					NPAS4_PROC_FIELD_KEY("Inactive(file)", InactiveFile)
+					NPAS4_PROC_FIELD(HighTotal)
+					NPAS4_PROC_FIELD(HighFree)
+					NPAS4_PROC_FIELD(SwapTotal)
+					NPAS4_PROC_FIELD(SwapFree)
+					NPAS4_PROC_FIELD(Dirty)
+					NPAS4_PROC_FIELD(Writeback)
+					NPAS4_PROC_FIELD(AnonPages)
+					NPAS4_PROC_FIELD(Mapped)
+					NPAS4_PROC_FIELD(Shmem)
+					NPAS4_PROC_FIELD(KReclaimable)
+					NPAS4_PROC_FIELD(Slab)
+					NPAS4_PROC_FIELD(SReclaimable)
+					NPAS4_PROC_FIELD(SUnreclaim)
+					NPAS4_PROC_FIELD(CommitLimit)
+					NPAS4_PROC_FIELD_KEY("Committed_AS", CommittedAS)
+					default:
+						return nullptr;
+				}
+			}
+		};
+
+		///
+		/// The fields of /proc/<pid>/smaps_rollup, in bytes.  /proc/<pid>/smaps repeats the same keys once per mapping.
+		///
+		struct SmapsFields
+		{
+			int64_t Rss{0};
+			int64_t Pss{0};
+			int64_t SharedClean{0};
+			int64_t SharedDirty{0};
+			int64_t PrivateClean{0};
+			int64_t PrivateDirty{0};
+			int64_t Referenced{0};
+			int64_t Anonymous{0};
+			int64_t LazyFree{0};
+			int64_t AnonHugePages{0};
+			int64_t ShmemPmdMapped{0};
+			int64_t Swap{0};
+			int64_t SwapPss{0};
+			int64_t Locked{0};
+
+			int64_t* Find(uint32_t hash, const char* key, size_t length)
+			{
+				switch(hash)
+				{
+					NPAS4_PROC_FIELD(Rss)
+					NPAS4_PROC_FIELD(Pss)
+					NPAS4_PROC_FIELD_KEY("Shared_Clean", SharedClean)
+					NPAS4_PROC_FIELD_KEY("Shared_Dirty", SharedDirty)
+					NPAS4_PROC_FIELD_KEY("Private_Clean", PrivateClean)
+					NPAS4_PROC_FIELD_KEY("Private_Dirty", PrivateDirty)
+					NPAS4_PROC_FIELD(Referenced)
+					NPAS4_PROC_FIELD(Anonymous)
+					NPAS4_PROC_FIELD(LazyFree)
+					NPAS4_PROC_FIELD(AnonHugePages)
+					NPAS4_PROC_FIELD(ShmemPmdMapped)
+					NPAS4_PROC_FIELD(Swap)
+					NPAS4_PROC_FIELD(SwapPss)
+					NPAS4_PROC_FIELD(Locked)
+					default:
+						return nullptr;
+				}
+			}
+		};
+	} // namespace impl
+} // namespace npas4
+
+#endif
@@ -0,0 +1,449 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/ProcessHandle.h>
+
+#include "ProcFile.h"
+#include "ReadBatch.h"
+#include "Snapshot.h"
+
+#include <cstdio>
+#include <sstream>
+
+#ifdef WIN32
+#include <Psapi.h>
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace npas4
+{
+	namespace impl
+	{
+		void FillProcessReport(const npas4::impl::ProcessSnapshot& process, const npas4::impl::SmapsSnapshot& smaps, npas4::ProcessReport& x)
+		{
+			x.RamPhysicalUsed = process.Physical;
+			x.RamPhysicalUsedPeak = process.PhysicalPeak;
+			x.RamVirtualUsed = process.Virtual;
+			x.RamProportionalUsed = smaps.Pss;
+			x.RamUniqueUsed = smaps.Uss;
+		}
+	} // namespace impl
+} // namespace npas4
+
+class npas4::ProcessHandle::Impl
+{
+public:
+	explicit Impl(int64_t x) : pid(x), pageSize(npas4::impl::PageSize())
+	{
+#ifdef WIN32
+		this->process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(x));
+#else
+		npas4::impl::ProcDirectory(x, this->path);
+		this->directory = open(this->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+		if(this->directory >= 0)
+		{
+			this->status.OpenAt(this->directory, "status");
+			this->statm.OpenAt(this->directory, "statm");
+			this->smapsRollup.OpenAt(this->directory, "smaps_rollup");
+		}
+#endif
+	}
+
+	~Impl()
+	{
+#ifdef WIN32
+		if(this->process != nullptr)
+		{
+			CloseHandle(this->process);
+		}
+#else
+		if(this->directory >= 0)
+		{
+			close(this->directory);
+		}
+#endif
+	}
+
+	bool IsOpen() const
+	{
+#ifdef WIN32
+		return this->process != nullptr;
+#else
+		return this->directory >= 0;
+#endif
+	}
+
+	bool HasSmapsRollup() const
+	{
+#ifdef WIN32
+		return false;
+#else
+		return this->smapsRollup.IsOpen();
+#endif
+	}
+
+	bool ReadProcess(npas4::impl::ProcessSnapshot& x)
+	{
+		x = npas4::impl::ProcessSnapshot();
+
+#ifdef WIN32
+		PROCESS_MEMORY_COUNTERS_EX pmc;
+		DWORD exitCode = 0;
+
+		if(this->process == nullptr || GetExitCodeProcess(this->process, &exitCode) == FALSE || exitCode != STILL_ACTIVE
+		   || GetProcessMemoryInfo(this->process, reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc)) == FALSE)
+		{
+			return false;
+		}
+
+		x.Physical = static_cast<int64_t>(pmc.WorkingSetSize);
+		x.PhysicalPeak = static_cast<int64_t>(pmc.PeakWorkingSetSize);
+		x.Virtual = static_cast<int64_t>(pmc.PrivateUsage);
+		return true;
+#else
+		if(this->status.IsOpen() == true)
+		{
+			// A zombie's status has no memory fields, so it reads as exited.
+			return this->status.Read() == true && npas4::impl::ParseStatus(this->status.Data(), this->status.Size(), x);
+		}
+
+		return npas4::impl::ReadProcessSnapshot(this->pid, x);
+#endif
+	}
+
+	bool ReadStatm(npas4::impl::StatmFields& x)
+	{
+		x = npas4::impl::StatmFields();
+
+#ifdef WIN32
+		return false;
+#else
+		return this->statm.Read() == true && npas4::impl::ParseStatm(this->statm.Data(), this->statm.Size(), this->pageSize, x);
+#endif
+	}
+
+	bool ReadSmaps(npas4::impl::SmapsSnapshot& x)
+	{
+		x = npas4::impl::SmapsSnapshot();
+
+#ifdef WIN32
+		return false;
+#else
+		if(this->smapsRollup.IsOpen() == true)
+		{
+			if(this->smapsRollup.Read() == false)
+			{
+				return false;
+			}
+
+			npas4::impl::ParseSmapsRollup(this->smapsRollup.Data(), this->smapsRollup.Size(), x);
+			return true;
+		}
+
+		if(this->directory < 0)
+		{
+			return false;
+		}
+
+		char smaps[48];
+		snprintf(smaps, sizeof(smaps), "%s/smaps", this->path);
+		return npas4::impl::AccumulateSmaps(smaps, x);
+#endif
+	}
+
+	const int64_t pid;
+	const int64_t pageSize;
+
+#ifdef WIN32
+	HANDLE process{nullptr};
+#else
+	char path[32];
+	int directory{-1};
+	npas4::impl::ProcFile status;
+	npas4::impl::ProcFile statm;
+	npas4::impl::ProcFile smapsRollup;
+#endif
+};
+
+npas4::ProcessReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Physical Used:                     " << this->RamPhysicalUsed << std::endl;
+	ss << "Physical UsedPeak:                 " << this->RamPhysicalUsedPeak << std::endl;
+	ss << "Virtual Used:                      " << this->RamVirtualUsed << std::endl;
+	ss << "Proportional Used:                 " << this->RamProportionalUsed << std::endl;
+	ss << "Unique Used:                       " << this->RamUniqueUsed << std::endl;
+
+	return ss.str();
+}
+
+npas4::ProcessReport npas4::ProcessReport::operator-(const ProcessReport& x)
+{
+	npas4::ProcessReport r;
+	r.RamPhysicalUsed = this->RamPhysicalUsed - x.RamPhysicalUsed;
+	r.RamPhysicalUsedPeak = this->RamPhysicalUsedPeak - x.RamPhysicalUsedPeak;
+	r.RamVirtualUsed = this->RamVirtualUsed - x.RamVirtualUsed;
+	r.RamProportionalUsed = this->RamProportionalUsed - x.RamProportionalUsed;
+	r.RamUniqueUsed = this->RamUniqueUsed - x.RamUniqueUsed;
+
+	return r;
+}
+
+npas4::ProcessHandle::ProcessHandle(int64_t pid) : pimpl(new Impl(pid))
+{
+}
+
+npas4::ProcessHandle::~ProcessHandle()
+{
+}
+
+int64_t npas4::ProcessHandle::GetPid() const
+{
+	return this->pimpl->pid;
+}
+
+bool npas4::ProcessHandle::IsOpen() const
+{
+	return this->pimpl->IsOpen();
+}
+
+bool npas4::ProcessHandle::IsAlive()
+{
+	npas4::impl::ProcessSnapshot x;
+	return this->pimpl->ReadProcess(x);
+}
+
+bool npas4::ProcessHandle::GetReport(npas4::ProcessReport& x, bool smaps)
+{
+	x = npas4::ProcessReport();
+
+	npas4::impl::ProcessSnapshot process;
+
+	if(this->pimpl->ReadProcess(process) == false)
+	{
+		return false;
+	}
+
+	npas4::impl::SmapsSnapshot rollup;
+
+	// If smaps_rollup was opened, failing to read it means the process exited between the two reads.
+	if(smaps == true && this->pimpl->ReadSmaps(rollup) == false && this->pimpl->HasSmapsRollup() == true)
+	{
+		return false;
+	}
+
+	npas4::impl::FillProcessReport(process, rollup, x);
+	return true;
+}
+
+int64_t npas4::ProcessHandle::GetRAMPhysicalUsed()
+{
+	npas4::impl::StatmFields x;
+
+	if(this->pimpl->ReadStatm(x) == true)
+	{
+		return x.Resident;
+	}
+
+	npas4::impl::ProcessSnapshot process;
+	this->pimpl->ReadProcess(process);
+	return process.Physical;
+}
+
+int64_t npas4::ProcessHandle::GetRAMPhysicalUsedPeak()
+{
+	npas4::impl::ProcessSnapshot x;
+	this->pimpl->ReadProcess(x);
+	return x.PhysicalPeak;
+}
+
+int64_t npas4::ProcessHandle::GetRAMVirtualUsed()
+{
+	npas4::impl::StatmFields x;
+
+	if(this->pimpl->ReadStatm(x) == true)
+	{
+		return x.Size;
+	}
+
+	npas4::impl::ProcessSnapshot process;
+	this->pimpl->ReadProcess(process);
+	return process.Virtual;
+}
+
+int64_t npas4::ProcessHandle::GetRAMProportionalUsed()
+{
+	npas4::impl::SmapsSnapshot x;
+	this->pimpl->ReadSmaps(x);
+	return x.Pss;
+}
+
+int64_t npas4::ProcessHandle::GetRAMUniqueUsed()
+{
+	npas4::impl::SmapsSnapshot x;
+	this->pimpl->ReadSmaps(x);
+	return x.Uss;
+}
+
+class npas4::ProcessSet::Impl
+{
+public:
+	Impl() : batch(256)
+	{
+	}
+
+	///
+	/// Completes the batched reads of one process.  Returns false if the process has exited.
+	///
+	bool Complete(npas4::ProcessHandle::Impl& handle, size_t status, size_t smapsRollup, bool smaps, npas4::ProcessReport& x)
+	{
+#ifdef WIN32
+		(void)handle;
+		(void)status;
+		(void)smapsRollup;
+		(void)smaps;
+		(void)x;
+		return false;
+#else
+		npas4::impl::ProcessSnapshot process;
+
+		if(handle.status.Complete(this->batch.Result(status)) == false
+		   || npas4::impl::ParseStatus(handle.status.Data(), handle.status.Size(), process) == false)
+		{
+			return false;
+		}
+
+		npas4::impl::SmapsSnapshot rollup;
+
+		if(smaps == true && handle.smapsRollup.IsOpen() == true)
+		{
+			if(handle.smapsRollup.Complete(this->batch.Result(smapsRollup)) == false)
+			{
+				return false;
+			}
+
+			npas4::impl::ParseSmapsRollup(handle.smapsRollup.Data(), handle.smapsRollup.Size(), rollup);
+		}
+		else if(smaps == true)
+		{
+			handle.ReadSmaps(rollup);
+		}
+
+		npas4::impl::FillProcessReport(process, rollup, x);
+		return true;
+#endif
+	}
+
+	std::vector<std::unique_ptr<npas4::ProcessHandle>> handles;
+	std::vector<size_t> status;
+	std::vector<size_t> smapsRollup;
+	npas4::impl::ReadBatch batch;
+};
+
+npas4::ProcessSet::ProcessSet() : pimpl(new Impl())
+{
+}
+
+npas4::ProcessSet::~ProcessSet()
+{
+}
+
+size_t npas4::ProcessSet::Add(int64_t pid)
+{
+	this->pimpl->handles.emplace_back(new npas4::ProcessHandle(pid));
+	this->pimpl->status.push_back(0);
+	this->pimpl->smapsRollup.push_back(0);
+	return this->pimpl->handles.size() - 1;
+}
+
+size_t npas4::ProcessSet::Size() const
+{
+	return this->pimpl->handles.size();
+}
+
+npas4::ProcessHandle& npas4::ProcessSet::GetHandle(size_t i)
+{
+	return *this->pimpl->handles[i];
+}
+
+size_t npas4::ProcessSet::GetReports(std::vector<npas4::ProcessReport>& x, bool smaps)
+{
+	auto& impl = *this->pimpl;
+	const auto count = impl.handles.size();
+
+	x.assign(count, npas4::ProcessReport());
+
+#ifndef WIN32
+	impl.batch.Clear();
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		auto& handle = *impl.handles[i]->pimpl;
+
+		if(handle.status.IsOpen() == true)
+		{
+			impl.status[i] = handle.status.Enqueue(impl.batch);
+
+			if(smaps == true)
+			{
+				impl.smapsRollup[i] = handle.smapsRollup.Enqueue(impl.batch);
+			}
+		}
+	}
+
+	impl.batch.Submit();
+#endif
+
+	size_t alive = 0;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		auto& handle = *impl.handles[i];
+		bool read;
+
+#ifdef WIN32
+		read = handle.GetReport(x[i], smaps);
+#else
+		if(handle.pimpl->status.IsOpen() == true)
+		{
+			read = impl.Complete(*handle.pimpl, impl.status[i], impl.smapsRollup[i], smaps, x[i]);
+
+			if(read == false)
+			{
+				x[i] = npas4::ProcessReport();
+			}
+		}
+		else
+		{
+			read = handle.GetReport(x[i], smaps);
+		}
+#endif
+
+		if(read == true)
+		{
+			++alive;
+		}
+	}
+
+	return alive;
+}
@@ -0,0 +1,480 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/ProcessScanner.h>
+
+#include "CacheAlignedArray.h"
+#include "ProcFile.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#ifndef WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// The number of pids a thread claims at a time, from its own range or another thread's.
+		///
+		constexpr size_t ScanChunk{32};
+
+		struct ScanRow
+		{
+			int64_t Pid{0};
+			int64_t Physical{0};
+			int64_t Virtual{0};
+			int64_t Proportional{0};
+			int64_t Unique{0};
+			bool Valid{false};
+		};
+
+		///
+		/// One thread's share of the pids.  The owner and any thief claim chunks with the same fetch_add, so stealing needs no lock and a
+		/// range is never processed twice.  On a cache line of its own so that threads claiming from different ranges do not share one.
+		///
+		struct alignas(64) ScanRange
+		{
+			std::atomic<size_t> Next{0};
+			size_t End{0};
+		};
+
+		///
+		/// Per thread buffers, reused for every process the thread reads.
+		///
+		struct ScanWorker
+		{
+			npas4::impl::ProcFile Statm;
+			npas4::impl::ProcFile Smaps;
+		};
+
+		bool ParsePid(const char* name, int64_t& x)
+		{
+			if(*name == '\0')
+			{
+				return false;
+			}
+
+			x = 0;
+
+			for(; *name != '\0'; ++name)
+			{
+				if(static_cast<unsigned>(*name - '0') >= 10u)
+				{
+					return false;
+				}
+
+				x = x * 10 + (*name - '0');
+			}
+
+			return true;
+		}
+
+#if defined(__linux__)
+		///
+		/// The layout of the records getdents64() returns.  glibc only declares this struct for its own use.
+		///
+		struct LinuxDirent64
+		{
+			uint64_t Inode;
+			int64_t Offset;
+			unsigned short Length;
+			unsigned char Type;
+			char Name[1];
+		};
+#endif
+
+		///
+		/// Appends every numeric subdirectory of 'directory' to 'pids'.
+		///
+		void ListProcesses(int directory, std::vector<char>& buffer, std::vector<int64_t>& pids)
+		{
+#if defined(__linux__)
+			// getdents64() fills a large buffer per system call, where readdir() would copy entries out one at a time.
+			lseek(directory, 0, SEEK_SET);
+
+			for(;;)
+			{
+				const auto bytes = syscall(SYS_getdents64, directory, buffer.data(), buffer.size());
+
+				if(bytes <= 0)
+				{
+					break;
+				}
+
+				for(long offset = 0; offset < bytes;)
+				{
+					const auto entry = reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+					offset += entry->Length;
+
+					int64_t pid;
+
+					if((entry->Type == DT_DIR || entry->Type == DT_UNKNOWN) && npas4::impl::ParsePid(entry->Name, pid) == true)
+					{
+						pids.push_back(pid);
+					}
+				}
+			}
+#elif !defined(WIN32)
+			(void)buffer;
+
+			const auto copy = dup(directory);
+			const auto dir = (copy >= 0) ? fdopendir(copy) : nullptr;
+
+			if(dir == nullptr)
+			{
+				if(copy >= 0)
+				{
+					close(copy);
+				}
+
+				return;
+			}
+
+			rewinddir(dir);
+
+			for(auto entry = readdir(dir); entry != nullptr; entry = readdir(dir))
+			{
+				int64_t pid;
+
+				if(npas4::impl::ParsePid(entry->d_name, pid) == true)
+				{
+					pids.push_back(pid);
+				}
+			}
+
+			closedir(dir);
+#else
+			(void)directory;
+			(void)buffer;
+			(void)pids;
+#endif
+		}
+
+		int64_t ScanValue(const ScanRow& x, npas4::ScanKey key)
+		{
+			switch(key)
+			{
+				case npas4::ScanKey::VirtualUsed:
+					return x.Virtual;
+				case npas4::ScanKey::ProportionalUsed:
+					return x.Proportional;
+				case npas4::ScanKey::UniqueUsed:
+					return x.Unique;
+				case npas4::ScanKey::PhysicalUsed:
+				default:
+					return x.Physical;
+			}
+		}
+	} // namespace impl
+} // namespace npas4
+
+class npas4::ProcessScanner::Impl
+{
+public:
+	Impl(size_t threads, const std::string& root)
+		: threadCount((threads > 0) ? threads : std::max(1u, std::thread::hardware_concurrency())),
+		  ranges(threadCount),
+		  workers(new npas4::impl::ScanWorker[threadCount]),
+		  pageSize(npas4::impl::PageSize()),
+		  entries(64 * 1024)
+	{
+#ifndef WIN32
+		this->directory = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#else
+		(void)root;
+#endif
+
+		for(size_t i = 1; i < this->threadCount; ++i)
+		{
+			this->threads.emplace_back([this, i]() { this->Run(i); });
+		}
+	}
+
+	~Impl()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+
+		this->wake.notify_all();
+
+		for(auto& thread : this->threads)
+		{
+			thread.join();
+		}
+
+#ifndef WIN32
+		if(this->directory >= 0)
+		{
+			close(this->directory);
+		}
+#endif
+	}
+
+	npas4::ProcessTable Scan(const npas4::ScanOptions& x)
+	{
+		npas4::ProcessTable table;
+
+		if(this->directory < 0)
+		{
+			return table;
+		}
+
+		this->pids.clear();
+		npas4::impl::ListProcesses(this->directory, this->entries, this->pids);
+
+		this->rows.assign(this->pids.size(), npas4::impl::ScanRow());
+
+		for(size_t i = 0; i < this->pids.size(); ++i)
+		{
+			this->rows[i].Pid = this->pids[i];
+		}
+
+		this->smaps = x.Smaps == true || x.SortBy == npas4::ScanKey::ProportionalUsed || x.SortBy == npas4::ScanKey::UniqueUsed;
+
+		for(size_t i = 0; i < this->threadCount; ++i)
+		{
+			this->ranges[i].Next.store(this->rows.size() * i / this->threadCount, std::memory_order_relaxed);
+			this->ranges[i].End = this->rows.size() * (i + 1) / this->threadCount;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->pending = this->threadCount - 1;
+			++this->generation;
+		}
+
+		this->wake.notify_all();
+		this->Work(0);
+
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->done.wait(lock, [this]() { return this->pending == 0; });
+		}
+
+		return this->Collect(x);
+	}
+
+	const size_t threadCount;
+
+private:
+	void Run(size_t index)
+	{
+		uint64_t seen = 0;
+
+		for(;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->wake.wait(lock, [this, seen]() { return this->stopping == true || this->generation != seen; });
+
+				if(this->stopping == true)
+				{
+					return;
+				}
+
+				seen = this->generation;
+			}
+
+			this->Work(index);
+
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+
+				if(--this->pending == 0)
+				{
+					this->done.notify_all();
+				}
+			}
+		}
+	}
+
+	///
+	/// Drains this thread's own range, then steals from every other range in turn.
+	///
+	void Work(size_t index)
+	{
+		auto& worker = this->workers[index];
+
+		for(size_t i = 0; i < this->threadCount; ++i)
+		{
+			auto& range = this->ranges[(index + i) % this->threadCount];
+
+			for(;;)
+			{
+				const auto begin = range.Next.fetch_add(npas4::impl::ScanChunk, std::memory_order_relaxed);
+
+				if(begin >= range.End)
+				{
+					break;
+				}
+
+				const auto end = std::min(begin + npas4::impl::ScanChunk, range.End);
+
+				for(auto j = begin; j < end; ++j)
+				{
+					this->Read(worker, this->rows[j]);
+				}
+			}
+		}
+	}
+
+	void Read(npas4::impl::ScanWorker& worker, npas4::impl::ScanRow& x)
+	{
+		char name[48];
+		snprintf(name, sizeof(name), "%lld/statm", static_cast<long long>(x.Pid));
+
+		npas4::impl::StatmFields statm;
+
+		// A process that exits between being listed and being read is dropped.
+		if(worker.Statm.OpenAt(this->directory, name) == false || worker.Statm.Read() == false
+		   || npas4::impl::ParseStatm(worker.Statm.Data(), worker.Statm.Size(), this->pageSize, statm) == false)
+		{
+			worker.Statm.Close();
+			return;
+		}
+
+		worker.Statm.Close();
+
+		x.Physical = statm.Resident;
+		x.Virtual = statm.Size;
+		x.Valid = true;
+
+		if(this->smaps == true)
+		{
+			// smaps_rollup needs ptrace access, so other users' processes report zero rather than being dropped.
+			snprintf(name, sizeof(name), "%lld/smaps_rollup", static_cast<long long>(x.Pid));
+
+			if(worker.Smaps.OpenAt(this->directory, name) == true && worker.Smaps.Read() == true)
+			{
+				npas4::impl::SmapsSnapshot snapshot;
+				npas4::impl::ParseSmapsRollup(worker.Smaps.Data(), worker.Smaps.Size(), snapshot);
+				x.Proportional = snapshot.Pss;
+				x.Unique = snapshot.Uss;
+			}
+
+			worker.Smaps.Close();
+		}
+	}
+
+	npas4::ProcessTable Collect(const npas4::ScanOptions& x)
+	{
+		this->order.clear();
+
+		for(size_t i = 0; i < this->rows.size(); ++i)
+		{
+			if(this->rows[i].Valid == true)
+			{
+				this->order.push_back(static_cast<uint32_t>(i));
+			}
+		}
+
+		const auto key = x.SortBy;
+		const auto& rows = this->rows;
+		const auto larger = [&rows, key](uint32_t a, uint32_t b) {
+			const auto va = npas4::impl::ScanValue(rows[a], key);
+			const auto vb = npas4::impl::ScanValue(rows[b], key);
+			return (va != vb) ? va > vb : rows[a].Pid < rows[b].Pid;
+		};
+
+		const auto count = (x.Top > 0 && x.Top < this->order.size()) ? x.Top : this->order.size();
+		std::partial_sort(this->order.begin(), this->order.begin() + static_cast<std::ptrdiff_t>(count), this->order.end(), larger);
+
+		npas4::ProcessTable table;
+		table.Pid.reserve(count);
+		table.RamPhysicalUsed.reserve(count);
+		table.RamVirtualUsed.reserve(count);
+		table.RamProportionalUsed.reserve(count);
+		table.RamUniqueUsed.reserve(count);
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto& row = rows[this->order[i]];
+			table.Pid.push_back(row.Pid);
+			table.RamPhysicalUsed.push_back(row.Physical);
+			table.RamVirtualUsed.push_back(row.Virtual);
+			table.RamProportionalUsed.push_back(row.Proportional);
+			table.RamUniqueUsed.push_back(row.Unique);
+		}
+
+		return table;
+	}
+
+	npas4::impl::CacheAlignedArray<npas4::impl::ScanRange> ranges;
+	std::unique_ptr<npas4::impl::ScanWorker[]> workers;
+	const int64_t pageSize;
+	int directory{-1};
+
+	std::vector<char> entries;
+	std::vector<int64_t> pids;
+	std::vector<npas4::impl::ScanRow> rows;
+	std::vector<uint32_t> order;
+	bool smaps{false};
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	uint64_t generation{0};
+	size_t pending{0};
+	bool stopping{false};
+
+	std::vector<std::thread> threads;
+};
+
+size_t npas4::ProcessTable::Size() const
+{
+	return this->Pid.size();
+}
+
+npas4::ProcessScanner::ProcessScanner(size_t threads) : pimpl(new Impl(threads, "/proc"))
+{
+}
+
+npas4::ProcessScanner::ProcessScanner(size_t threads, const std::string& procRoot) : pimpl(new Impl(threads, procRoot))
+{
+}
+
+npas4::ProcessScanner::~ProcessScanner()
+{
+}
+
+size_t npas4::ProcessScanner::GetThreadCount() const
+{
+	return this->pimpl->threadCount;
+}
+
+npas4::ProcessTable npas4::ProcessScanner::Scan(const npas4::ScanOptions& x)
+{
+	return this->pimpl->Scan(x);
+}
@@ -0,0 +1,394 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include "ReadBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef WIN32
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#ifdef NPAS4_IO_URING
+#include <linux/io_uring.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+///
+/// References:
+/// https://kernel.dk/io_uring.pdf
+///
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// The result of a read that has not been performed yet.
+		///
+		constexpr int64_t Pending{-2};
+	} // namespace impl
+} // namespace npas4
+
+///
+/// The raw io_uring interface, without liburing.  The submission and completion queues are shared with the kernel through mmap(); this
+/// process is the only producer of submissions and the only consumer of completions.
+///
+struct npas4::impl::ReadBatch::Ring
+{
+#ifdef NPAS4_IO_URING
+	~Ring()
+	{
+		if(this->sqes != MAP_FAILED)
+		{
+			munmap(this->sqes, this->sqesSize);
+		}
+
+		if(this->cq != MAP_FAILED && this->cq != this->sq)
+		{
+			munmap(this->cq, this->cqSize);
+		}
+
+		if(this->sq != MAP_FAILED)
+		{
+			munmap(this->sq, this->sqSize);
+		}
+
+		if(this->fd >= 0)
+		{
+			close(this->fd);
+		}
+	}
+
+	bool Setup(unsigned x)
+	{
+		io_uring_params p;
+		memset(&p, 0, sizeof(p));
+
+		this->fd = static_cast<int>(syscall(__NR_io_uring_setup, x, &p));
+
+		if(this->fd < 0)
+		{
+			return false;
+		}
+
+		this->entries = p.sq_entries;
+		this->sqSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+		this->cqSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+
+		// Since 5.4 both rings share one mapping.
+		const auto single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+		if(single == true)
+		{
+			this->sqSize = this->cqSize = std::max(this->sqSize, this->cqSize);
+		}
+
+		this->sq = mmap(nullptr, this->sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQ_RING);
+
+		if(this->sq == MAP_FAILED)
+		{
+			return false;
+		}
+
+		this->cq = (single == true) ? this->sq
+									: mmap(nullptr, this->cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_CQ_RING);
+
+		if(this->cq == MAP_FAILED)
+		{
+			return false;
+		}
+
+		this->sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+		this->sqes = mmap(nullptr, this->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQES);
+
+		if(this->sqes == MAP_FAILED)
+		{
+			return false;
+		}
+
+		const auto sqBase = static_cast<char*>(this->sq);
+		const auto cqBase = static_cast<char*>(this->cq);
+
+		this->sqTail = reinterpret_cast<unsigned*>(sqBase + p.sq_off.tail);
+		this->sqMask = *reinterpret_cast<unsigned*>(sqBase + p.sq_off.ring_mask);
+		this->sqArray = reinterpret_cast<unsigned*>(sqBase + p.sq_off.array);
+		this->cqHead = reinterpret_cast<unsigned*>(cqBase + p.cq_off.head);
+		this->cqTail = reinterpret_cast<unsigned*>(cqBase + p.cq_off.tail);
+		this->cqMask = *reinterpret_cast<unsigned*>(cqBase + p.cq_off.ring_mask);
+		this->cqes = reinterpret_cast<io_uring_cqe*>(cqBase + p.cq_off.cqes);
+
+		this->vectors.resize(this->entries);
+		return true;
+	}
+
+	///
+	/// Records the result of every completed request.  Returns the number reaped.
+	///
+	unsigned Reap(std::vector<Request>& requests, unsigned& outstanding)
+	{
+		auto head = *this->cqHead;
+		const auto cqTailNow = __atomic_load_n(this->cqTail, __ATOMIC_ACQUIRE);
+		unsigned reaped = 0;
+
+		for(; head != cqTailNow; ++head)
+		{
+			const auto& cqe = this->cqes[head & this->cqMask];
+			requests[static_cast<size_t>(cqe.user_data)].Result = (cqe.res >= 0) ? cqe.res : -1;
+			++reaped;
+		}
+
+		__atomic_store_n(this->cqHead, head, __ATOMIC_RELEASE);
+		outstanding -= reaped;
+		return reaped;
+	}
+
+	///
+	/// Submits requests [first, last), no more than 'entries' of them, and waits for them all to complete.  Returns false if the ring
+	/// itself failed, leaving the requests that were never submitted Pending.  Nothing is left in flight either way, so the caller may read
+	/// into the same buffers, or tear the ring down, as soon as this returns.
+	///
+	bool Run(std::vector<Request>& requests, size_t first, size_t last)
+	{
+		auto tail = *this->sqTail;
+		unsigned queued = 0;
+
+		for(auto i = first; i < last; ++i)
+		{
+			auto& request = requests[i];
+
+			if(request.Fd < 0)
+			{
+				request.Result = -1;
+				continue;
+			}
+
+			const auto index = tail & this->sqMask;
+			auto& sqe = static_cast<io_uring_sqe*>(this->sqes)[index];
+			memset(&sqe, 0, sizeof(sqe));
+
+			// IORING_OP_READV rather than IORING_OP_READ, which needs 5.6.
+			this->vectors[queued].iov_base = request.Buffer;
+			this->vectors[queued].iov_len = request.Size;
+
+			sqe.opcode = IORING_OP_READV;
+			sqe.fd = request.Fd;
+			sqe.addr = reinterpret_cast<uint64_t>(&this->vectors[queued]);
+			sqe.len = 1;
+			sqe.off = 0;
+			sqe.user_data = i;
+
+			this->sqArray[index] = index;
+			++tail;
+			++queued;
+		}
+
+		__atomic_store_n(this->sqTail, tail, __ATOMIC_RELEASE);
+
+		auto unsubmitted = queued;
+		auto outstanding = queued;
+
+		while(outstanding > 0)
+		{
+			const auto submitted = syscall(__NR_io_uring_enter, this->fd, unsubmitted, outstanding, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+			if(submitted < 0)
+			{
+				const auto error = errno;
+
+				if(error == EINTR)
+				{
+					continue;
+				}
+
+				// The kernel is briefly short of memory for requests (EAGAIN), or the completion queue is full (EBUSY).  Reaping makes
+				// room; either way the ring still works.
+				if(error == EAGAIN || error == EBUSY)
+				{
+					if(this->Reap(requests, outstanding) == 0)
+					{
+						sched_yield();
+					}
+
+					continue;
+				}
+
+				// The ring was refused (e.g. by seccomp after setup succeeded).  Reads already submitted go on writing into the callers'
+				// buffers until they complete, so wait for them: their completions arrive without io_uring_enter(), as any system call runs
+				// the task work that posts them.
+				while(outstanding > unsubmitted)
+				{
+					if(this->Reap(requests, outstanding) == 0)
+					{
+						sched_yield();
+					}
+				}
+
+				return false;
+			}
+
+			unsubmitted -= std::min(unsubmitted, static_cast<unsigned>(submitted));
+			this->Reap(requests, outstanding);
+		}
+
+		return true;
+	}
+
+	int fd{-1};
+	unsigned entries{0};
+
+	void* sq{MAP_FAILED};
+	size_t sqSize{0};
+	void* cq{MAP_FAILED};
+	size_t cqSize{0};
+	void* sqes{MAP_FAILED};
+	size_t sqesSize{0};
+
+	unsigned* sqTail{nullptr};
+	unsigned sqMask{0};
+	unsigned* sqArray{nullptr};
+	unsigned* cqHead{nullptr};
+	unsigned* cqTail{nullptr};
+	unsigned cqMask{0};
+	io_uring_cqe* cqes{nullptr};
+
+	std::vector<iovec> vectors;
+#endif
+};
+
+npas4::impl::ReadBatch::ReadBatch(size_t capacity, Backend x)
+{
+	this->requests.reserve(capacity);
+
+#ifdef NPAS4_IO_URING
+	if(x == Backend::Automatic && capacity > 0)
+	{
+		this->ring.reset(new Ring());
+
+		if(this->ring->Setup(static_cast<unsigned>(std::min(capacity, size_t(4096)))) == false)
+		{
+			this->ring.reset();
+		}
+	}
+#else
+	(void)x;
+#endif
+}
+
+npas4::impl::ReadBatch::~ReadBatch()
+{
+}
+
+bool npas4::impl::ReadBatch::IsRing() const
+{
+	return this->ring != nullptr;
+}
+
+void npas4::impl::ReadBatch::Clear()
+{
+	this->requests.clear();
+}
+
+size_t npas4::impl::ReadBatch::Add(int fd, char* buffer, size_t size)
+{
+	Request x;
+	x.Fd = fd;
+	x.Buffer = buffer;
+	x.Size = size;
+	x.Result = npas4::impl::Pending;
+
+	this->requests.push_back(x);
+	return this->requests.size() - 1;
+}
+
+size_t npas4::impl::ReadBatch::Size() const
+{
+	return this->requests.size();
+}
+
+void npas4::impl::ReadBatch::Submit()
+{
+	for(auto& request : this->requests)
+	{
+		request.Result = npas4::impl::Pending;
+	}
+
+#ifdef NPAS4_IO_URING
+	if(this->ring != nullptr)
+	{
+		const size_t step = this->ring->entries;
+
+		for(size_t first = 0; first < this->requests.size(); first += step)
+		{
+			if(this->ring->Run(this->requests, first, std::min(first + step, this->requests.size())) == false)
+			{
+				// io_uring_enter() failed for good, with none of this batch's reads still in flight.  Finish with pread() from now on.
+				this->ring.reset();
+				this->SubmitPread(first);
+				return;
+			}
+		}
+
+		return;
+	}
+#endif
+
+	this->SubmitPread(0);
+}
+
+void npas4::impl::ReadBatch::SubmitPread(size_t first)
+{
+	for(auto i = first; i < this->requests.size(); ++i)
+	{
+		auto& request = this->requests[i];
+
+		if(request.Result != npas4::impl::Pending)
+		{
+			continue;
+		}
+
+#ifdef WIN32
+		request.Result = -1;
+#else
+		if(request.Fd < 0)
+		{
+			request.Result = -1;
+			continue;
+		}
+
+		ssize_t bytes;
+
+		do
+		{
+			bytes = pread(request.Fd, request.Buffer, request.Size, 0);
+		} while(bytes < 0 && errno == EINTR);
+
+		request.Result = (bytes >= 0) ? static_cast<int64_t>(bytes) : -1;
+#endif
+	}
+}
+
+int64_t npas4::impl::ReadBatch::Result(size_t i) const
+{
+	return (i < this->requests.size() && this->requests[i].Result >= 0) ? this->requests[i].Result : -1;
+}
@@ -0,0 +1,113 @@
+#ifndef H_NPAS4_READBATCH_H
+#define H_NPAS4_READBATCH_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// \class ReadBatch
+		///
+		/// A set of reads from offset zero of already open descriptors, issued together.
+		///
+		/// When built with NPAS4_IO_URING and the kernel allows it, Submit() places every read on an io_uring submission queue and waits for
+		/// all of them with a single io_uring_enter(), so a snapshot of N files costs one system call rather than N.  Otherwise (io_uring
+		/// missing, disabled by sysctl, or blocked by seccomp) each read is a pread(), exactly as ProcFile::Read() would issue it.
+		///
+		/// procfs and cgroupfs do not support non-blocking reads, so io_uring completes each read on one of its kernel worker threads.  That
+		/// trades N system calls for N worker wake-ups, which only pays off where system calls are expensive relative to scheduling (e.g. with
+		/// heavy speculative execution mitigations) and spare cores are available.  Hence NPAS4_ENABLE_IO_URING is off by default.
+		///
+		/// A ReadBatch is not thread safe.  Buffers passed to Add() must stay valid until Submit() returns.
+		///
+		class ReadBatch
+		{
+		public:
+			enum class Backend : int
+			{
+				///
+				/// io_uring when available, otherwise pread().
+				///
+				Automatic,
+				Pread
+			};
+
+			///
+			/// 'capacity' is the size of the io_uring queues.  Batches larger than this are submitted in several rounds.
+			///
+			explicit ReadBatch(size_t capacity, Backend x = Backend::Automatic);
+			~ReadBatch();
+
+			ReadBatch(const ReadBatch&) = delete;
+			ReadBatch& operator=(const ReadBatch&) = delete;
+
+			///
+			/// True if reads are submitted through io_uring.
+			///
+			bool IsRing() const;
+
+			///
+			/// Removes every read, keeping the allocated storage.
+			///
+			void Clear();
+
+			///
+			/// Queues a read of up to 'size' bytes from offset zero of 'fd'.  Returns the index of the read's result.  A negative 'fd' is
+			/// accepted and fails.
+			///
+			size_t Add(int fd, char* buffer, size_t size);
+
+			size_t Size() const;
+
+			///
+			/// Performs every queued read.
+			///
+			void Submit();
+
+			///
+			/// The number of bytes read by read 'i', or -1 if it failed.
+			///
+			int64_t Result(size_t i) const;
+
+		private:
+			struct Request
+			{
+				int Fd;
+				char* Buffer;
+				size_t Size;
+				int64_t Result;
+			};
+
+			void SubmitPread(size_t first);
+
+			struct Ring;
+			std::unique_ptr<Ring> ring;
+			std::vector<Request> requests;
+		};
+	} // namespace impl
+} // namespace npas4
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef H_NPAS4_RINGBUFFER_H
+#define H_NPAS4_RINGBUFFER_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// \class SeqLock
+		///
+		/// Single writer, multiple reader storage for a trivially copyable value.  Readers never block the writer and never take a lock; a read
+		/// that overlaps a write is detected by the sequence number and retried.
+		///
+		/// The value is stored as relaxed atomic words rather than raw bytes so that concurrent reads and writes are not data races under the
+		/// C++ memory model.
+		///
+		template <typename T>
+		class SeqLock
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type.");
+
+		public:
+			static constexpr size_t WordCount{(sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t)};
+
+			SeqLock()
+			{
+				for(auto& word : this->words)
+				{
+					word.store(0, std::memory_order_relaxed);
+				}
+			}
+
+			///
+			/// Only one thread may call Store() at a time.
+			///
+			void Store(const T& x)
+			{
+				uint64_t buffer[WordCount] = {};
+				memcpy(buffer, &x, sizeof(T));
+
+				const auto sequence = this->sequence.load(std::memory_order_relaxed);
+				this->sequence.store(sequence + 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+
+				for(size_t i = 0; i < WordCount; ++i)
+				{
+					this->words[i].store(buffer[i], std::memory_order_relaxed);
+				}
+
+				this->sequence.store(sequence + 2, std::memory_order_release);
+			}
+
+			///
+			/// Returns false if a write was in progress.  'x' is only modified on success.
+			///
+			bool TryLoad(T& x) const
+			{
+				const auto before = this->sequence.load(std::memory_order_acquire);
+
+				if((before & 1) != 0)
+				{
+					return false;
+				}
+
+				uint64_t buffer[WordCount];
+
+				for(size_t i = 0; i < WordCount; ++i)
+				{
+					buffer[i] = this->words[i].load(std::memory_order_relaxed);
+				}
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if(this->sequence.load(std::memory_order_relaxed) != before)
+				{
+					return false;
+				}
+
+				memcpy(&x, buffer, sizeof(T));
+				return true;
+			}
+
+			void Load(T& x) const
+			{
+				while(this->TryLoad(x) == false)
+				{
+				}
+			}
+
+		private:
+			std::atomic<uint64_t> sequence{0};
+			std::atomic<uint64_t> words[WordCount];
+		};
+
+		///
+		/// \class RingBuffer
+		///
+		/// A single producer, multiple consumer ring of the most recent N values.  Push() and every reader are lock free.  Readers that are
+		/// lapped by the producer simply see fewer (but never torn or reordered) values.
+		///
+		template <typename T, size_t N>
+		class RingBuffer
+		{
+			static_assert(N > 0, "RingBuffer requires a non-zero capacity.");
+
+		public:
+			///
+			/// Only one thread may call Push() at a time.
+			///
+			void Push(const T& x)
+			{
+				const auto count = this->count.load(std::memory_order_relaxed);
+
+				Entry entry;
+				entry.Index = count;
+				entry.Value = x;
+				this->slots[count % N].Store(entry);
+
+				this->count.store(count + 1, std::memory_order_release);
+			}
+
+			///
+			/// The number of values ever pushed.
+			///
+			uint64_t Count() const
+			{
+				return this->count.load(std::memory_order_acquire);
+			}
+
+			///
+			/// Copies the most recently pushed value.  Returns false if nothing has been pushed.
+			///
+			bool Latest(T& x) const
+			{
+				Entry entry;
+
+				for(;;)
+				{
+					const auto count = this->count.load(std::memory_order_acquire);
+
+					if(count == 0)
+					{
+						return false;
+					}
+
+					// If the producer lapped us the slot holds a newer value, which is still the latest.
+					if(this->slots[(count - 1) % N].TryLoad(entry) == true)
+					{
+						x = entry.Value;
+						return true;
+					}
+				}
+			}
+
+			///
+			/// Copies up to 'n' of the most recent values, newest first.  Returns the number copied.
+			///
+			size_t Recent(T* x, size_t n) const
+			{
+				const auto count = this->count.load(std::memory_order_acquire);
+				const auto available = static_cast<size_t>((count < N) ? count : N);
+				const auto wanted = (n < available) ? n : available;
+				size_t copied = 0;
+				Entry entry;
+
+				for(size_t i = 0; i < wanted; ++i)
+				{
+					const auto index = count - 1 - i;
+					this->slots[index % N].Load(entry);
+
+					// The producer has overwritten this slot (and therefore every older one) since we started.
+					if(entry.Index != index)
+					{
+						break;
+					}
+
+					x[copied++] = entry.Value;
+				}
+
+				return copied;
+			}
+
+		private:
+			struct Entry
+			{
+				uint64_t Index;
+				T Value;
+			};
+
+			std::atomic<uint64_t> count{0};
+			SeqLock<Entry> slots[N];
+		};
+	} // namespace impl
+} // namespace npas4
+
+#endif
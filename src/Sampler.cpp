@@ -0,0 +1,280 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Sampler.h>
+#include <npas4/SnapshotReader.h>
+
+#include "RingBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+constexpr size_t npas4::Sampler::Capacity;
+
+class npas4::Sampler::Impl
+{
+public:
+	explicit Impl(std::chrono::nanoseconds x) : interval(x < std::chrono::microseconds(1) ? std::chrono::microseconds(1) : x)
+	{
+#if defined(__linux__)
+		this->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		this->stopFd = eventfd(0, EFD_CLOEXEC);
+
+		if(this->timerFd >= 0 && this->stopFd >= 0)
+		{
+			const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(this->interval);
+
+			struct itimerspec spec;
+			spec.it_interval.tv_sec = static_cast<time_t>(seconds.count());
+			spec.it_interval.tv_nsec = static_cast<long>((this->interval - seconds).count());
+			spec.it_value = spec.it_interval;
+
+			if(timerfd_settime(this->timerFd, 0, &spec, nullptr) != 0)
+			{
+				this->CloseDescriptors();
+			}
+		}
+		else
+		{
+			this->CloseDescriptors();
+		}
+#endif
+
+		this->TakeSample();
+		this->thread = std::thread([this]() { this->Run(); });
+	}
+
+	~Impl()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+
+		this->wake.notify_all();
+
+#if defined(__linux__)
+		if(this->stopFd >= 0)
+		{
+			const uint64_t one = 1;
+			const auto written = write(this->stopFd, &one, sizeof(one));
+			(void)written;
+		}
+#endif
+
+		this->thread.join();
+
+#if defined(__linux__)
+		this->CloseDescriptors();
+#endif
+	}
+
+	void TakeSample()
+	{
+		npas4::Sample x;
+		x.Report = this->reader.GetRAMReport();
+		x.Usage = this->reader.GetUsageReport();
+		x.Time = std::chrono::steady_clock::now();
+		this->samples.Push(x);
+
+		const auto physical = x.Report.RamPhysicalUsedByCurrentProcess;
+		auto peak = this->peak.load(std::memory_order_relaxed);
+
+		while(physical > peak && this->peak.compare_exchange_weak(peak, physical, std::memory_order_relaxed) == false)
+		{
+		}
+	}
+
+	void Run()
+	{
+		auto next = std::chrono::steady_clock::now();
+
+		while(this->WaitForTick(next) == true)
+		{
+			this->TakeSample();
+		}
+	}
+
+	///
+	/// Blocks until the next sampling period.  Returns false when the sampler is stopping.
+	///
+	bool WaitForTick(std::chrono::steady_clock::time_point& next)
+	{
+#if defined(__linux__)
+		if(this->timerFd >= 0)
+		{
+			struct pollfd fds[2];
+			fds[0].fd = this->timerFd;
+			fds[0].events = POLLIN;
+			fds[1].fd = this->stopFd;
+			fds[1].events = POLLIN;
+
+			for(;;)
+			{
+				fds[0].revents = 0;
+				fds[1].revents = 0;
+
+				if(poll(fds, 2, -1) < 0)
+				{
+					if(errno == EINTR)
+					{
+						continue;
+					}
+
+					// Any other error would recur at once.  Rather than spin, sample on the condition variable from now on.
+					close(this->timerFd);
+					this->timerFd = -1;
+					next = std::chrono::steady_clock::now();
+					break;
+				}
+
+				if(fds[1].revents != 0)
+				{
+					return false;
+				}
+
+				if(fds[0].revents != 0)
+				{
+					// The expiration count is discarded.  Missed periods are not made up.
+					uint64_t expirations = 0;
+					const auto bytes = read(this->timerFd, &expirations, sizeof(expirations));
+					(void)bytes;
+					return true;
+				}
+			}
+		}
+#endif
+
+		next += this->interval;
+
+		std::unique_lock<std::mutex> lock(this->mutex);
+		return this->wake.wait_until(lock, next, [this]() { return this->stopping; }) == false;
+	}
+
+#if defined(__linux__)
+	void CloseDescriptors()
+	{
+		if(this->timerFd >= 0)
+		{
+			close(this->timerFd);
+		}
+
+		if(this->stopFd >= 0)
+		{
+			close(this->stopFd);
+		}
+
+		this->timerFd = -1;
+		this->stopFd = -1;
+	}
+
+	int timerFd{-1};
+	int stopFd{-1};
+#endif
+
+	npas4::SnapshotReader reader;
+	npas4::impl::RingBuffer<npas4::Sample, npas4::Sampler::Capacity> samples;
+	const std::chrono::nanoseconds interval;
+	std::atomic<int64_t> peak{0};
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping{false};
+
+	std::thread thread;
+};
+
+npas4::Sampler::Sampler(std::chrono::nanoseconds interval) : pimpl(new Impl(interval))
+{
+}
+
+npas4::Sampler::~Sampler()
+{
+}
+
+npas4::Sample npas4::Sampler::GetLatest() const
+{
+	npas4::Sample x;
+	this->pimpl->samples.Latest(x);
+	return x;
+}
+
+size_t npas4::Sampler::GetHistory(npas4::Sample* x, size_t count) const
+{
+	return this->pimpl->samples.Recent(x, count);
+}
+
+npas4::UsageRates npas4::Sampler::GetRates(size_t intervals) const
+{
+	npas4::UsageRates x;
+
+	std::vector<npas4::Sample> history(std::min(intervals, npas4::Sampler::Capacity - 1) + 1);
+	const auto copied = this->GetHistory(history.data(), history.size());
+
+	if(copied < 2)
+	{
+		return x;
+	}
+
+	const auto& newest = history.front();
+	const auto& oldest = history[copied - 1];
+	const auto seconds = std::chrono::duration<double>(newest.Time - oldest.Time).count();
+
+	if(seconds <= 0.0)
+	{
+		return x;
+	}
+
+	x.MinorFaults = static_cast<double>(newest.Usage.MinorFaults - oldest.Usage.MinorFaults) / seconds;
+	x.MajorFaults = static_cast<double>(newest.Usage.MajorFaults - oldest.Usage.MajorFaults) / seconds;
+	x.VoluntaryContextSwitches = static_cast<double>(newest.Usage.VoluntaryContextSwitches - oldest.Usage.VoluntaryContextSwitches) / seconds;
+	x.InvoluntaryContextSwitches = static_cast<double>(newest.Usage.InvoluntaryContextSwitches - oldest.Usage.InvoluntaryContextSwitches) / seconds;
+	return x;
+}
+
+uint64_t npas4::Sampler::GetSampleCount() const
+{
+	return this->pimpl->samples.Count();
+}
+
+std::chrono::nanoseconds npas4::Sampler::GetInterval() const
+{
+	return this->pimpl->interval;
+}
+
+int64_t npas4::Sampler::GetPeak() const
+{
+	return this->pimpl->peak.load(std::memory_order_relaxed);
+}
+
+void npas4::Sampler::ResetPeak()
+{
+	this->pimpl->peak.store(this->GetLatest().Report.RamPhysicalUsedByCurrentProcess, std::memory_order_relaxed);
+}
@@ -0,0 +1,216 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Peak.h>
+#include <npas4/ScopedMeasurement.h>
+
+#include "ProcFile.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// The number of empty measurements the overhead is calibrated over.
+		///
+		constexpr int CalibrationRuns{8};
+
+		struct MeasurementPoint
+		{
+			npas4::impl::ProcessSnapshot Process;
+			npas4::impl::FaultSnapshot Faults;
+			std::chrono::steady_clock::time_point Time;
+		};
+	} // namespace impl
+} // namespace npas4
+
+class npas4::ScopedMeasurement::Impl
+{
+public:
+	Impl(npas4::MeasurementReport* x, bool measurePeak) : output(x)
+	{
+#ifndef WIN32
+		this->status.Open("/proc/self/status");
+#endif
+
+		// Warm up, so that the reads below touch nothing new.
+		this->Read(this->start);
+
+		if(measurePeak == true)
+		{
+			this->peak.reset(new npas4::ScopedPeak());
+		}
+
+		this->Read(this->start);
+	}
+
+	void Read(npas4::impl::MeasurementPoint& x)
+	{
+		if(this->status.Read() == false || npas4::impl::ParseStatus(this->status.Data(), this->status.Size(), x.Process) == false)
+		{
+			npas4::impl::ReadProcessSnapshot(x.Process);
+		}
+
+		npas4::impl::ReadFaultSnapshot(x.Faults);
+		x.Time = std::chrono::steady_clock::now();
+	}
+
+	///
+	/// The raw change since the start, without compensation.
+	///
+	npas4::MeasurementReport Measure()
+	{
+		npas4::impl::MeasurementPoint end;
+		this->Read(end);
+
+		const auto peak = (this->peak != nullptr) ? this->peak->GetPeak() : std::max(this->start.Process.Physical, end.Process.Physical);
+
+		npas4::MeasurementReport x;
+		x.RamPhysicalUsed = end.Process.Physical - this->start.Process.Physical;
+		x.RamVirtualUsed = end.Process.Virtual - this->start.Process.Virtual;
+		x.RamPhysicalUsedPeak = std::max(int64_t(0), peak - this->start.Process.Physical);
+		x.MinorFaults = end.Faults.Minor - this->start.Faults.Minor;
+		x.MajorFaults = end.Faults.Major - this->start.Faults.Major;
+		x.Elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end.Time - this->start.Time);
+		return x;
+	}
+
+	npas4::impl::ProcFile status;
+	npas4::impl::MeasurementPoint start;
+	std::unique_ptr<npas4::ScopedPeak> peak;
+	npas4::MeasurementReport* output{nullptr};
+	npas4::MeasurementReport result;
+	bool stopped{false};
+};
+
+npas4::MeasurementReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Physical Used:                     " << this->RamPhysicalUsed << std::endl;
+	ss << "Virtual Used:                      " << this->RamVirtualUsed << std::endl;
+	ss << "Physical UsedPeak:                 " << this->RamPhysicalUsedPeak << std::endl;
+	ss << "Minor Faults:                      " << this->MinorFaults << std::endl;
+	ss << "Major Faults:                      " << this->MajorFaults << std::endl;
+	ss << "Elapsed (ns):                      " << this->Elapsed.count() << std::endl;
+
+	return ss.str();
+}
+
+npas4::MeasurementReport npas4::MeasurementReport::operator-(const MeasurementReport& x)
+{
+	npas4::MeasurementReport r;
+	r.RamPhysicalUsed = this->RamPhysicalUsed - x.RamPhysicalUsed;
+	r.RamVirtualUsed = this->RamVirtualUsed - x.RamVirtualUsed;
+	r.RamPhysicalUsedPeak = this->RamPhysicalUsedPeak - x.RamPhysicalUsedPeak;
+	r.MinorFaults = this->MinorFaults - x.MinorFaults;
+	r.MajorFaults = this->MajorFaults - x.MajorFaults;
+	r.Elapsed = this->Elapsed - x.Elapsed;
+
+	return r;
+}
+
+npas4::ScopedMeasurement::ScopedMeasurement()
+{
+	// Calibrate before starting, so that the calibration is not part of the first measurement.
+	npas4::ScopedMeasurement::GetOverhead();
+	this->pimpl.reset(new Impl(nullptr, true));
+}
+
+npas4::ScopedMeasurement::ScopedMeasurement(npas4::MeasurementReport& x)
+{
+	npas4::ScopedMeasurement::GetOverhead();
+	this->pimpl.reset(new Impl(&x, true));
+}
+
+npas4::ScopedMeasurement::~ScopedMeasurement()
+{
+	this->Stop();
+}
+
+npas4::MeasurementReport npas4::ScopedMeasurement::Stop()
+{
+	auto& impl = *this->pimpl;
+
+	if(impl.stopped == false)
+	{
+		const auto overhead = npas4::ScopedMeasurement::GetOverhead();
+
+		impl.result = impl.Measure() - overhead;
+		impl.result.RamPhysicalUsedPeak = std::max(int64_t(0), impl.result.RamPhysicalUsedPeak);
+		impl.result.Elapsed = std::max(std::chrono::nanoseconds(0), impl.result.Elapsed);
+		impl.stopped = true;
+
+		if(impl.output != nullptr)
+		{
+			*impl.output = impl.result;
+		}
+	}
+
+	return impl.result;
+}
+
+bool npas4::ScopedMeasurement::IsStopped() const
+{
+	return this->pimpl->stopped;
+}
+
+npas4::MeasurementReport npas4::ScopedMeasurement::GetOverhead()
+{
+	static npas4::MeasurementReport overhead;
+	static std::once_flag once;
+
+	std::call_once(once, []() {
+		npas4::MeasurementReport x;
+
+		for(int i = 0; i < npas4::impl::CalibrationRuns; ++i)
+		{
+			// The peak is left out: resetting the kernel's peak here would reset it for every ScopedPeak already running.
+			Impl empty(nullptr, false);
+			const auto run = empty.Measure();
+
+			if(i == 0)
+			{
+				x = run;
+				continue;
+			}
+
+			x.RamPhysicalUsed = std::min(x.RamPhysicalUsed, run.RamPhysicalUsed);
+			x.RamVirtualUsed = std::min(x.RamVirtualUsed, run.RamVirtualUsed);
+			x.RamPhysicalUsedPeak = std::min(x.RamPhysicalUsedPeak, run.RamPhysicalUsedPeak);
+			x.MinorFaults = std::min(x.MinorFaults, run.MinorFaults);
+			x.MajorFaults = std::min(x.MajorFaults, run.MajorFaults);
+			x.Elapsed = std::min(x.Elapsed, run.Elapsed);
+		}
+
+		// Memory released by other threads during calibration must not become a negative overhead.
+		x.RamPhysicalUsed = std::max(int64_t(0), x.RamPhysicalUsed);
+		x.RamVirtualUsed = std::max(int64_t(0), x.RamVirtualUsed);
+		x.RamPhysicalUsedPeak = std::max(int64_t(0), x.RamPhysicalUsedPeak);
+		x.MinorFaults = std::max(int64_t(0), x.MinorFaults);
+		x.MajorFaults = std::max(int64_t(0), x.MajorFaults);
+		overhead = x;
+	});
+
+	return overhead;
+}
@@ -0,0 +1,710 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include "Snapshot.h"
+
+#include "CgroupFiles.h"
+#include "ProcFile.h"
+#include "ProcParser.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef WIN32
+#include <Psapi.h>
+#include <Windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/sysinfo.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#if defined(__APPLE__) && defined(__MACH__)
+#include <mach/mach.h>
+#endif
+#endif
+
+bool npas4::impl::ReadSystemSnapshot(npas4::impl::SystemSnapshot& x)
+{
+	x = SystemSnapshot();
+
+#ifdef WIN32
+	MEMORYSTATUSEX memInfo;
+	memInfo.dwLength = sizeof(MEMORYSTATUSEX);
+
+	if(GlobalMemoryStatusEx(&memInfo) == FALSE)
+	{
+		return false;
+	}
+
+	x.SystemTotal = static_cast<int64_t>(memInfo.ullTotalPhys) + static_cast<int64_t>(memInfo.ullTotalVirtual);
+	x.SystemAvailable = static_cast<int64_t>(memInfo.ullAvailPhys) + static_cast<int64_t>(memInfo.ullAvailVirtual);
+	x.PhysicalTotal = static_cast<int64_t>(memInfo.ullTotalPhys);
+	x.PhysicalAvailable = static_cast<int64_t>(memInfo.ullAvailPhys);
+	x.VirtualTotal = static_cast<int64_t>(memInfo.ullTotalPageFile);
+	x.VirtualAvailable = static_cast<int64_t>(memInfo.ullTotalPageFile);
+	return true;
+#else
+	npas4::MeminfoReport meminfo;
+
+	if(npas4::impl::ReadMeminfo(meminfo) == true)
+	{
+		npas4::impl::FillSystemSnapshot(meminfo, x);
+		return true;
+	}
+
+	// sysinfo() only reports MemFree, which ignores reclaimable page cache, so it is a fallback for systems without procfs mounted.
+	// Prefer sysctl() over sysconf() except sysctl() HW_REALMEM and HW_PHYSMEM
+	// return static_cast<int64_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<int64_t>(sysconf(_SC_PAGE_SIZE));
+	struct sysinfo memInfo;
+
+	if(sysinfo(&memInfo) != 0)
+	{
+		return false;
+	}
+
+	const auto unit = static_cast<int64_t>(memInfo.mem_unit);
+	const auto totalRam = static_cast<int64_t>(memInfo.totalram) * unit;
+	const auto freeRam = static_cast<int64_t>(memInfo.freeram) * unit;
+	const auto totalSwap = static_cast<int64_t>(memInfo.totalswap) * unit;
+	const auto freeSwap = static_cast<int64_t>(memInfo.freeswap) * unit;
+	const auto totalHigh = static_cast<int64_t>(memInfo.totalhigh) * unit;
+	const auto freeHigh = static_cast<int64_t>(memInfo.freehigh) * unit;
+
+	x.SystemTotal = totalRam + totalSwap + totalHigh;
+	x.SystemAvailable = freeRam + freeSwap + freeHigh;
+	x.PhysicalTotal = totalRam;
+	x.PhysicalAvailable = freeRam;
+	x.VirtualTotal = totalSwap;
+	x.VirtualAvailable = freeSwap;
+	return true;
+#endif
+}
+
+bool npas4::impl::ReadProcessSnapshot(npas4::impl::ProcessSnapshot& x)
+{
+	x = ProcessSnapshot();
+
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS_EX pmc;
+
+	if(GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc)) == FALSE)
+	{
+		return false;
+	}
+
+	x.Physical = static_cast<int64_t>(pmc.WorkingSetSize);
+	x.PhysicalPeak = static_cast<int64_t>(pmc.PeakWorkingSetSize);
+	x.Virtual = static_cast<int64_t>(pmc.PrivateUsage);
+	return true;
+#elif defined(__APPLE__) && defined(__MACH__)
+	mach_task_basic_info info;
+	mach_msg_type_number_t infoCount = MACH_TASK_BASIC_INFO_COUNT;
+
+	if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &infoCount) != KERN_SUCCESS)
+	{
+		return false;
+	}
+
+	struct rusage rusage;
+	getrusage(RUSAGE_SELF, &rusage);
+
+	x.Physical = static_cast<int64_t>(info.resident_size);
+	x.PhysicalPeak = static_cast<int64_t>(rusage.ru_maxrss);
+	x.Virtual = static_cast<int64_t>(info.virtual_size);
+	return true;
+#else
+	npas4::impl::ProcFile file("/proc/self/status");
+
+	if(file.Read() == false)
+	{
+		return false;
+	}
+
+	npas4::impl::ParseStatus(file.Data(), file.Size(), x);
+	return true;
+#endif
+}
+
+bool npas4::impl::ReadFaultSnapshot(npas4::impl::FaultSnapshot& x)
+{
+	x = FaultSnapshot();
+
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) == FALSE)
+	{
+		return false;
+	}
+
+	x.Minor = static_cast<int64_t>(pmc.PageFaultCount);
+	return true;
+#else
+	struct rusage rusage;
+
+	if(getrusage(RUSAGE_SELF, &rusage) != 0)
+	{
+		return false;
+	}
+
+	x.Minor = static_cast<int64_t>(rusage.ru_minflt);
+	x.Major = static_cast<int64_t>(rusage.ru_majflt);
+	return true;
+#endif
+}
+
+bool npas4::impl::ReadProcessSnapshot(int64_t pid, npas4::impl::ProcessSnapshot& x)
+{
+	x = ProcessSnapshot();
+
+#ifdef WIN32
+	const auto process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+
+	if(process == nullptr)
+	{
+		return false;
+	}
+
+	PROCESS_MEMORY_COUNTERS_EX pmc;
+	DWORD exitCode = 0;
+	const auto ok = GetExitCodeProcess(process, &exitCode) != FALSE && exitCode == STILL_ACTIVE
+					&& GetProcessMemoryInfo(process, reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc)) != FALSE;
+	CloseHandle(process);
+
+	if(ok == false)
+	{
+		return false;
+	}
+
+	x.Physical = static_cast<int64_t>(pmc.WorkingSetSize);
+	x.PhysicalPeak = static_cast<int64_t>(pmc.PeakWorkingSetSize);
+	x.Virtual = static_cast<int64_t>(pmc.PrivateUsage);
+	return true;
+#elif defined(__APPLE__) && defined(__MACH__)
+	return pid == static_cast<int64_t>(getpid()) && npas4::impl::ReadProcessSnapshot(x);
+#else
+	char path[48];
+	snprintf(path, sizeof(path), "/proc/%lld/status", static_cast<long long>(pid));
+
+	npas4::impl::ProcFile file(path);
+	return file.Read() == true && npas4::impl::ParseStatus(file.Data(), file.Size(), x);
+#endif
+}
+
+void npas4::impl::ProcDirectory(int64_t pid, char (&x)[32])
+{
+	snprintf(x, sizeof(x), "/proc/%lld", static_cast<long long>(pid));
+}
+
+void npas4::impl::ParseMeminfo(const char* data, size_t size, npas4::MeminfoReport& x)
+{
+	npas4::impl::MeminfoFields fields;
+
+	// MemAvailable is absent before Linux 3.14.  A real value is never negative.
+	fields.MemAvailable = -1;
+	npas4::impl::ParseKeyValues(data, size, fields);
+
+	x.MemTotal = fields.MemTotal;
+	x.MemFree = fields.MemFree;
+	x.Buffers = fields.Buffers;
+	x.Cached = fields.Cached;
+	x.SwapCached = fields.SwapCached;
+	x.SReclaimable = fields.SReclaimable;
+	x.Shmem = fields.Shmem;
+	x.Dirty = fields.Dirty;
+	x.Writeback = fields.Writeback;
+	x.SwapTotal = fields.SwapTotal;
+	x.SwapFree = fields.SwapFree;
+
+	if(fields.MemAvailable >= 0)
+	{
+		x.MemAvailable = fields.MemAvailable;
+	}
+	else
+	{
+		const auto estimate = fields.MemFree + fields.Buffers + fields.Cached + fields.SReclaimable - fields.Shmem;
+		x.MemAvailable = (estimate > fields.MemFree) ? estimate : fields.MemFree;
+	}
+}
+
+void npas4::impl::ParseMeminfo(const char* data, size_t size, npas4::impl::SystemSnapshot& x)
+{
+	npas4::MeminfoReport meminfo;
+	npas4::impl::ParseMeminfo(data, size, meminfo);
+	npas4::impl::FillSystemSnapshot(meminfo, x);
+}
+
+void npas4::impl::FillSystemSnapshot(const npas4::MeminfoReport& x, npas4::impl::SystemSnapshot& s)
+{
+	s.SystemTotal = x.MemTotal + x.SwapTotal;
+	s.SystemAvailable = x.MemAvailable + x.SwapFree;
+	s.PhysicalTotal = x.MemTotal;
+	s.PhysicalAvailable = x.MemAvailable;
+	s.VirtualTotal = x.SwapTotal;
+	s.VirtualAvailable = x.SwapFree;
+}
+
+bool npas4::impl::ReadMeminfo(npas4::MeminfoReport& x)
+{
+	x = npas4::MeminfoReport();
+
+#ifdef WIN32
+	return false;
+#else
+	npas4::impl::ProcFile file("/proc/meminfo");
+
+	if(file.Read() == false)
+	{
+		return false;
+	}
+
+	npas4::impl::ParseMeminfo(file.Data(), file.Size(), x);
+	return true;
+#endif
+}
+
+bool npas4::impl::ParseStatus(const char* data, size_t size, npas4::impl::ProcessSnapshot& x)
+{
+	npas4::impl::StatusFields fields;
+	const auto stored = npas4::impl::ParseKeyValues(data, size, fields);
+
+	x.Physical = fields.VmRSS;
+	x.PhysicalPeak = fields.VmHWM;
+	x.Virtual = fields.VmSize;
+	return stored > 0;
+}
+
+bool npas4::impl::ParseStatm(const char* data, size_t size, int64_t pageSize, npas4::impl::StatmFields& x)
+{
+	// "size resident shared text lib data dt", all in pages.
+	constexpr int FieldCount{6};
+	const auto end = data + size;
+	auto p = data;
+	int64_t pages[FieldCount];
+
+	for(int i = 0; i < FieldCount; ++i)
+	{
+		const auto start = p;
+		pages[i] = npas4::impl::ParseInt64(p, end);
+
+		if(p == start || (i + 1 < FieldCount && (p == end || *p++ != ' ')))
+		{
+			return false;
+		}
+	}
+
+	x.Size = pages[0] * pageSize;
+	x.Resident = pages[1] * pageSize;
+	x.Shared = pages[2] * pageSize;
+	x.Text = pages[3] * pageSize;
+	x.Data = pages[5] * pageSize;
+	return true;
+}
+
+bool npas4::impl::ReadStatm(npas4::impl::StatmFields& x)
+{
+	x = StatmFields();
+
+#ifdef WIN32
+	return false;
+#else
+	npas4::impl::ProcFile file("/proc/self/statm");
+	return file.Read() == true && npas4::impl::ParseStatm(file.Data(), file.Size(), npas4::impl::PageSize(), x);
+#endif
+}
+
+bool npas4::impl::ReadStatm(int64_t pid, npas4::impl::StatmFields& x)
+{
+	x = StatmFields();
+
+#ifdef WIN32
+	(void)pid;
+	return false;
+#else
+	char path[48];
+	snprintf(path, sizeof(path), "/proc/%lld/statm", static_cast<long long>(pid));
+
+	npas4::impl::ProcFile file(path);
+	return file.Read() == true && npas4::impl::ParseStatm(file.Data(), file.Size(), npas4::impl::PageSize(), x);
+#endif
+}
+
+bool npas4::impl::ParseStat(const char* data, size_t size, npas4::impl::StatFields& x)
+{
+	x = StatFields();
+
+	// "pid (comm) state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt ..."
+	auto p = data + size;
+
+	while(p > data && *(p - 1) != ')')
+	{
+		--p;
+	}
+
+	if(p == data)
+	{
+		return false;
+	}
+
+	const auto end = data + size;
+
+	// Skip state, ppid, pgrp, session, tty_nr, tpgid, and flags.
+	for(int skip = 0; skip < 7; ++skip)
+	{
+		while(p < end && *p == ' ')
+		{
+			++p;
+		}
+
+		while(p < end && *p != ' ')
+		{
+			++p;
+		}
+	}
+
+	int64_t* fields[] = {&x.MinorFaults, &x.ChildMinorFaults, &x.MajorFaults, &x.ChildMajorFaults};
+
+	for(auto field : fields)
+	{
+		if(p == end || *p++ != ' ')
+		{
+			return false;
+		}
+
+		const auto start = p;
+		*field = npas4::impl::ParseInt64(p, end);
+
+		if(p == start)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool npas4::impl::ReadStat(npas4::impl::StatFields& x)
+{
+	x = StatFields();
+
+#ifdef WIN32
+	return false;
+#else
+	npas4::impl::ProcFile file("/proc/self/stat");
+	return file.Read() == true && npas4::impl::ParseStat(file.Data(), file.Size(), x);
+#endif
+}
+
+bool npas4::impl::ReadUsageSnapshot(npas4::UsageScope scope, npas4::UsageReport& x)
+{
+	x = npas4::UsageReport();
+
+#ifdef WIN32
+	(void)scope;
+
+	PROCESS_MEMORY_COUNTERS pmc;
+
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) == FALSE)
+	{
+		return false;
+	}
+
+	x.MinorFaults = static_cast<int64_t>(pmc.PageFaultCount);
+	x.RamPhysicalUsedPeak = static_cast<int64_t>(pmc.PeakWorkingSetSize);
+	return true;
+#else
+	struct rusage rusage;
+
+#if defined(__linux__)
+	const auto who = (scope == npas4::UsageScope::Thread) ? RUSAGE_THREAD : RUSAGE_SELF;
+#else
+	(void)scope;
+	const auto who = RUSAGE_SELF;
+#endif
+
+	if(getrusage(who, &rusage) != 0)
+	{
+		return false;
+	}
+
+	x.MinorFaults = static_cast<int64_t>(rusage.ru_minflt);
+	x.MajorFaults = static_cast<int64_t>(rusage.ru_majflt);
+	x.VoluntaryContextSwitches = static_cast<int64_t>(rusage.ru_nvcsw);
+	x.InvoluntaryContextSwitches = static_cast<int64_t>(rusage.ru_nivcsw);
+
+#if defined(__APPLE__) && defined(__MACH__)
+	// macOS reports ru_maxrss in bytes, Linux in kilobytes.
+	x.RamPhysicalUsedPeak = static_cast<int64_t>(rusage.ru_maxrss);
+#else
+	x.RamPhysicalUsedPeak = static_cast<int64_t>(rusage.ru_maxrss) * 1024;
+#endif
+
+	return true;
+#endif
+}
+
+namespace npas4
+{
+	namespace impl
+	{
+		void FillSmapsSnapshot(const npas4::impl::SmapsFields& fields, npas4::impl::SmapsSnapshot& x)
+		{
+			x.Rss = fields.Rss;
+			x.Pss = fields.Pss;
+			x.Uss = fields.PrivateClean + fields.PrivateDirty;
+			x.Swap = fields.Swap;
+			x.SwapPss = fields.SwapPss;
+			x.Anonymous = fields.Anonymous;
+			x.AnonHugePages = fields.AnonHugePages;
+			x.Locked = fields.Locked;
+		}
+	} // namespace impl
+} // namespace npas4
+
+void npas4::impl::ParseSmapsRollup(const char* data, size_t size, npas4::impl::SmapsSnapshot& x)
+{
+	npas4::impl::SmapsFields fields;
+	npas4::impl::ParseKeyValues(data, size, fields);
+	npas4::impl::FillSmapsSnapshot(fields, x);
+}
+
+bool npas4::impl::AccumulateSmaps(const char* path, npas4::impl::SmapsSnapshot& x)
+{
+	x = SmapsSnapshot();
+
+#ifdef WIN32
+	(void)path;
+	return false;
+#else
+	const auto fd = open(path, O_RDONLY | O_CLOEXEC);
+
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	// smaps can be megabytes long, so it is parsed a buffer at a time.  Only complete lines are parsed; a partial line at the end of the
+	// buffer is moved to the front and completed by the next read.  A line that fills the whole buffer (a mapping of a very long path) is
+	// not a line we parse, and is dropped through its newline.
+	npas4::impl::SmapsFields fields;
+	char buffer[8192];
+	size_t size = 0;
+	auto skipping = false;
+	auto ok = true;
+
+	for(;;)
+	{
+		const auto bytes = read(fd, buffer + size, sizeof(buffer) - size);
+
+		if(bytes < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+
+			ok = false;
+			break;
+		}
+
+		if(bytes == 0)
+		{
+			if(skipping == false)
+			{
+				npas4::impl::AccumulateKeyValues(buffer, size, fields);
+			}
+
+			break;
+		}
+
+		size += static_cast<size_t>(bytes);
+
+		if(skipping == true)
+		{
+			const auto end = static_cast<const char*>(memchr(buffer, '\n', size));
+
+			if(end == nullptr)
+			{
+				size = 0;
+				continue;
+			}
+
+			const auto skipped = static_cast<size_t>(end - buffer) + 1;
+			memmove(buffer, buffer + skipped, size - skipped);
+			size -= skipped;
+			skipping = false;
+		}
+
+		auto complete = size;
+
+		while(complete > 0 && buffer[complete - 1] != '\n')
+		{
+			--complete;
+		}
+
+		if(complete == 0)
+		{
+			if(size == sizeof(buffer))
+			{
+				size = 0;
+				skipping = true;
+			}
+
+			continue;
+		}
+
+		npas4::impl::AccumulateKeyValues(buffer, complete, fields);
+		memmove(buffer, buffer + complete, size - complete);
+		size -= complete;
+	}
+
+	close(fd);
+	npas4::impl::FillSmapsSnapshot(fields, x);
+	return ok;
+#endif
+}
+
+bool npas4::impl::ReadSmaps(const char* directory, npas4::impl::SmapsSnapshot& x)
+{
+	x = SmapsSnapshot();
+
+#ifdef WIN32
+	(void)directory;
+	return false;
+#else
+	const std::string path(directory);
+	npas4::impl::ProcFile file;
+
+	if(file.Open((path + "/smaps_rollup").c_str()) == true)
+	{
+		if(file.Read() == false)
+		{
+			return false;
+		}
+
+		npas4::impl::ParseSmapsRollup(file.Data(), file.Size(), x);
+		return true;
+	}
+
+	return npas4::impl::AccumulateSmaps((path + "/smaps").c_str(), x);
+#endif
+}
+
+bool npas4::impl::ReadSmapsSnapshot(npas4::impl::SmapsSnapshot& x)
+{
+	return npas4::impl::ReadSmaps("/proc/self", x);
+}
+
+int64_t npas4::impl::PageSize()
+{
+#ifdef WIN32
+	static const auto pageSize = []() {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return static_cast<int64_t>(info.dwPageSize);
+	}();
+#else
+	static const auto pageSize = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+#endif
+
+	return pageSize;
+}
+
+bool npas4::impl::ReadSnapshot(npas4::impl::Snapshot& x)
+{
+	const auto system = ReadSystemSnapshot(x.System);
+	const auto process = ReadProcessSnapshot(x.Process);
+	npas4::impl::ReadCgroupSnapshot(x.Cgroup);
+	return system && process;
+}
+
+int64_t npas4::impl::SystemUsedByCurrentProcess(const npas4::impl::ProcessSnapshot& x)
+{
+#if defined(WIN32) || (defined(__APPLE__) && defined(__MACH__))
+	return x.Physical;
+#else
+	return x.Physical + x.Virtual;
+#endif
+}
+
+void npas4::impl::FillReport(const npas4::impl::Snapshot& x, npas4::RAMReport& r)
+{
+	r.RamSystemTotal = x.System.SystemTotal;
+	r.RamSystemAvailable = x.System.SystemAvailable;
+	r.RamSystemUsed = x.System.SystemTotal - x.System.SystemAvailable;
+	r.RamSystemUsedByCurrentProcess = SystemUsedByCurrentProcess(x.Process);
+	r.RamPhysicalTotal = x.System.PhysicalTotal;
+	r.RamPhysicalAvailable = x.System.PhysicalAvailable;
+	r.RamPhysicalUsed = x.System.PhysicalTotal - x.System.PhysicalAvailable;
+	r.RamPhysicalUsedByCurrentProcess = x.Process.Physical;
+	r.RamPhysicalUsedByCurrentProcessPeak = x.Process.PhysicalPeak;
+	r.RamVirtualTotal = x.System.VirtualTotal;
+	r.RamVirtualAvailable = x.System.VirtualAvailable;
+	r.RamVirtualUsed = x.System.VirtualTotal - x.System.VirtualAvailable;
+	r.RamVirtualUsedByCurrentProcess = x.Process.Virtual;
+	r.RamProportionalUsedByCurrentProcess = x.Smaps.Pss;
+	r.RamUniqueUsedByCurrentProcess = x.Smaps.Uss;
+
+	const auto cgroup = x.Cgroup.Version != npas4::CgroupVersion::None;
+	const auto limited = x.Cgroup.MemoryMax >= 0 && x.Cgroup.MemoryMax < x.System.PhysicalTotal;
+	r.RamCgroupTotal = (limited == true) ? x.Cgroup.MemoryMax : x.System.PhysicalTotal;
+	r.RamCgroupUsed = (cgroup == true) ? x.Cgroup.MemoryCurrent : r.RamPhysicalUsed;
+
+	// Inactive page cache is reclaimed before the limit is hit, so like MemAvailable only the working set counts against the limit.
+	const auto workingSet = (cgroup == true) ? x.Cgroup.MemoryCurrent - x.Cgroup.InactiveFile : r.RamPhysicalUsed;
+	r.RamCgroupAvailable = (r.RamCgroupTotal > workingSet) ? r.RamCgroupTotal - workingSet : 0;
+
+	// Without a limit of its own, the cgroup shares the host's memory with every other process.
+	if(limited == false && r.RamCgroupAvailable > r.RamPhysicalAvailable)
+	{
+		r.RamCgroupAvailable = r.RamPhysicalAvailable;
+	}
+}
+
+void npas4::impl::MaskReport(npas4::RAMReport& r, uint32_t fields)
+{
+	const auto keep = [fields](uint32_t field, int64_t& x) {
+		if((fields & field) == 0)
+		{
+			x = 0;
+		}
+	};
+
+	keep(npas4::RAMReportField::SystemTotal, r.RamSystemTotal);
+	keep(npas4::RAMReportField::SystemAvailable, r.RamSystemAvailable);
+	keep(npas4::RAMReportField::SystemUsed, r.RamSystemUsed);
+	keep(npas4::RAMReportField::SystemUsedByCurrentProcess, r.RamSystemUsedByCurrentProcess);
+	keep(npas4::RAMReportField::PhysicalTotal, r.RamPhysicalTotal);
+	keep(npas4::RAMReportField::PhysicalAvailable, r.RamPhysicalAvailable);
+	keep(npas4::RAMReportField::PhysicalUsed, r.RamPhysicalUsed);
+	keep(npas4::RAMReportField::PhysicalUsedByCurrentProcess, r.RamPhysicalUsedByCurrentProcess);
+	keep(npas4::RAMReportField::PhysicalUsedByCurrentProcessPeak, r.RamPhysicalUsedByCurrentProcessPeak);
+	keep(npas4::RAMReportField::VirtualTotal, r.RamVirtualTotal);
+	keep(npas4::RAMReportField::VirtualAvailable, r.RamVirtualAvailable);
+	keep(npas4::RAMReportField::VirtualUsed, r.RamVirtualUsed);
+	keep(npas4::RAMReportField::VirtualUsedByCurrentProcess, r.RamVirtualUsedByCurrentProcess);
+	keep(npas4::RAMReportField::CgroupTotal, r.RamCgroupTotal);
+	keep(npas4::RAMReportField::CgroupAvailable, r.RamCgroupAvailable);
+	keep(npas4::RAMReportField::CgroupUsed, r.RamCgroupUsed);
+	keep(npas4::RAMReportField::ProportionalUsedByCurrentProcess, r.RamProportionalUsedByCurrentProcess);
+	keep(npas4::RAMReportField::UniqueUsedByCurrentProcess, r.RamUniqueUsedByCurrentProcess);
+}
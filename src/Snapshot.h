@@ -0,0 +1,292 @@
+#ifndef H_NPAS4_SNAPSHOT_H
+#define H_NPAS4_SNAPSHOT_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Cgroup.h>
+#include <npas4/Meminfo.h>
+#include <npas4/Npas4.h>
+#include <npas4/Usage.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// System wide memory values, in bytes, gathered from a single query of the operating system.
+		/// (One read of /proc/meminfo on Linux, falling back to sysinfo(); GlobalMemoryStatusEx() on Windows.)
+		///
+		/// Only totals and available amounts are stored.  "Used" is always derived as total minus available so that every platform reports
+		/// self-consistent numbers.
+		///
+		struct SystemSnapshot
+		{
+			int64_t SystemTotal{0};
+			int64_t SystemAvailable{0};
+			int64_t PhysicalTotal{0};
+			int64_t PhysicalAvailable{0};
+			int64_t VirtualTotal{0};
+			int64_t VirtualAvailable{0};
+		};
+
+		///
+		/// Memory values, in bytes, for the current process gathered from a single query of the operating system.
+		/// (One read of /proc/self/status on Linux, GetProcessMemoryInfo() on Windows.)
+		///
+		struct ProcessSnapshot
+		{
+			int64_t Physical{0};
+			int64_t PhysicalPeak{0};
+			int64_t Virtual{0};
+		};
+
+		///
+		/// Memory values, in bytes, for one process summed over all of its mappings.  (One read of /proc/<pid>/smaps_rollup on Linux.)
+		///
+		struct SmapsSnapshot
+		{
+			int64_t Rss{0};
+
+			///
+			/// Proportional set size: each resident page divided by the number of processes mapping it.
+			///
+			int64_t Pss{0};
+
+			///
+			/// Unique set size: Private_Clean + Private_Dirty.
+			///
+			int64_t Uss{0};
+
+			int64_t Swap{0};
+			int64_t SwapPss{0};
+			int64_t Anonymous{0};
+			int64_t AnonHugePages{0};
+			int64_t Locked{0};
+		};
+
+		///
+		/// Everything needed to build a RAMReport.
+		///
+		struct Snapshot
+		{
+			SystemSnapshot System;
+			ProcessSnapshot Process;
+			npas4::CgroupReport Cgroup;
+			SmapsSnapshot Smaps;
+		};
+
+		///
+		/// Issues exactly one system memory query.  Returns false if the query failed, in which case the snapshot is left zeroed.
+		///
+		bool ReadSystemSnapshot(SystemSnapshot& x);
+
+		///
+		/// Issues exactly one process memory query.  Returns false if the query failed, in which case the snapshot is left zeroed.
+		///
+		bool ReadProcessSnapshot(ProcessSnapshot& x);
+
+		///
+		/// Page faults taken by the current process since it started.
+		///
+		struct FaultSnapshot
+		{
+			///
+			/// Faults satisfied without I/O (e.g. first touch of an anonymous page, or a page already in the page cache).
+			///
+			int64_t Minor{0};
+
+			///
+			/// Faults that had to read from disk or swap.
+			///
+			int64_t Major{0};
+		};
+
+		///
+		/// One getrusage() on POSIX.  On Windows, one GetProcessMemoryInfo(), which counts every fault as Minor.
+		///
+		bool ReadFaultSnapshot(FaultSnapshot& x);
+
+		///
+		/// Issues exactly one memory query for an arbitrary process.  Returns false, leaving the snapshot zeroed, if the process does not exist,
+		/// has exited (including zombies, which no longer have an address space), or cannot be queried.  (One read of /proc/<pid>/status on
+		/// Linux, GetProcessMemoryInfo() on Windows.  Only the current process can be queried on other platforms.)
+		///
+		bool ReadProcessSnapshot(int64_t pid, ProcessSnapshot& x);
+
+		///
+		/// Writes "/proc/<pid>" into 'x'.
+		///
+		void ProcDirectory(int64_t pid, char (&x)[32]);
+
+		///
+		/// Parses the text of /proc/<pid>/smaps_rollup.
+		///
+		void ParseSmapsRollup(const char* data, size_t size, SmapsSnapshot& x);
+
+		///
+		/// Reads /proc/<pid>/smaps_rollup in one read.  On kernels older than 4.14, which lack smaps_rollup, streams /proc/<pid>/smaps and sums
+		/// every mapping instead.  'directory' is the process's procfs directory, e.g. "/proc/self".  Returns false if neither file could be
+		/// read, or on platforms without procfs.
+		///
+		bool ReadSmaps(const char* directory, SmapsSnapshot& x);
+
+		///
+		/// Streams /proc/<pid>/smaps through a fixed buffer, summing the fields of every mapping.
+		///
+		bool AccumulateSmaps(const char* path, SmapsSnapshot& x);
+
+		///
+		/// Reads the smaps snapshot of the current process.
+		///
+		bool ReadSmapsSnapshot(SmapsSnapshot& x);
+
+		///
+		/// Reads the system, process, and cgroup snapshots.  Returns false if the system or process query failed.  (Not being in a memory
+		/// controlled cgroup is not a failure.)  The smaps snapshot walks the page tables and is left empty; callers that need PSS or USS read
+		/// it themselves.
+		///
+		bool ReadSnapshot(Snapshot& x);
+
+		///
+		/// The platform specific definition of "system RAM used by a process".
+		///
+		int64_t SystemUsedByCurrentProcess(const ProcessSnapshot& x);
+
+		///
+		/// Parses the text of /proc/meminfo in a single pass without allocating.
+		///
+		void ParseMeminfo(const char* data, size_t size, npas4::MeminfoReport& x);
+
+		///
+		/// Parses the text of /proc/meminfo into a system snapshot.  Physical "available" is MemAvailable rather than MemFree, so reclaimable
+		/// page cache counts as available.
+		///
+		void ParseMeminfo(const char* data, size_t size, SystemSnapshot& x);
+
+		///
+		/// Derives a system snapshot from /proc/meminfo values.
+		///
+		void FillSystemSnapshot(const npas4::MeminfoReport& x, SystemSnapshot& s);
+
+		///
+		/// Issues exactly one read of /proc/meminfo.  Always returns false on platforms without procfs.
+		///
+		bool ReadMeminfo(npas4::MeminfoReport& x);
+
+		///
+		/// Parses the text of /proc/<pid>/status (VmSize, VmHWM, VmRSS) into a process snapshot in a single pass.  Returns false if the text
+		/// has no memory fields, as for a zombie or a kernel thread.
+		///
+		bool ParseStatus(const char* data, size_t size, ProcessSnapshot& x);
+
+		///
+		/// The fields of /proc/<pid>/statm, converted from pages to bytes.  ("lib" and "dt" are always zero on modern kernels and are not kept.)
+		///
+		struct StatmFields
+		{
+			int64_t Size{0};
+			int64_t Resident{0};
+			int64_t Shared{0};
+			int64_t Text{0};
+			int64_t Data{0};
+		};
+
+		///
+		/// Parses the text of /proc/<pid>/statm.  Returns false if the text is malformed.
+		///
+		bool ParseStatm(const char* data, size_t size, int64_t pageSize, StatmFields& x);
+
+		///
+		/// Issues exactly one read of /proc/self/statm.  Always returns false on platforms without procfs.
+		///
+		bool ReadStatm(StatmFields& x);
+
+		///
+		/// Issues exactly one read of /proc/<pid>/statm.  Returns false if the process does not exist or has exited.
+		///
+		bool ReadStatm(int64_t pid, StatmFields& x);
+
+		///
+		/// The fault counters of /proc/<pid>/stat.
+		///
+		struct StatFields
+		{
+			int64_t MinorFaults{0};
+			int64_t ChildMinorFaults{0};
+			int64_t MajorFaults{0};
+			int64_t ChildMajorFaults{0};
+		};
+
+		///
+		/// Parses the text of /proc/<pid>/stat.  The command name, which may itself contain spaces and parentheses, is skipped by searching
+		/// for the last ')'.  Returns false if the text is truncated.
+		///
+		bool ParseStat(const char* data, size_t size, StatFields& x);
+
+		///
+		/// Issues exactly one read of /proc/self/stat.  Always returns false on platforms without procfs.
+		///
+		bool ReadStat(StatFields& x);
+
+		///
+		/// Issues exactly one getrusage() (GetProcessMemoryInfo() on Windows).  The child fault counts are left zero.
+		///
+		bool ReadUsageSnapshot(npas4::UsageScope scope, npas4::UsageReport& x);
+
+		///
+		/// The system page size in bytes.  The operating system is only queried the first time this is called.
+		///
+		int64_t PageSize();
+
+		///
+		/// The RAMReportField flags served by each snapshot query.
+		///
+		constexpr uint32_t SystemReportFields{npas4::RAMReportField::SystemTotal | npas4::RAMReportField::SystemAvailable
+											  | npas4::RAMReportField::SystemUsed | npas4::RAMReportField::PhysicalTotal
+											  | npas4::RAMReportField::PhysicalAvailable | npas4::RAMReportField::PhysicalUsed
+											  | npas4::RAMReportField::VirtualTotal | npas4::RAMReportField::VirtualAvailable
+											  | npas4::RAMReportField::VirtualUsed | npas4::RAMReportField::CgroupTotal
+											  | npas4::RAMReportField::CgroupAvailable | npas4::RAMReportField::CgroupUsed};
+
+		constexpr uint32_t ProcessReportFields{npas4::RAMReportField::SystemUsedByCurrentProcess | npas4::RAMReportField::PhysicalUsedByCurrentProcess
+											   | npas4::RAMReportField::PhysicalUsedByCurrentProcessPeak
+											   | npas4::RAMReportField::VirtualUsedByCurrentProcess};
+
+		constexpr uint32_t CgroupReportFields{npas4::RAMReportField::CgroupTotal | npas4::RAMReportField::CgroupAvailable
+											  | npas4::RAMReportField::CgroupUsed};
+
+		constexpr uint32_t SmapsReportFields{npas4::RAMReportField::ProportionalUsedByCurrentProcess
+											 | npas4::RAMReportField::UniqueUsedByCurrentProcess};
+
+		///
+		/// Populates every field of a RAMReport from a snapshot.
+		///
+		void FillReport(const Snapshot& x, npas4::RAMReport& r);
+
+		///
+		/// Zeroes every field not named in 'fields'.
+		///
+		void MaskReport(npas4::RAMReport& r, uint32_t fields);
+	} // namespace impl
+} // namespace npas4
+
+#endif
@@ -0,0 +1,226 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/SnapshotReader.h>
+
+#include "CgroupFiles.h"
+#include "ProcFile.h"
+#include "ReadBatch.h"
+#include "Snapshot.h"
+
+class npas4::SnapshotReader::Impl
+{
+public:
+	Impl() : pageSize(npas4::impl::PageSize()), batch(64)
+	{
+#ifndef WIN32
+		this->status.Open("/proc/self/status");
+		this->statm.Open("/proc/self/statm");
+		this->stat.Open("/proc/self/stat");
+		this->meminfo.Open("/proc/meminfo");
+		this->smapsRollup.Open("/proc/self/smaps_rollup");
+#endif
+		this->cgroup.Open(npas4::impl::SelfCgroup());
+	}
+
+	bool ReadStatm(npas4::impl::StatmFields& x)
+	{
+		return this->statm.Read() == true && npas4::impl::ParseStatm(this->statm.Data(), this->statm.Size(), this->pageSize, x);
+	}
+
+	///
+	/// Reads, in one batch, only the files that the requested fields need.  A file that could not be opened or read falls back to the free
+	/// functions' sources.
+	///
+	npas4::RAMReport Read(uint32_t fields)
+	{
+		const auto system = (fields & npas4::impl::SystemReportFields) != 0;
+		const auto cgroup = (fields & npas4::impl::CgroupReportFields) != 0;
+		const auto smaps = (fields & npas4::impl::SmapsReportFields) != 0;
+
+		// Without the peak, statm carries every per-process field and is cheaper to parse than status.
+		const auto peak = (fields & npas4::RAMReportField::PhysicalUsedByCurrentProcessPeak) != 0;
+		const auto process = (fields & npas4::impl::ProcessReportFields) != 0;
+		auto& processFile = (peak == true) ? this->status : this->statm;
+
+		this->batch.Clear();
+		const auto meminfoRead = (system == true) ? this->meminfo.Enqueue(this->batch) : 0;
+		const auto processRead = (process == true) ? processFile.Enqueue(this->batch) : 0;
+		const auto smapsRead = (smaps == true) ? this->smapsRollup.Enqueue(this->batch) : 0;
+
+		if(cgroup == true)
+		{
+			this->cgroup.Enqueue(this->batch);
+		}
+
+		this->batch.Submit();
+
+		npas4::impl::Snapshot x;
+
+		if(system == true)
+		{
+			if(this->meminfo.Complete(this->batch.Result(meminfoRead)) == true)
+			{
+				npas4::impl::ParseMeminfo(this->meminfo.Data(), this->meminfo.Size(), x.System);
+			}
+			else
+			{
+				npas4::impl::ReadSystemSnapshot(x.System);
+			}
+		}
+
+		if(process == true)
+		{
+			npas4::impl::StatmFields statm;
+
+			if(processFile.Complete(this->batch.Result(processRead)) == false)
+			{
+				npas4::impl::ReadProcessSnapshot(x.Process);
+			}
+			else if(peak == true)
+			{
+				npas4::impl::ParseStatus(this->status.Data(), this->status.Size(), x.Process);
+			}
+			else if(npas4::impl::ParseStatm(this->statm.Data(), this->statm.Size(), this->pageSize, statm) == true)
+			{
+				x.Process.Physical = statm.Resident;
+				x.Process.Virtual = statm.Size;
+			}
+			else
+			{
+				npas4::impl::ReadProcessSnapshot(x.Process);
+			}
+		}
+
+		if(smaps == true)
+		{
+			if(this->smapsRollup.Complete(this->batch.Result(smapsRead)) == true)
+			{
+				npas4::impl::ParseSmapsRollup(this->smapsRollup.Data(), this->smapsRollup.Size(), x.Smaps);
+			}
+			else
+			{
+				npas4::impl::ReadSmapsSnapshot(x.Smaps);
+			}
+		}
+
+		if(cgroup == true)
+		{
+			if(this->cgroup.IsOpen() == true)
+			{
+				this->cgroup.Complete(this->batch, x.Cgroup);
+			}
+			else
+			{
+				npas4::impl::ReadCgroupSnapshot(x.Cgroup);
+			}
+		}
+
+		npas4::RAMReport r;
+		npas4::impl::FillReport(x, r);
+		return r;
+	}
+
+	npas4::impl::ProcFile status;
+	npas4::impl::ProcFile statm;
+	npas4::impl::ProcFile stat;
+	npas4::impl::ProcFile meminfo;
+	npas4::impl::ProcFile smapsRollup;
+	npas4::impl::CgroupFiles cgroup;
+	const int64_t pageSize;
+	npas4::impl::ReadBatch batch;
+};
+
+npas4::SnapshotReader::SnapshotReader() : pimpl(new Impl())
+{
+}
+
+npas4::SnapshotReader::~SnapshotReader()
+{
+}
+
+bool npas4::SnapshotReader::IsOpen() const
+{
+	return this->pimpl->status.IsOpen() && this->pimpl->statm.IsOpen() && this->pimpl->meminfo.IsOpen();
+}
+
+npas4::RAMReport npas4::SnapshotReader::GetRAMReport()
+{
+	// Every field but PSS and USS, which FillReport() leaves zero without an smaps snapshot, so nothing needs masking.
+	return this->pimpl->Read(npas4::RAMReportField::All & ~npas4::impl::SmapsReportFields);
+}
+
+npas4::RAMReport npas4::SnapshotReader::GetRAMReport(uint32_t fields)
+{
+	auto r = this->pimpl->Read(fields);
+	npas4::impl::MaskReport(r, fields);
+	return r;
+}
+
+npas4::MeminfoReport npas4::SnapshotReader::GetMeminfoReport()
+{
+	npas4::MeminfoReport x;
+
+	if(this->pimpl->meminfo.Read() == true)
+	{
+		npas4::impl::ParseMeminfo(this->pimpl->meminfo.Data(), this->pimpl->meminfo.Size(), x);
+		return x;
+	}
+
+	return npas4::GetMeminfoReport();
+}
+
+int64_t npas4::SnapshotReader::GetRAMPhysicalUsedByCurrentProcess()
+{
+	npas4::impl::StatmFields x;
+
+	if(this->pimpl->ReadStatm(x) == true)
+	{
+		return x.Resident;
+	}
+
+	return npas4::GetRAMPhysicalUsedByCurrentProcess();
+}
+
+int64_t npas4::SnapshotReader::GetRAMVirtualUsedByCurrentProcess()
+{
+	npas4::impl::StatmFields x;
+
+	if(this->pimpl->ReadStatm(x) == true)
+	{
+		return x.Size;
+	}
+
+	return npas4::GetRAMVirtualUsedByCurrentProcess();
+}
+
+npas4::UsageReport npas4::SnapshotReader::GetUsageReport()
+{
+	npas4::UsageReport x;
+	npas4::impl::ReadUsageSnapshot(npas4::UsageScope::Process, x);
+
+	npas4::impl::StatFields stat;
+
+	if(this->pimpl->stat.Read() == true && npas4::impl::ParseStat(this->pimpl->stat.Data(), this->pimpl->stat.Size(), stat) == true)
+	{
+		x.ChildMinorFaults = stat.ChildMinorFaults;
+		x.ChildMajorFaults = stat.ChildMajorFaults;
+	}
+
+	return x;
+}
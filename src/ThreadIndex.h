@@ -0,0 +1,135 @@
+#ifndef H_NPAS4_THREADINDEX_H
+#define H_NPAS4_THREADINDEX_H
+
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__)
+// The general dynamic TLS model costs a call to __tls_get_addr() on every access from a shared library.
+#define NPAS4_INITIAL_EXEC_TLS __attribute__((tls_model("initial-exec")))
+#define NPAS4_NOINLINE __attribute__((noinline))
+#else
+#define NPAS4_INITIAL_EXEC_TLS
+#define NPAS4_NOINLINE
+#endif
+
+namespace npas4
+{
+	namespace impl
+	{
+		///
+		/// The default (empty) notifications of a ThreadIndex.  A Tag hides either function to act when a thread claims or releases its
+		/// index.  Neither may allocate with operator new.
+		///
+		struct ThreadIndexHooks
+		{
+			static void OnClaim(size_t)
+			{
+			}
+
+			static void OnRelease(size_t)
+			{
+			}
+		};
+
+		///
+		/// \class ThreadIndex
+		///
+		/// Hands each thread an index in [0, Count) of its own, for per-thread shards of counters or caches that only their thread writes.
+		/// Each Tag has its own set of indexes.  A thread that exits releases its index, and the next thread to claim it inherits the shard as
+		/// it was left.  Threads that find every index taken, and a thread's code that runs after its index is released (later thread_local
+		/// destructors), get Count, which callers map to a shared shard.
+		///
+		/// Nothing here allocates with operator new, and the state is zero initialized, so it may be used before main() and after static
+		/// destructors.
+		///
+		template <typename Tag, size_t Count>
+		class ThreadIndex
+		{
+		public:
+			static size_t Get()
+			{
+				if(Index == Unclaimed)
+				{
+					Index = Claim();
+				}
+
+				return Index;
+			}
+
+		private:
+			static const size_t Unclaimed{static_cast<size_t>(-1)};
+
+			struct Release
+			{
+				~Release()
+				{
+					if(Index < Count)
+					{
+						Tag::OnRelease(Index);
+						Claimed[Index].store(false, std::memory_order_release);
+					}
+
+					Index = Count;
+				}
+			};
+
+			NPAS4_NOINLINE static size_t Claim()
+			{
+				// Spread threads over the indexes so that claiming rarely contends.
+				const auto start = reinterpret_cast<uintptr_t>(&Index) / 64;
+
+				for(size_t i = 0; i < Count; ++i)
+				{
+					const auto index = (start + i) % Count;
+					auto expected = false;
+
+					if(Claimed[index].load(std::memory_order_relaxed) == false
+					   && Claimed[index].compare_exchange_strong(expected, true, std::memory_order_acquire, std::memory_order_relaxed) == true)
+					{
+						// Constructing the thread_local registers its destructor.
+						(void)&ThreadRelease;
+						Tag::OnClaim(index);
+						return index;
+					}
+				}
+
+				return Count;
+			}
+
+			static std::atomic<bool> Claimed[Count];
+			static thread_local size_t Index;
+			static thread_local Release ThreadRelease;
+		};
+
+		template <typename Tag, size_t Count>
+		std::atomic<bool> ThreadIndex<Tag, Count>::Claimed[Count];
+
+		template <typename Tag, size_t Count>
+		NPAS4_INITIAL_EXEC_TLS thread_local size_t ThreadIndex<Tag, Count>::Index{ThreadIndex<Tag, Count>::Unclaimed};
+
+		template <typename Tag, size_t Count>
+		thread_local typename ThreadIndex<Tag, Count>::Release ThreadIndex<Tag, Count>::ThreadRelease;
+	} // namespace impl
+} // namespace npas4
+
+#endif
@@ -0,0 +1,86 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/TrackingAllocator.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+	///
+	/// Registered counters, most recent first.  Counters are never unregistered: they are static.
+	///
+	std::atomic<npas4::impl::TrackingCounters*> Head{nullptr};
+} // namespace
+
+void npas4::impl::RegisterTrackingCounters(npas4::impl::TrackingCounters* x)
+{
+	auto head = Head.load(std::memory_order_relaxed);
+
+	do
+	{
+		x->Next = head;
+	} while(Head.compare_exchange_weak(head, x, std::memory_order_release, std::memory_order_relaxed) == false);
+}
+
+npas4::TrackingReport npas4::impl::GetTrackingReport(const npas4::impl::TrackingCounters& x)
+{
+	npas4::TrackingReport r;
+
+	if(x.Name != nullptr)
+	{
+		r.Name = x.Name;
+	}
+
+	r.LiveBytes = x.LiveBytes.load(std::memory_order_relaxed);
+	r.PeakBytes = std::max(r.LiveBytes, x.PeakBytes.load(std::memory_order_relaxed));
+	r.AllocatedBytes = x.AllocatedBytes.load(std::memory_order_relaxed);
+	r.Allocations = x.Allocations.load(std::memory_order_relaxed);
+	r.Deallocations = x.Deallocations.load(std::memory_order_relaxed);
+	return r;
+}
+
+npas4::TrackingReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Tag:                               " << this->Name << std::endl;
+	ss << "Live Bytes:                        " << this->LiveBytes << std::endl;
+	ss << "Peak Bytes:                        " << this->PeakBytes << std::endl;
+	ss << "Allocated Bytes:                   " << this->AllocatedBytes << std::endl;
+	ss << "Allocations:                       " << this->Allocations << std::endl;
+	ss << "Deallocations:                     " << this->Deallocations << std::endl;
+
+	return ss.str();
+}
+
+std::vector<npas4::TrackingReport> npas4::GetTrackingReports()
+{
+	std::vector<npas4::TrackingReport> reports;
+
+	for(auto i = Head.load(std::memory_order_acquire); i != nullptr; i = i->Next)
+	{
+		reports.push_back(npas4::impl::GetTrackingReport(*i));
+	}
+
+	std::stable_sort(std::begin(reports), std::end(reports),
+					 [](const npas4::TrackingReport& a, const npas4::TrackingReport& b) { return a.LiveBytes > b.LiveBytes; });
+
+	return reports;
+}
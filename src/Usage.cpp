@@ -0,0 +1,68 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <npas4/Usage.h>
+
+#include "Snapshot.h"
+
+#include <sstream>
+
+npas4::UsageReport::operator std::string()
+{
+	std::stringstream ss;
+
+	ss << "Minor Faults:                      " << this->MinorFaults << std::endl;
+	ss << "Major Faults:                      " << this->MajorFaults << std::endl;
+	ss << "Child Minor Faults:                " << this->ChildMinorFaults << std::endl;
+	ss << "Child Major Faults:                " << this->ChildMajorFaults << std::endl;
+	ss << "Physical UsedPeak:                 " << this->RamPhysicalUsedPeak << std::endl;
+	ss << "Voluntary Context Switches:        " << this->VoluntaryContextSwitches << std::endl;
+	ss << "Involuntary Context Switches:      " << this->InvoluntaryContextSwitches << std::endl;
+
+	return ss.str();
+}
+
+npas4::UsageReport npas4::UsageReport::operator-(const UsageReport& x)
+{
+	npas4::UsageReport r;
+	r.MinorFaults = this->MinorFaults - x.MinorFaults;
+	r.MajorFaults = this->MajorFaults - x.MajorFaults;
+	r.ChildMinorFaults = this->ChildMinorFaults - x.ChildMinorFaults;
+	r.ChildMajorFaults = this->ChildMajorFaults - x.ChildMajorFaults;
+	r.RamPhysicalUsedPeak = this->RamPhysicalUsedPeak - x.RamPhysicalUsedPeak;
+	r.VoluntaryContextSwitches = this->VoluntaryContextSwitches - x.VoluntaryContextSwitches;
+	r.InvoluntaryContextSwitches = this->InvoluntaryContextSwitches - x.InvoluntaryContextSwitches;
+
+	return r;
+}
+
+npas4::UsageReport npas4::GetUsageReport(npas4::UsageScope x)
+{
+	npas4::UsageReport r;
+	npas4::impl::ReadUsageSnapshot(x, r);
+
+	npas4::impl::StatFields stat;
+
+	if(x == npas4::UsageScope::Process && npas4::impl::ReadStat(stat) == true)
+	{
+		r.ChildMinorFaults = stat.ChildMinorFaults;
+		r.ChildMajorFaults = stat.ChildMajorFaults;
+	}
+
+	return r;
+}
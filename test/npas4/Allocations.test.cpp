@@ -0,0 +1,145 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Allocations.h>
+
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	///
+	/// Publishes a pointer so the optimizer cannot remove the allocation that produced it (new/delete pairs may be elided).
+	///
+	void* volatile Sink{nullptr};
+
+	template <typename T>
+	T* Keep(T* x)
+	{
+		Sink = x;
+		return x;
+	}
+} // namespace
+
+TEST(Allocations, LiveBytes)
+{
+	const auto before = npas4::GetAllocationReport();
+
+	auto x = Keep(new char[1000]);
+	auto middle = npas4::GetAllocationReport();
+
+	auto delta = middle - before;
+	EXPECT_EQ(int64_t(1), delta.Allocations);
+	EXPECT_EQ(int64_t(0), delta.Deallocations);
+	EXPECT_GE(delta.LiveBytes, int64_t(1000));
+	EXPECT_LT(delta.LiveBytes, int64_t(1100));
+
+	delete[] x;
+	auto after = npas4::GetAllocationReport();
+
+	delta = after - before;
+	EXPECT_EQ(int64_t(1), delta.Allocations);
+	EXPECT_EQ(int64_t(1), delta.Deallocations);
+	EXPECT_EQ(int64_t(0), delta.LiveBytes);
+	EXPECT_EQ(delta.AllocatedBytes, delta.FreedBytes);
+}
+
+TEST(Allocations, NoThrow)
+{
+	const auto before = npas4::GetThreadAllocationReport();
+
+	auto x = Keep(new(std::nothrow) int(5));
+	ASSERT_NE(nullptr, x);
+	delete x;
+
+	// Deleting null is not a deallocation.
+	x = nullptr;
+	delete x;
+
+	const auto delta = npas4::GetThreadAllocationReport() - before;
+	EXPECT_EQ(int64_t(1), delta.Allocations);
+	EXPECT_EQ(int64_t(1), delta.Deallocations);
+}
+
+TEST(Allocations, Threads)
+{
+	const int64_t count{10000};
+	const auto before = npas4::GetAllocationReport();
+
+	std::vector<std::unique_ptr<int>> kept(4);
+	std::vector<std::thread> threads;
+
+	for(size_t i = 0; i < kept.size(); ++i)
+	{
+		threads.emplace_back([&kept, i, count]() {
+			const auto start = npas4::GetThreadAllocationReport();
+
+			for(int64_t j = 0; j < count; ++j)
+			{
+				delete Keep(new int(static_cast<int>(j)));
+			}
+
+			kept[i].reset(new int(1));
+
+			const auto delta = npas4::GetThreadAllocationReport() - start;
+			EXPECT_EQ(count + 1, delta.Allocations);
+			EXPECT_EQ(count, delta.Deallocations);
+		});
+	}
+
+	for(auto& i : threads)
+	{
+		i.join();
+	}
+
+	// The threads have exited, but what they allocated is still counted.
+	auto delta = npas4::GetAllocationReport() - before;
+	EXPECT_GE(delta.Allocations, (count + 1) * 4);
+	EXPECT_GE(delta.Deallocations, count * 4);
+
+	// Freed on a different thread from the one that allocated it.
+	const auto live = delta.LiveBytes;
+	kept.clear();
+	delta = npas4::GetAllocationReport() - before;
+	EXPECT_LT(delta.LiveBytes, live);
+}
+
+TEST(Allocations, Rates)
+{
+	const auto before = npas4::GetAllocationReport();
+
+	for(int i = 0; i < 1000; ++i)
+	{
+		std::vector<int> x(100);
+		Keep(x.data())[0] = i;
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	auto after = npas4::GetAllocationReport();
+
+	const auto rates = npas4::GetAllocationRates(before, after);
+	EXPECT_GT(rates.Allocations, 0.0);
+	EXPECT_GT(rates.AllocatedBytes, rates.Allocations);
+	EXPECT_LT(rates.Allocations, 1000.0 / 0.01 * 1.5);
+
+	// Reversed, the interval is negative.
+	EXPECT_EQ(0.0, npas4::GetAllocationRates(after, before).Allocations);
+}
@@ -0,0 +1,135 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Arena.h>
+
+#include <cstring>
+
+namespace
+{
+	bool IsListed(const std::string& name)
+	{
+		for(const auto& i : npas4::GetArenaReports())
+		{
+			if(i.Name == name)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+} // namespace
+
+TEST(Arena, Allocate)
+{
+	npas4::Arena x("test.arena", 4096);
+
+	auto report = x.GetReport();
+	EXPECT_EQ("test.arena", report.Name);
+	EXPECT_EQ("arena", report.Type);
+	EXPECT_GE(report.CommittedBytes, int64_t(4096));
+	EXPECT_EQ(int64_t(0), report.UsedBytes);
+
+	auto a = static_cast<char*>(x.Allocate(100));
+	auto b = static_cast<char*>(x.Allocate(100));
+	memset(a, 1, 100);
+	memset(b, 2, 100);
+
+	EXPECT_EQ(uintptr_t(0), reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t));
+	EXPECT_EQ(uintptr_t(0), reinterpret_cast<uintptr_t>(b) % alignof(std::max_align_t));
+	EXPECT_GE(b - a, 100);
+	EXPECT_EQ(1, a[99]);
+
+	auto c = x.Allocate(1, 1);
+	auto d = x.Allocate(8, 256);
+	EXPECT_EQ(uintptr_t(0), reinterpret_cast<uintptr_t>(d) % 256);
+	EXPECT_NE(c, d);
+
+	report = x.GetReport();
+	EXPECT_GE(report.UsedBytes, int64_t(209));
+	EXPECT_LE(report.UsedBytes, int64_t(209 + 16 + 255 + 15));
+}
+
+TEST(Arena, Grow)
+{
+	npas4::Arena x("test.grow", 4096);
+
+	for(int i = 0; i < 100; ++i)
+	{
+		memset(x.Allocate(1000), 0, 1000);
+	}
+
+	// A block larger than a chunk gets a chunk of its own.
+	memset(x.Allocate(100000), 0, 100000);
+
+	auto report = x.GetReport();
+	EXPECT_GE(report.UsedBytes, int64_t(200000));
+	EXPECT_GE(report.CommittedBytes, report.UsedBytes);
+	EXPECT_EQ(report.UsedBytes, report.PeakUsedBytes);
+}
+
+TEST(Arena, Reset)
+{
+	npas4::Arena x("test.reset", 4096);
+
+	auto first = x.Allocate(1000);
+
+	for(int i = 0; i < 100; ++i)
+	{
+		x.Allocate(1000);
+	}
+
+	const auto before = x.GetReport();
+	x.Reset();
+
+	// Everything is reused: the same addresses, and nothing more committed.
+	EXPECT_EQ(first, x.Allocate(1000));
+
+	for(int i = 0; i < 100; ++i)
+	{
+		x.Allocate(1000);
+	}
+
+	auto after = x.GetReport();
+	EXPECT_EQ(before.CommittedBytes, after.CommittedBytes);
+	EXPECT_EQ(before.UsedBytes, after.UsedBytes);
+	EXPECT_EQ(before.UsedBytes, after.PeakUsedBytes);
+
+	x.Release();
+	after = x.GetReport();
+	EXPECT_EQ(int64_t(0), after.UsedBytes);
+	EXPECT_LT(after.CommittedBytes, int64_t(8192));
+	EXPECT_EQ(before.UsedBytes, after.PeakUsedBytes);
+}
+
+TEST(Arena, Registry)
+{
+	EXPECT_FALSE(IsListed("test.registry"));
+
+	{
+		npas4::Arena x("test.registry");
+		EXPECT_TRUE(IsListed("test.registry"));
+
+		const auto text = static_cast<std::string>(x.GetReport());
+		EXPECT_NE(std::string::npos, text.find("Committed Bytes"));
+	}
+
+	EXPECT_FALSE(IsListed("test.registry"));
+}
@@ -0,0 +1,205 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Budget.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	///
+	/// A budget limited only by its cap, so that tests do not depend on the machine's memory.
+	///
+	npas4::BudgetOptions CapOnly(int64_t cap)
+	{
+		npas4::BudgetOptions x;
+		x.Cap = cap;
+		x.UsePhysicalAvailable = false;
+		x.UseCgroupAvailable = false;
+		x.Interval = std::chrono::nanoseconds(0);
+		return x;
+	}
+} // namespace
+
+TEST(Budget, ReserveRelease)
+{
+	npas4::Budget x(CapOnly(1000));
+
+	auto report = x.GetReport();
+	EXPECT_EQ(int64_t(1000), report.Limit);
+	EXPECT_EQ(int64_t(-1), report.Available);
+
+	EXPECT_TRUE(x.Reserve(600));
+	EXPECT_FALSE(x.Reserve(600));
+	EXPECT_TRUE(x.Reserve(400));
+	EXPECT_FALSE(x.Reserve(1));
+	EXPECT_TRUE(x.Reserve(0));
+
+	report = x.GetReport();
+	EXPECT_EQ(int64_t(1000), report.Reserved);
+	EXPECT_EQ(int64_t(3), report.Reservations);
+	EXPECT_EQ(int64_t(2), report.Refused);
+
+	x.Release(600);
+	EXPECT_TRUE(x.Reserve(600));
+	x.Release(600);
+	x.Release(400);
+	EXPECT_EQ(int64_t(0), x.GetReport().Reserved);
+
+	const auto text = static_cast<std::string>(x.GetReport());
+	EXPECT_NE(std::string::npos, text.find("Refused"));
+}
+
+TEST(Budget, SetCap)
+{
+	npas4::Budget x(CapOnly(0));
+	EXPECT_EQ(int64_t(-1), x.GetReport().Limit);
+	EXPECT_TRUE(x.Reserve(int64_t(1) << 60));
+
+	// Lowering the cap below what is reserved refuses everything until enough is released.
+	x.SetCap(1000);
+	EXPECT_EQ(int64_t(1000), x.GetReport().Limit);
+	EXPECT_FALSE(x.Reserve(1));
+
+	x.Release(int64_t(1) << 60);
+	EXPECT_TRUE(x.Reserve(1000));
+}
+
+TEST(Budget, ScopedReservation)
+{
+	npas4::Budget x(CapOnly(1000));
+
+	{
+		npas4::ScopedReservation a(x, 800);
+		EXPECT_TRUE(a.IsReserved());
+
+		npas4::ScopedReservation b(x, 800);
+		EXPECT_FALSE(b.IsReserved());
+
+		EXPECT_EQ(int64_t(800), x.GetReport().Reserved);
+	}
+
+	EXPECT_EQ(int64_t(0), x.GetReport().Reserved);
+}
+
+TEST(Budget, Threads)
+{
+	npas4::Budget x(CapOnly(10000));
+
+	std::atomic<int64_t> held{0};
+	std::atomic<int64_t> most{0};
+	std::vector<std::thread> threads;
+
+	for(int i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([&]() {
+			for(int j = 0; j < 10000; ++j)
+			{
+				if(x.Reserve(3000) == true)
+				{
+					const auto now = held.fetch_add(3000) + 3000;
+					auto highest = most.load();
+
+					while(now > highest && most.compare_exchange_weak(highest, now) == false)
+					{
+					}
+
+					held.fetch_sub(3000);
+					x.Release(3000);
+				}
+			}
+		});
+	}
+
+	for(auto& i : threads)
+	{
+		i.join();
+	}
+
+	auto report = x.GetReport();
+	EXPECT_EQ(int64_t(0), report.Reserved);
+	EXPECT_LE(most.load(), int64_t(9000));
+	EXPECT_EQ(int64_t(40000), report.Reservations + report.Refused);
+}
+
+TEST(Budget, Available)
+{
+	npas4::BudgetOptions options;
+	options.Headroom = 1024 * 1024;
+	options.Interval = std::chrono::nanoseconds(0);
+	npas4::Budget x(options);
+
+	auto report = x.GetReport();
+	EXPECT_GT(report.Available, int64_t(0));
+	EXPECT_LE(report.Available, npas4::GetRAMPhysicalTotal());
+	EXPECT_EQ(std::max(int64_t(0), report.Available - options.Headroom), report.Limit);
+
+	// Nothing like all of memory can be reserved.
+	EXPECT_FALSE(x.Reserve(npas4::GetRAMPhysicalTotal()));
+
+	x.SetCap(4096);
+	EXPECT_EQ(std::min(int64_t(4096), report.Limit), x.GetReport().Limit);
+}
+
+TEST(Budget, AllocatedReservationsAreNotCountedTwice)
+{
+	const int64_t MB{1024 * 1024};
+
+	npas4::BudgetOptions options;
+	options.Interval = std::chrono::nanoseconds(0);
+
+	// Headroom that leaves a limit of about 256 MB, whatever the machine has available.
+	options.Headroom = npas4::Budget(options).GetReport().Available - 256 * MB;
+	ASSERT_GT(options.Headroom, int64_t(0));
+	npas4::Budget x(options);
+
+	// The first job reserves 192 MB and allocates it, so the available memory falls by as much.
+	ASSERT_TRUE(x.Reserve(192 * MB));
+	std::vector<char> first(static_cast<size_t>(192 * MB), 1);
+	x.Refresh();
+
+	// Counting the first job's memory both as reserved and as gone from the available memory would leave a limit of about 64 MB, and
+	// refuse the second job while there is still memory for it.
+	EXPECT_GT(x.GetReport().Limit, 192 * MB + 32 * MB);
+	EXPECT_TRUE(x.Reserve(32 * MB));
+	EXPECT_FALSE(x.Reserve(256 * MB));
+
+	x.Release(32 * MB);
+	x.Release(192 * MB);
+	EXPECT_EQ(char(1), first.back());
+}
+
+TEST(Budget, Interval)
+{
+	npas4::BudgetOptions options;
+	options.Interval = std::chrono::milliseconds(1);
+	npas4::Budget x(options);
+
+	const auto start = std::chrono::steady_clock::now();
+
+	while(x.GetReport().Refreshes < 3 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	EXPECT_GE(x.GetReport().Refreshes, int64_t(3));
+}
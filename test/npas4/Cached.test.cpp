@@ -0,0 +1,97 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Cached.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(Cached, MatchesUncached)
+{
+	npas4::cached::Invalidate();
+
+	EXPECT_EQ(npas4::GetRAMPhysicalTotal(), npas4::cached::GetRAMPhysicalTotal());
+	EXPECT_EQ(npas4::GetRAMVirtualTotal(), npas4::cached::GetRAMVirtualTotal());
+	EXPECT_GT(npas4::cached::GetRAMPhysicalUsedByCurrentProcess(), int64_t(0));
+	EXPECT_GT(npas4::cached::GetRAMPhysicalUsedByCurrentProcessPeak(), int64_t(0));
+
+	const auto report = npas4::cached::GetRAMReport();
+	EXPECT_EQ(report.RamPhysicalTotal, report.RamPhysicalAvailable + report.RamPhysicalUsed);
+}
+
+TEST(Cached, ValuesAreHeldForTTL)
+{
+	const auto ttl = npas4::cached::GetTTL();
+	npas4::cached::SetTTL(std::chrono::hours(1));
+
+	const auto first = npas4::cached::GetRAMVirtualUsedByCurrentProcess();
+
+	// Grow the address space; the cached value must not notice.
+	std::vector<char*> blocks;
+
+	for(int i = 0; i < 16; ++i)
+	{
+		blocks.push_back(new char[1 << 20]);
+	}
+
+	EXPECT_EQ(first, npas4::cached::GetRAMVirtualUsedByCurrentProcess());
+
+	npas4::cached::Invalidate();
+	EXPECT_NE(first, npas4::cached::GetRAMVirtualUsedByCurrentProcess());
+
+	for(auto block : blocks)
+	{
+		delete[] block;
+	}
+
+	npas4::cached::SetTTL(ttl);
+	EXPECT_EQ(ttl, npas4::cached::GetTTL());
+}
+
+TEST(Cached, ConcurrentReaders)
+{
+	npas4::cached::SetTTL(std::chrono::microseconds(10));
+
+	std::vector<std::thread> threads;
+	std::atomic<int64_t> failures{0};
+
+	for(int i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([&failures]() {
+			for(int j = 0; j < 20000; ++j)
+			{
+				const auto report = npas4::cached::GetRAMReport();
+
+				if(report.RamPhysicalTotal <= 0 || report.RamPhysicalTotal != report.RamPhysicalAvailable + report.RamPhysicalUsed)
+				{
+					++failures;
+				}
+			}
+		});
+	}
+
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	EXPECT_EQ(int64_t(0), failures.load());
+	npas4::cached::SetTTL(std::chrono::milliseconds(10));
+}
@@ -0,0 +1,300 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <CgroupFiles.h>
+#include <Snapshot.h>
+#include <gtest/gtest.h>
+#include <npas4/Cgroup.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifndef WIN32
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+///
+/// A temporary directory standing in for "/", populated with just the files a test needs.
+///
+class FakeRoot
+{
+public:
+	FakeRoot()
+	{
+		char path[] = "/tmp/npas4-cgroup-XXXXXX";
+		this->root = mkdtemp(path);
+	}
+
+	~FakeRoot()
+	{
+		nftw(this->root.c_str(), [](const char* x, const struct stat*, int, struct FTW*) { return remove(x); }, 16, FTW_DEPTH | FTW_PHYS);
+	}
+
+	void Write(const std::string& path, const std::string& contents)
+	{
+		const auto full = this->root + path;
+
+		for(auto slash = full.find('/', this->root.size() + 1); slash != std::string::npos; slash = full.find('/', slash + 1))
+		{
+			mkdir(full.substr(0, slash).c_str(), 0755);
+		}
+
+		std::ofstream(full) << contents;
+	}
+
+	const std::string& Path() const
+	{
+		return this->root;
+	}
+
+private:
+	std::string root;
+};
+
+TEST(Cgroup, ParseMembership)
+{
+	const char text[] = "12:cpu,cpuacct:/a\n4:memory:/docker/abc\n0::/user.slice/session-1.scope\n";
+
+	npas4::impl::CgroupMembership x;
+	npas4::impl::ParseCgroupMembership(text, sizeof(text) - 1, x);
+
+	EXPECT_TRUE(x.V1);
+	EXPECT_EQ("/docker/abc", x.V1Path);
+	EXPECT_TRUE(x.V2);
+	EXPECT_EQ("/user.slice/session-1.scope", x.V2Path);
+
+	const char unified[] = "0::/";
+	npas4::impl::ParseCgroupMembership(unified, sizeof(unified) - 1, x);
+	EXPECT_FALSE(x.V1);
+	EXPECT_TRUE(x.V2);
+	EXPECT_EQ("/", x.V2Path);
+}
+
+TEST(Cgroup, ParseValue)
+{
+	int64_t x = 0;
+
+	EXPECT_TRUE(npas4::impl::ParseCgroupValue("536870912\n", 10, x));
+	EXPECT_EQ(int64_t(536870912), x);
+
+	EXPECT_TRUE(npas4::impl::ParseCgroupValue("max\n", 4, x));
+	EXPECT_EQ(int64_t(-1), x);
+
+	EXPECT_TRUE(npas4::impl::ParseCgroupValue("9223372036854771712\n", 20, x));
+	EXPECT_EQ(int64_t(-1), x);
+
+	EXPECT_FALSE(npas4::impl::ParseCgroupValue("\n", 1, x));
+}
+
+TEST(Cgroup, ParseStat)
+{
+	const char text[] = "active_file 4096\ninactive_file 8192\ntotal_inactive_file 12288\n";
+	int64_t x = 0;
+
+	EXPECT_TRUE(npas4::impl::ParseCgroupStat(text, sizeof(text) - 1, "inactive_file", x));
+	EXPECT_EQ(int64_t(8192), x);
+
+	EXPECT_TRUE(npas4::impl::ParseCgroupStat(text, sizeof(text) - 1, "total_inactive_file", x));
+	EXPECT_EQ(int64_t(12288), x);
+
+	EXPECT_FALSE(npas4::impl::ParseCgroupStat(text, sizeof(text) - 1, "file", x));
+}
+
+TEST(Cgroup, V2)
+{
+	FakeRoot root;
+	root.Write("/proc/self/cgroup", "0::/app.slice/service\n");
+	root.Write("/sys/fs/cgroup/cgroup.controllers", "cpu memory\n");
+	root.Write("/sys/fs/cgroup/app.slice/memory.max", "1073741824\n");
+	root.Write("/sys/fs/cgroup/app.slice/memory.high", "max\n");
+	root.Write("/sys/fs/cgroup/app.slice/memory.current", "900000000\n");
+	root.Write("/sys/fs/cgroup/app.slice/service/memory.max", "max\n");
+	root.Write("/sys/fs/cgroup/app.slice/service/memory.high", "805306368\n");
+	root.Write("/sys/fs/cgroup/app.slice/service/memory.current", "104857600\n");
+	root.Write("/sys/fs/cgroup/app.slice/service/memory.swap.max", "0\n");
+	root.Write("/sys/fs/cgroup/app.slice/service/memory.swap.current", "0\n");
+	root.Write("/sys/fs/cgroup/app.slice/service/memory.stat", "anon 41943040\nfile 62914560\nactive_file 20971520\ninactive_file 41943040\n");
+
+	const auto x = npas4::GetCgroupReport(root.Path());
+
+	EXPECT_EQ(npas4::CgroupVersion::V2, x.Version);
+
+	// The parent's limit applies to the child.
+	EXPECT_EQ(int64_t(1073741824), x.MemoryMax);
+	EXPECT_EQ(int64_t(805306368), x.MemoryHigh);
+	EXPECT_EQ(int64_t(104857600), x.MemoryCurrent);
+	EXPECT_EQ(int64_t(41943040), x.InactiveFile);
+	EXPECT_EQ(int64_t(0), x.SwapMax);
+	EXPECT_EQ(int64_t(0), x.SwapCurrent);
+}
+
+TEST(Cgroup, V2Unlimited)
+{
+	FakeRoot root;
+	root.Write("/proc/self/cgroup", "0::/user.slice\n");
+	root.Write("/sys/fs/cgroup/cgroup.controllers", "memory\n");
+	root.Write("/sys/fs/cgroup/user.slice/memory.max", "max\n");
+	root.Write("/sys/fs/cgroup/user.slice/memory.current", "4096\n");
+
+	const auto x = npas4::GetCgroupReport(root.Path());
+
+	EXPECT_EQ(npas4::CgroupVersion::V2, x.Version);
+	EXPECT_EQ(int64_t(-1), x.MemoryMax);
+	EXPECT_EQ(int64_t(-1), x.MemoryHigh);
+	EXPECT_EQ(int64_t(-1), x.SwapMax);
+	EXPECT_EQ(int64_t(4096), x.MemoryCurrent);
+	EXPECT_EQ(int64_t(0), x.InactiveFile);
+}
+
+TEST(Cgroup, V2HierarchyRoot)
+{
+	// The root of the unified hierarchy has no memory files.
+	FakeRoot root;
+	root.Write("/proc/self/cgroup", "0::/\n");
+	root.Write("/sys/fs/cgroup/cgroup.controllers", "memory\n");
+
+	EXPECT_EQ(npas4::CgroupVersion::None, npas4::GetCgroupReport(root.Path()).Version);
+}
+
+TEST(Cgroup, V1)
+{
+	FakeRoot root;
+	root.Write("/proc/self/cgroup", "5:memory:/docker/abc\n3:cpu,cpuacct:/docker/abc\n0::/\n");
+	root.Write("/sys/fs/cgroup/memory/memory.usage_in_bytes", "2000000000\n");
+	root.Write("/sys/fs/cgroup/memory/memory.limit_in_bytes", "9223372036854771712\n");
+	root.Write("/sys/fs/cgroup/memory/docker/abc/memory.limit_in_bytes", "536870912\n");
+	root.Write("/sys/fs/cgroup/memory/docker/abc/memory.soft_limit_in_bytes", "9223372036854771712\n");
+	root.Write("/sys/fs/cgroup/memory/docker/abc/memory.usage_in_bytes", "268435456\n");
+	root.Write("/sys/fs/cgroup/memory/docker/abc/memory.memsw.limit_in_bytes", "1073741824\n");
+	root.Write("/sys/fs/cgroup/memory/docker/abc/memory.memsw.usage_in_bytes", "301989888\n");
+	root.Write("/sys/fs/cgroup/memory/docker/abc/memory.stat", "cache 167772160\ninactive_file 4096\ntotal_inactive_file 134217728\n");
+
+	const auto x = npas4::GetCgroupReport(root.Path());
+
+	EXPECT_EQ(npas4::CgroupVersion::V1, x.Version);
+	EXPECT_EQ(int64_t(536870912), x.MemoryMax);
+	EXPECT_EQ(int64_t(-1), x.MemoryHigh);
+	EXPECT_EQ(int64_t(268435456), x.MemoryCurrent);
+	EXPECT_EQ(int64_t(134217728), x.InactiveFile);
+	EXPECT_EQ(int64_t(536870912), x.SwapMax);
+	EXPECT_EQ(int64_t(33554432), x.SwapCurrent);
+}
+
+TEST(Cgroup, V1ContainerWithoutNamespace)
+{
+	// /proc/self/cgroup names the host's path, but only the container's own cgroup is mounted.
+	FakeRoot root;
+	root.Write("/proc/self/cgroup", "4:memory:/kubepods/pod1/abc\n");
+	root.Write("/sys/fs/cgroup/memory/memory.limit_in_bytes", "268435456\n");
+	root.Write("/sys/fs/cgroup/memory/memory.usage_in_bytes", "1048576\n");
+
+	const auto x = npas4::GetCgroupReport(root.Path());
+
+	EXPECT_EQ(npas4::CgroupVersion::V1, x.Version);
+	EXPECT_EQ(int64_t(268435456), x.MemoryMax);
+	EXPECT_EQ(int64_t(1048576), x.MemoryCurrent);
+	EXPECT_EQ(int64_t(-1), x.SwapMax);
+}
+
+///
+/// A host with 16 GB of RAM of which 2 GB is available.
+///
+npas4::RAMReport ReportOnHost(const npas4::CgroupReport& x)
+{
+	npas4::impl::Snapshot snapshot;
+	snapshot.System.PhysicalTotal = int64_t(16) << 30;
+	snapshot.System.PhysicalAvailable = int64_t(2) << 30;
+	snapshot.Cgroup = x;
+
+	npas4::RAMReport r;
+	npas4::impl::FillReport(snapshot, r);
+	return r;
+}
+
+TEST(Cgroup, AvailableExcludesInactivePageCache)
+{
+	// A 1 GB container that has read 800 MB of files, 700 MB of which the kernel can reclaim.
+	FakeRoot root;
+	root.Write("/proc/self/cgroup", "0::/app\n");
+	root.Write("/sys/fs/cgroup/cgroup.controllers", "memory\n");
+	root.Write("/sys/fs/cgroup/app/memory.max", "1073741824\n");
+	root.Write("/sys/fs/cgroup/app/memory.current", "943718400\n");
+	root.Write("/sys/fs/cgroup/app/memory.stat", "anon 104857600\nfile 838860800\nactive_file 104857600\ninactive_file 734003200\n");
+
+	const auto r = ReportOnHost(npas4::GetCgroupReport(root.Path()));
+
+	EXPECT_EQ(int64_t(1073741824), r.RamCgroupTotal);
+	EXPECT_EQ(int64_t(943718400), r.RamCgroupUsed);
+	EXPECT_EQ(int64_t(1073741824 - 943718400 + 734003200), r.RamCgroupAvailable);
+}
+
+TEST(Cgroup, AvailableUnlimitedIsAtMostPhysicalAvailable)
+{
+	// Without a limit, the cgroup's 1 GB of usage says nothing about the other 13 GB used on the host.
+	FakeRoot root;
+	root.Write("/proc/self/cgroup", "0::/user.slice\n");
+	root.Write("/sys/fs/cgroup/cgroup.controllers", "memory\n");
+	root.Write("/sys/fs/cgroup/user.slice/memory.max", "max\n");
+	root.Write("/sys/fs/cgroup/user.slice/memory.current", "1073741824\n");
+	root.Write("/sys/fs/cgroup/user.slice/memory.stat", "inactive_file 0\n");
+
+	const auto r = ReportOnHost(npas4::GetCgroupReport(root.Path()));
+
+	EXPECT_EQ(int64_t(16) << 30, r.RamCgroupTotal);
+	EXPECT_EQ(int64_t(2) << 30, r.RamCgroupAvailable);
+}
+
+TEST(Cgroup, None)
+{
+	FakeRoot root;
+	EXPECT_EQ(npas4::CgroupVersion::None, npas4::GetCgroupReport(root.Path()).Version);
+
+	root.Write("/proc/self/cgroup", "3:cpu:/\n");
+	EXPECT_EQ(npas4::CgroupVersion::None, npas4::GetCgroupReport(root.Path()).Version);
+}
+#endif
+
+TEST(Cgroup, Report)
+{
+	const auto cgroup = npas4::GetCgroupReport();
+	const auto report = npas4::GetRAMReport();
+
+	EXPECT_GT(report.RamCgroupTotal, int64_t(0));
+	EXPECT_LE(report.RamCgroupTotal, report.RamPhysicalTotal);
+	EXPECT_LE(report.RamCgroupAvailable, report.RamCgroupTotal);
+
+	if(cgroup.Version != npas4::CgroupVersion::None)
+	{
+		EXPECT_GT(cgroup.MemoryCurrent, int64_t(0));
+	}
+
+	if(cgroup.MemoryMax >= 0 && cgroup.MemoryMax < report.RamPhysicalTotal)
+	{
+		EXPECT_EQ(cgroup.MemoryMax, report.RamCgroupTotal);
+	}
+	else
+	{
+		EXPECT_EQ(report.RamPhysicalTotal, report.RamCgroupTotal);
+	}
+
+	EXPECT_GT(npas4::GetRAMCgroupTotal(), int64_t(0));
+	EXPECT_EQ(report.RamCgroupTotal, npas4::GetRAMReport(npas4::RAMReportField::CgroupTotal).RamCgroupTotal);
+}
@@ -0,0 +1,201 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/CountingResource.h>
+
+#include <atomic>
+#include <new>
+#include <thread>
+#include <vector>
+
+TEST(CountingResource, Counts)
+{
+	npas4::CountingResource x;
+	EXPECT_EQ(std::pmr::get_default_resource(), x.GetUpstream());
+
+	{
+		std::pmr::vector<int> v(&x);
+		v.reserve(1000);
+
+		auto during = x.GetReport();
+		EXPECT_EQ(int64_t(1000 * sizeof(int)), during.LiveBytes);
+		EXPECT_EQ(int64_t(1000 * sizeof(int)), during.PeakBytes);
+		EXPECT_EQ(int64_t(1), during.Allocations);
+		EXPECT_EQ(int64_t(0), during.Deallocations);
+	}
+
+	auto after = x.GetReport();
+	EXPECT_EQ(int64_t(0), after.LiveBytes);
+	EXPECT_EQ(int64_t(1000 * sizeof(int)), after.PeakBytes);
+	EXPECT_EQ(int64_t(1000 * sizeof(int)), after.AllocatedBytes);
+	EXPECT_EQ(int64_t(1), after.Deallocations);
+
+	const auto text = static_cast<std::string>(after);
+	EXPECT_NE(std::string::npos, text.find("Peak Bytes"));
+}
+
+TEST(CountingResource, Upstream)
+{
+	std::pmr::monotonic_buffer_resource arena;
+	npas4::CountingResource x(&arena);
+	EXPECT_EQ(&arena, x.GetUpstream());
+
+	auto p = x.allocate(100, 64);
+	EXPECT_EQ(uintptr_t(0), reinterpret_cast<uintptr_t>(p) % 64);
+	x.deallocate(p, 100, 64);
+
+	EXPECT_TRUE(x.is_equal(x));
+	EXPECT_FALSE(x.is_equal(arena));
+}
+
+TEST(CountingResource, BudgetThrows)
+{
+	npas4::CountingResourceOptions options;
+	options.Budget = 1000;
+	npas4::CountingResource x(std::pmr::get_default_resource(), options);
+	EXPECT_EQ(int64_t(1000), x.GetBudget());
+
+	auto p = x.allocate(600);
+	EXPECT_THROW(static_cast<void>(x.allocate(600)), std::bad_alloc);
+
+	auto report = x.GetReport();
+	EXPECT_EQ(int64_t(600), report.LiveBytes);
+	EXPECT_EQ(int64_t(1), report.Refused);
+
+	// Exactly the budget is allowed.
+	auto q = x.allocate(400);
+	x.deallocate(q, 400);
+
+	x.SetBudget(0);
+	q = x.allocate(600);
+	x.deallocate(q, 600);
+	x.deallocate(p, 600);
+
+	EXPECT_EQ(int64_t(0), x.GetReport().LiveBytes);
+}
+
+TEST(CountingResource, BudgetFallback)
+{
+	npas4::CountingResource fallback;
+
+	npas4::CountingResourceOptions options;
+	options.Budget = 1000;
+	options.Fallback = &fallback;
+	npas4::CountingResource x(std::pmr::get_default_resource(), options);
+
+	{
+		std::pmr::vector<char> a(&x);
+		std::pmr::vector<char> b(&x);
+		a.reserve(800);
+		b.reserve(800);
+
+		auto report = x.GetReport();
+		EXPECT_EQ(int64_t(800), report.LiveBytes);
+		EXPECT_EQ(int64_t(800), report.FallbackLiveBytes);
+		EXPECT_EQ(int64_t(1), report.FallbackAllocations);
+		EXPECT_EQ(int64_t(1), report.Refused);
+		EXPECT_EQ(int64_t(800), fallback.GetReport().LiveBytes);
+	}
+
+	// Each block went back to the resource it came from.
+	EXPECT_EQ(int64_t(0), x.GetReport().LiveBytes);
+	EXPECT_EQ(int64_t(0), x.GetReport().FallbackLiveBytes);
+	EXPECT_EQ(int64_t(0), fallback.GetReport().LiveBytes);
+	EXPECT_EQ(int64_t(1), fallback.GetReport().Deallocations);
+}
+
+TEST(CountingResource, Threads)
+{
+	npas4::CountingResourceOptions options;
+	options.Budget = 64 * 1000;
+	npas4::CountingResource x(std::pmr::get_default_resource(), options);
+
+	std::vector<std::thread> threads;
+
+	for(int i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([&x]() {
+			for(int j = 0; j < 10000; ++j)
+			{
+				try
+				{
+					auto p = x.allocate(1000);
+					x.deallocate(p, 1000);
+				}
+				catch(const std::bad_alloc&)
+				{
+				}
+			}
+		});
+	}
+
+	for(auto& i : threads)
+	{
+		i.join();
+	}
+
+	auto report = x.GetReport();
+	EXPECT_EQ(int64_t(0), report.LiveBytes);
+	EXPECT_LE(report.PeakBytes, options.Budget);
+	EXPECT_EQ(int64_t(40000), report.Allocations + report.Refused);
+	EXPECT_EQ(report.Allocations, report.Deallocations);
+}
+
+TEST(CountingResource, ManyThreads)
+{
+	// More threads at once than there are shards, so that some share the last.
+	const int count{static_cast<int>(npas4::CountingResource::ShardCount) + 16};
+
+	// Room for what every thread allocates, and for the chunks of the budget the threads with shards of their own hold unused.
+	npas4::CountingResourceOptions options;
+	options.Budget = int64_t(count) * 2000;
+	npas4::CountingResource x(std::pmr::get_default_resource(), options);
+
+	std::atomic<int> waiting{count};
+	std::vector<std::thread> threads;
+
+	for(int i = 0; i < count; ++i)
+	{
+		threads.emplace_back([&x, &waiting]() {
+			auto p = x.allocate(1000);
+
+			waiting.fetch_sub(1);
+
+			while(waiting.load() != 0)
+			{
+				std::this_thread::yield();
+			}
+
+			x.deallocate(p, 1000);
+		});
+	}
+
+	for(auto& i : threads)
+	{
+		i.join();
+	}
+
+	auto report = x.GetReport();
+	EXPECT_EQ(int64_t(0), report.LiveBytes);
+	EXPECT_EQ(int64_t(count), report.Allocations);
+	EXPECT_EQ(int64_t(count), report.Deallocations);
+	EXPECT_EQ(int64_t(0), report.Refused);
+	EXPECT_GE(report.PeakBytes, int64_t(1000));
+	EXPECT_LE(report.PeakBytes, options.Budget);
+}
@@ -0,0 +1,140 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <MallocInfo.h>
+#include <gtest/gtest.h>
+#include <npas4/Heap.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+TEST(Heap, ParseMallocInfo)
+{
+	const char text[] =
+		"<malloc version=\"1\">\n"
+		"<heap nr=\"0\">\n"
+		"<sizes>\n"
+		"  <size from=\"17\" to=\"32\" total=\"64\" count=\"2\"/>\n"
+		"  <unsorted from=\"4209\" to=\"4209\" total=\"4209\" count=\"1\"/>\n"
+		"</sizes>\n"
+		"<total type=\"fast\" count=\"2\" size=\"64\"/>\n"
+		"<total type=\"rest\" count=\"3\" size=\"10000\"/>\n"
+		"<system type=\"current\" size=\"135168\"/>\n"
+		"<system type=\"max\" size=\"200704\"/>\n"
+		"<aspace type=\"total\" size=\"135168\"/>\n"
+		"<aspace type=\"mprotect\" size=\"135168\"/>\n"
+		"</heap>\n"
+		"<heap nr=\"1\">\n"
+		"<sizes>\n"
+		"</sizes>\n"
+		"<total type=\"fast\" count=\"0\" size=\"0\"/>\n"
+		"<total type=\"rest\" count=\"1\" size=\"500\"/>\n"
+		"<system type=\"current\" size=\"1000\"/>\n"
+		"<system type=\"max\" size=\"1000\"/>\n"
+		"<aspace type=\"total\" size=\"67108864\"/>\n"
+		"<aspace type=\"mprotect\" size=\"1000\"/>\n"
+		"</heap>\n"
+		"<total type=\"fast\" count=\"2\" size=\"64\"/>\n"
+		"<total type=\"rest\" count=\"4\" size=\"10500\"/>\n"
+		"<total type=\"mmap\" count=\"1\" size=\"1052672\"/>\n"
+		"<system type=\"current\" size=\"136168\"/>\n"
+		"</malloc>\n";
+
+	std::vector<npas4::HeapArenaReport> reports;
+	ASSERT_TRUE(npas4::impl::ParseMallocInfo(text, sizeof(text) - 1, reports));
+	ASSERT_EQ(size_t(2), reports.size());
+
+	EXPECT_EQ(int64_t(0), reports[0].Index);
+	EXPECT_EQ(int64_t(10064), reports[0].Free);
+	EXPECT_EQ(int64_t(5), reports[0].FreeCount);
+	EXPECT_EQ(int64_t(135168), reports[0].System);
+	EXPECT_EQ(int64_t(200704), reports[0].SystemMax);
+	EXPECT_EQ(int64_t(135168), reports[0].AddressSpace);
+
+	EXPECT_EQ(int64_t(1), reports[1].Index);
+	EXPECT_EQ(int64_t(500), reports[1].Free);
+	EXPECT_EQ(int64_t(67108864), reports[1].AddressSpace);
+	EXPECT_DOUBLE_EQ(0.5, reports[1].GetFragmentation());
+
+	reports.clear();
+	const char empty[] = "<malloc version=\"1\">\n</malloc>\n";
+	EXPECT_FALSE(npas4::impl::ParseMallocInfo(empty, sizeof(empty) - 1, reports));
+	EXPECT_TRUE(reports.empty());
+}
+
+#if defined(__GLIBC__)
+TEST(Heap, Fragmentation)
+{
+	// Free every other block, leaving holes the allocator cannot return to the system.
+	std::vector<void*> blocks(4096);
+
+	for(auto& i : blocks)
+	{
+		i = malloc(1024);
+		memset(i, 1, 1024);
+	}
+
+	for(size_t i = 0; i < blocks.size(); i += 2)
+	{
+		free(blocks[i]);
+		blocks[i] = nullptr;
+	}
+
+	const auto report = npas4::GetHeapReport();
+	EXPECT_GT(report.Arena, int64_t(0));
+	EXPECT_GE(report.InUse, int64_t(2048 * 1024));
+	EXPECT_GE(report.Free, int64_t(2048 * 1024));
+	EXPECT_GT(report.GetFragmentation(), 0.0);
+	EXPECT_LT(report.GetFragmentation(), 1.0);
+
+	const auto arenas = npas4::GetHeapArenaReports();
+	ASSERT_FALSE(arenas.empty());
+	EXPECT_EQ(int64_t(0), arenas[0].Index);
+	EXPECT_GT(arenas[0].System, int64_t(0));
+
+	for(auto& i : blocks)
+	{
+		free(i);
+	}
+}
+#endif
+
+TEST(Heap, Trim)
+{
+	{
+		std::vector<void*> blocks(1024);
+
+		for(auto& i : blocks)
+		{
+			i = malloc(4096);
+			memset(i, 1, 4096);
+		}
+
+		// Keep the last block, so the rest are not at the top of the heap and are released by malloc_trim() rather than free().
+		for(size_t i = 0; i + 1 < blocks.size(); ++i)
+		{
+			free(blocks[i]);
+		}
+
+		EXPECT_GE(npas4::TrimHeap(), int64_t(0));
+		free(blocks.back());
+	}
+
+	EXPECT_GE(npas4::TrimHeap(), int64_t(0));
+}
@@ -0,0 +1,309 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/HeapProfileWriter.h>
+#include <npas4/HeapProfiler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef NPAS4_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+	///
+	/// Writes with 'f' to a temporary file and returns what was written.
+	///
+	template <typename F>
+	std::string Capture(F f)
+	{
+		auto file = tmpfile();
+		EXPECT_NE(nullptr, file);
+
+		if(file == nullptr)
+		{
+			return std::string();
+		}
+
+		EXPECT_TRUE(f(fileno(file)));
+
+		std::string x;
+		char buffer[4096];
+		rewind(file);
+
+		size_t n{0};
+
+		while((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			x.append(buffer, n);
+		}
+
+		fclose(file);
+		return x;
+	}
+
+	bool ReadVarint(const std::string& x, size_t& i, uint64_t& value)
+	{
+		value = 0;
+
+		for(int shift = 0; i < x.size() && shift < 64; shift += 7)
+		{
+			const auto byte = static_cast<uint8_t>(x[i++]);
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+			if((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	///
+	/// Calls f(field, varint, bytes) for each field of a protobuf message.  Only the varint and length delimited wire types are expected.
+	///
+	template <typename F>
+	bool ForEachField(const std::string& x, F f)
+	{
+		size_t i{0};
+
+		while(i < x.size())
+		{
+			uint64_t key{0};
+			uint64_t value{0};
+
+			if(ReadVarint(x, i, key) == false || ReadVarint(x, i, value) == false)
+			{
+				return false;
+			}
+
+			if((key & 7) == 0)
+			{
+				f(key >> 3, value, std::string());
+			}
+			else if((key & 7) == 2 && i + value <= x.size())
+			{
+				f(key >> 3, 0, x.substr(i, value));
+				i += value;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::vector<char*> Allocate(size_t count, size_t size)
+	{
+		std::vector<char*> blocks;
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			blocks.push_back(new char[size]);
+			blocks.back()[0] = 1;
+		}
+
+		return blocks;
+	}
+
+	class HeapProfileWriter : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			npas4::HeapProfilerOptions options;
+			options.Interval = 16 * 1024;
+			ASSERT_TRUE(npas4::StartHeapProfiler(options));
+
+			this->blocks = Allocate(16 * 1024, 1024);
+		}
+
+		void TearDown() override
+		{
+			npas4::StopHeapProfiler();
+
+			for(auto i : this->blocks)
+			{
+				delete[] i;
+			}
+		}
+
+		std::vector<char*> blocks;
+	};
+
+	///
+	/// Checks the structure of an uncompressed profile, written when the profiler had recorded 'stacks' stacks.  (The writer's own
+	/// allocations may be sampled, and add more.)
+	///
+	void CheckProfile(const std::string& x, int64_t stacks)
+	{
+		std::vector<std::string> strings;
+		std::set<uint64_t> defined;
+		std::set<uint64_t> referenced;
+		size_t samples{0};
+		size_t sampleTypes{0};
+
+		ASSERT_TRUE(ForEachField(x, [&](uint64_t field, uint64_t, const std::string& bytes) {
+			if(field == 1)
+			{
+				++sampleTypes;
+			}
+			else if(field == 2)
+			{
+				++samples;
+
+				ForEachField(bytes, [&](uint64_t f, uint64_t, const std::string& packed) {
+					size_t i{0};
+					uint64_t id{0};
+
+					while(f == 1 && ReadVarint(packed, i, id) == true)
+					{
+						referenced.insert(id);
+					}
+				});
+			}
+			else if(field == 4)
+			{
+				ForEachField(bytes, [&](uint64_t f, uint64_t value, const std::string&) {
+					if(f == 1)
+					{
+						defined.insert(value);
+					}
+				});
+			}
+			else if(field == 6)
+			{
+				strings.push_back(bytes);
+			}
+		}));
+
+		EXPECT_EQ(size_t(4), sampleTypes);
+		EXPECT_GE(samples, static_cast<size_t>(stacks));
+		EXPECT_LE(samples, static_cast<size_t>(npas4::GetHeapProfileReport().Stacks));
+
+		ASSERT_FALSE(strings.empty());
+		EXPECT_EQ(std::string(), strings[0]);
+		EXPECT_NE(std::end(strings), std::find(std::begin(strings), std::end(strings), "inuse_space"));
+		EXPECT_NE(std::end(strings), std::find(std::begin(strings), std::end(strings), "alloc_objects"));
+
+		EXPECT_FALSE(referenced.empty());
+
+		for(const auto i : referenced)
+		{
+			EXPECT_EQ(size_t(1), defined.count(i)) << "Location " << i;
+		}
+	}
+} // namespace
+
+TEST_F(HeapProfileWriter, Proto)
+{
+	npas4::HeapProfileWriteOptions options;
+	options.Gzip = false;
+
+	auto stacks = npas4::GetHeapProfileReport().Stacks;
+	CheckProfile(Capture([&options](int fd) { return npas4::WriteHeapProfile(fd, options); }), stacks);
+
+	options.Symbolize = false;
+	stacks = npas4::GetHeapProfileReport().Stacks;
+	CheckProfile(Capture([&options](int fd) { return npas4::WriteHeapProfile(fd, options); }), stacks);
+}
+
+#ifdef NPAS4_HAVE_ZLIB
+TEST_F(HeapProfileWriter, Gzip)
+{
+	const auto stacks = npas4::GetHeapProfileReport().Stacks;
+	const auto x = Capture([](int fd) { return npas4::WriteHeapProfile(fd); });
+	ASSERT_GT(x.size(), size_t(2));
+	EXPECT_EQ(0x1f, static_cast<uint8_t>(x[0]));
+	EXPECT_EQ(0x8b, static_cast<uint8_t>(x[1]));
+
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	ASSERT_EQ(Z_OK, inflateInit2(&stream, 15 + 16));
+
+	std::string inflated;
+	std::vector<char> buffer(64 * 1024);
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(x.data()));
+	stream.avail_in = static_cast<uInt>(x.size());
+
+	auto result = Z_OK;
+
+	while(result == Z_OK)
+	{
+		stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+		stream.avail_out = static_cast<uInt>(buffer.size());
+		result = inflate(&stream, Z_NO_FLUSH);
+		inflated.append(buffer.data(), buffer.size() - stream.avail_out);
+	}
+
+	inflateEnd(&stream);
+	EXPECT_EQ(Z_STREAM_END, result);
+
+	CheckProfile(inflated, stacks);
+}
+#endif
+
+TEST_F(HeapProfileWriter, Folded)
+{
+	const auto x = Capture([](int fd) { return npas4::WriteHeapProfileFolded(fd); });
+
+	std::istringstream lines(x);
+	std::string line;
+	int64_t total{0};
+	size_t count{0};
+
+	while(std::getline(lines, line))
+	{
+		const auto space = line.rfind(' ');
+		ASSERT_NE(std::string::npos, space) << line;
+		ASSERT_GT(space, size_t(0)) << line;
+
+		const auto value = std::stoll(line.substr(space + 1));
+		EXPECT_GT(value, int64_t(0)) << line;
+		EXPECT_EQ(std::string::npos, line.find("operator new")) << line;
+
+		total += value;
+		++count;
+	}
+
+	EXPECT_GT(count, size_t(0));
+
+	// The blocks held by the fixture are most of what is live.
+	EXPECT_GT(total, int64_t(16 * 1024 * 1024 / 2));
+
+	const auto allocations = Capture([](int fd) { return npas4::WriteHeapProfileFolded(fd, npas4::HeapProfileValue::AllocObjects); });
+	EXPECT_FALSE(allocations.empty());
+}
+
+TEST(HeapProfileWriterFailure, BadDescriptor)
+{
+	npas4::HeapProfileWriteOptions options;
+	options.Gzip = false;
+	EXPECT_FALSE(npas4::WriteHeapProfile(-1, options));
+}
@@ -0,0 +1,207 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/HeapProfiler.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const int64_t Interval{64 * 1024};
+
+	std::vector<char*> AllocateBlocks(size_t count, size_t size)
+	{
+		std::vector<char*> blocks;
+		blocks.reserve(count);
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			blocks.push_back(new char[size]);
+			blocks.back()[0] = static_cast<char>(i);
+		}
+
+		return blocks;
+	}
+
+	void FreeBlocks(std::vector<char*>& blocks)
+	{
+		for(auto i : blocks)
+		{
+			delete[] i;
+		}
+
+		blocks.clear();
+	}
+
+	///
+	/// Allocates enough for the calling thread to notice the profiler starting or stopping.
+	///
+	void Notice()
+	{
+		auto blocks = AllocateBlocks(256, 1024);
+		FreeBlocks(blocks);
+	}
+
+	int64_t SumLiveBytes()
+	{
+		int64_t total{0};
+
+		npas4::VisitHeapProfile([&total](const npas4::HeapProfileStack& x) { total += x.LiveBytes; });
+		return total;
+	}
+
+	///
+	/// Samples with one way of capturing stacks, and checks that the stacks were recorded.
+	///
+	void CaptureStacks(bool framePointers)
+	{
+		npas4::HeapProfilerOptions options;
+		options.Interval = Interval;
+		options.FramePointers = framePointers;
+		ASSERT_TRUE(npas4::StartHeapProfiler(options));
+
+		const auto before = npas4::GetHeapProfileReport();
+		auto blocks = AllocateBlocks(4096, 1024);
+		EXPECT_GT(npas4::GetHeapProfileReport().Samples, before.Samples);
+
+		size_t walked{0};
+		const auto visited = npas4::VisitHeapProfile([&walked](const npas4::HeapProfileStack& x) { walked += (x.Depth > 0) ? 1 : 0; });
+		EXPECT_EQ(static_cast<size_t>(npas4::GetHeapProfileReport().Stacks), visited);
+		EXPECT_GT(walked, size_t(0));
+
+		npas4::StopHeapProfiler();
+		FreeBlocks(blocks);
+	}
+} // namespace
+
+TEST(HeapProfiler, InvalidOptions)
+{
+	npas4::HeapProfilerOptions x;
+	x.Interval = 0;
+	EXPECT_FALSE(npas4::StartHeapProfiler(x));
+	EXPECT_FALSE(npas4::IsHeapProfilerRunning());
+}
+
+TEST(HeapProfiler, Estimate)
+{
+	npas4::HeapProfilerOptions options;
+	options.Interval = Interval;
+	ASSERT_TRUE(npas4::StartHeapProfiler(options));
+	EXPECT_TRUE(npas4::IsHeapProfilerRunning());
+
+	Notice();
+
+	const auto before = npas4::GetHeapProfileReport();
+	const auto liveBefore = SumLiveBytes();
+
+	const int64_t bytes{64 * 1024 * 1024};
+	auto blocks = AllocateBlocks(bytes / 1024, 1024);
+
+	const auto during = npas4::GetHeapProfileReport();
+	EXPECT_EQ(Interval, during.Interval);
+
+	// About one sample per interval: 1024 expected, and well within these bounds.
+	const auto samples = during.Samples - before.Samples;
+	EXPECT_GT(samples, int64_t(700));
+	EXPECT_LT(samples, int64_t(1400));
+	EXPECT_EQ(before.Dropped, during.Dropped);
+	EXPECT_GT(during.Stacks, int64_t(0));
+
+	const auto live = SumLiveBytes() - liveBefore;
+	EXPECT_NEAR(static_cast<double>(bytes), static_cast<double>(live), bytes * 0.25);
+
+	size_t deepest{0};
+	npas4::VisitHeapProfile([&deepest](const npas4::HeapProfileStack& x) {
+		deepest = std::max(deepest, x.Depth);
+		EXPECT_GE(x.AllocatedSamples, x.LiveSamples);
+		EXPECT_GE(x.AllocatedBytes, x.LiveBytes);
+	});
+
+	EXPECT_GT(deepest, size_t(1));
+
+	FreeBlocks(blocks);
+
+	// Freed samples leave the live counts, but not the allocated ones.
+	EXPECT_LT(SumLiveBytes() - liveBefore, bytes / 8);
+	EXPECT_GE(npas4::GetHeapProfileReport().Samples, during.Samples);
+}
+
+TEST(HeapProfiler, Stop)
+{
+	npas4::HeapProfilerOptions options;
+	options.Interval = Interval;
+	ASSERT_TRUE(npas4::StartHeapProfiler(options));
+
+	auto blocks = AllocateBlocks(1024, 1024);
+
+	npas4::StopHeapProfiler();
+	EXPECT_FALSE(npas4::IsHeapProfilerRunning());
+
+	Notice();
+
+	const auto before = npas4::GetHeapProfileReport();
+	auto more = AllocateBlocks(16 * 1024, 1024);
+	EXPECT_EQ(before.Samples, npas4::GetHeapProfileReport().Samples);
+
+	// Samples taken while running are still removed when freed.
+	FreeBlocks(blocks);
+	EXPECT_LT(npas4::GetHeapProfileReport().LiveSamples, before.LiveSamples);
+
+	FreeBlocks(more);
+}
+
+TEST(HeapProfiler, FramePointers)
+{
+	CaptureStacks(true);
+}
+
+TEST(HeapProfiler, Backtrace)
+{
+	CaptureStacks(false);
+}
+
+TEST(HeapProfiler, EverySampleFreed)
+{
+	npas4::HeapProfilerOptions options;
+	options.Interval = 4096;
+	ASSERT_TRUE(npas4::StartHeapProfiler(options));
+
+	std::vector<char*> blocks;
+	blocks.reserve(4096);
+
+	Notice();
+
+	const auto before = npas4::GetHeapProfileReport();
+
+	// Sizes from a few bytes to a few pages, so that the samples span malloc's size classes.
+	for(size_t i = 0; i < 4096; ++i)
+	{
+		blocks.push_back(new char[1 + (i * 37) % 16384]);
+	}
+
+	const auto during = npas4::GetHeapProfileReport();
+	EXPECT_GT(during.LiveSamples - before.LiveSamples, int64_t(1000));
+
+	npas4::StopHeapProfiler();
+
+	// operator delete finds every sampled block, so none is left live.
+	FreeBlocks(blocks);
+	EXPECT_EQ(before.LiveSamples, npas4::GetHeapProfileReport().LiveSamples);
+}
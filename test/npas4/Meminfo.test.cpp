@@ -0,0 +1,117 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <Snapshot.h>
+#include <gtest/gtest.h>
+#include <npas4/Meminfo.h>
+#include <npas4/SnapshotReader.h>
+
+#include <cstring>
+
+TEST(Meminfo, Parse)
+{
+	const char text[] =
+		"MemTotal:       16308020 kB\n"
+		"MemFree:          203532 kB\n"
+		"MemAvailable:    9912344 kB\n"
+		"Buffers:          412000 kB\n"
+		"Cached:          8800000 kB\n"
+		"SwapCached:         1024 kB\n"
+		"SwapTotal:       2097148 kB\n"
+		"SwapFree:        2000000 kB\n"
+		"Dirty:               640 kB\n"
+		"Writeback:             8 kB\n"
+		"Shmem:            300000 kB\n"
+		"SReclaimable:     500000 kB\n";
+
+	npas4::MeminfoReport x;
+	npas4::impl::ParseMeminfo(text, strlen(text), x);
+
+	EXPECT_EQ(int64_t(16308020) * 1024, x.MemTotal);
+	EXPECT_EQ(int64_t(203532) * 1024, x.MemFree);
+	EXPECT_EQ(int64_t(9912344) * 1024, x.MemAvailable);
+	EXPECT_EQ(int64_t(412000) * 1024, x.Buffers);
+	EXPECT_EQ(int64_t(8800000) * 1024, x.Cached);
+	EXPECT_EQ(int64_t(1024) * 1024, x.SwapCached);
+	EXPECT_EQ(int64_t(500000) * 1024, x.SReclaimable);
+	EXPECT_EQ(int64_t(300000) * 1024, x.Shmem);
+	EXPECT_EQ(int64_t(640) * 1024, x.Dirty);
+	EXPECT_EQ(int64_t(8) * 1024, x.Writeback);
+	EXPECT_EQ(int64_t(2097148) * 1024, x.SwapTotal);
+	EXPECT_EQ(int64_t(2000000) * 1024, x.SwapFree);
+
+	// Reclaimable page cache counts as available physical memory.
+	npas4::impl::SystemSnapshot snapshot;
+	npas4::impl::ParseMeminfo(text, strlen(text), snapshot);
+
+	EXPECT_EQ(x.MemTotal, snapshot.PhysicalTotal);
+	EXPECT_EQ(x.MemAvailable, snapshot.PhysicalAvailable);
+	EXPECT_EQ(x.SwapTotal, snapshot.VirtualTotal);
+	EXPECT_EQ(x.SwapFree, snapshot.VirtualAvailable);
+	EXPECT_EQ(x.MemTotal + x.SwapTotal, snapshot.SystemTotal);
+	EXPECT_EQ(x.MemAvailable + x.SwapFree, snapshot.SystemAvailable);
+}
+
+TEST(Meminfo, EstimatesMissingMemAvailable)
+{
+	// Kernels before 3.14 do not report MemAvailable.
+	const char text[] =
+		"MemTotal:       1000 kB\n"
+		"MemFree:         100 kB\n"
+		"Buffers:          50 kB\n"
+		"Cached:          400 kB\n"
+		"Shmem:           150 kB\n"
+		"SReclaimable:     20 kB\n";
+
+	npas4::MeminfoReport x;
+	npas4::impl::ParseMeminfo(text, strlen(text), x);
+
+	EXPECT_EQ(int64_t(100 + 50 + 400 + 20 - 150) * 1024, x.MemAvailable);
+}
+
+TEST(Meminfo, ZeroMemAvailable)
+{
+	// A reported zero is a real value, not a missing key.
+	const char text[] =
+		"MemTotal:       1000 kB\n"
+		"MemFree:          10 kB\n"
+		"MemAvailable:      0 kB\n"
+		"Cached:          400 kB\n";
+
+	npas4::MeminfoReport x;
+	npas4::impl::ParseMeminfo(text, strlen(text), x);
+
+	EXPECT_EQ(int64_t(0), x.MemAvailable);
+}
+
+TEST(Meminfo, Live)
+{
+	const auto x = npas4::GetMeminfoReport();
+
+	EXPECT_GT(x.MemTotal, int64_t(0));
+	EXPECT_GT(x.MemAvailable, int64_t(0));
+	EXPECT_LE(x.MemAvailable, x.MemTotal);
+	EXPECT_GE(x.MemAvailable + x.Cached + x.Buffers, x.MemFree);
+
+	// Both come from MemAvailable; allow for other activity between the reads.
+	EXPECT_NEAR(static_cast<double>(x.MemAvailable), static_cast<double>(npas4::GetRAMPhysicalAvailable()), 64.0 * 1024.0 * 1024.0);
+	EXPECT_EQ(x.MemTotal, npas4::GetRAMPhysicalTotal());
+
+	npas4::SnapshotReader reader;
+	EXPECT_EQ(x.MemTotal, reader.GetMeminfoReport().MemTotal);
+}
@@ -0,0 +1,225 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Allocations.h>
+#include <npas4/MemoryTag.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	///
+	/// Stores each pointer where the optimizer cannot see it, so that new and delete pairs are not elided.
+	///
+	void* volatile Sink{nullptr};
+
+	template <typename T>
+	T* Keep(T* x)
+	{
+		Sink = x;
+		return x;
+	}
+
+	npas4::MemoryTagReport GetReport(int id)
+	{
+		for(const auto& i : npas4::GetMemoryTagReports())
+		{
+			if(i.Id == id)
+			{
+				return i;
+			}
+		}
+
+		return npas4::MemoryTagReport();
+	}
+} // namespace
+
+TEST(MemoryTag, Register)
+{
+	const auto parser = npas4::RegisterMemoryTag("test.parser");
+	EXPECT_GT(parser, 0);
+	EXPECT_EQ(parser, npas4::RegisterMemoryTag("test.parser"));
+	EXPECT_NE(parser, npas4::RegisterMemoryTag("test.renderer"));
+	EXPECT_EQ(0, npas4::RegisterMemoryTag("untagged"));
+	EXPECT_EQ(0, npas4::RegisterMemoryTag(nullptr));
+
+	EXPECT_EQ("test.parser", GetReport(parser).Name);
+}
+
+TEST(MemoryTag, Nesting)
+{
+	EXPECT_EQ(0, npas4::MemoryTag::GetCurrent());
+
+	{
+		npas4::MemoryTag outer("test.outer");
+		const auto id = npas4::MemoryTag::GetCurrent();
+		EXPECT_GT(id, 0);
+
+		{
+			npas4::MemoryTag inner("test.inner");
+			EXPECT_NE(id, npas4::MemoryTag::GetCurrent());
+		}
+
+		EXPECT_EQ(id, npas4::MemoryTag::GetCurrent());
+
+		// Unregistered ids are untagged.
+		npas4::MemoryTag invalid(100000);
+		EXPECT_EQ(0, npas4::MemoryTag::GetCurrent());
+	}
+
+	EXPECT_EQ(0, npas4::MemoryTag::GetCurrent());
+}
+
+TEST(MemoryTag, Attribution)
+{
+	const auto id = npas4::RegisterMemoryTag("test.attribution");
+	const auto before = GetReport(id);
+
+	std::vector<std::unique_ptr<char[]>> blocks;
+	blocks.reserve(100);
+
+	{
+		npas4::MemoryTag tag(id);
+
+		for(int i = 0; i < 100; ++i)
+		{
+			blocks.emplace_back(Keep(new char[1000]));
+		}
+	}
+
+	// Outside the scope: untagged.
+	std::unique_ptr<char[]> other(Keep(new char[50000]));
+
+	auto during = GetReport(id);
+	EXPECT_EQ(int64_t(100), during.Allocations - before.Allocations);
+	EXPECT_GE(during.LiveBytes - before.LiveBytes, int64_t(100 * 1000));
+	EXPECT_LT(during.LiveBytes - before.LiveBytes, int64_t(100 * 1100));
+
+	// Freed from another thread, under another tag, but still charged to the tag it was allocated under.
+	std::thread([&blocks]() {
+		npas4::MemoryTag tag("test.other");
+		blocks.clear();
+	}).join();
+
+	const auto after = GetReport(id);
+	EXPECT_EQ(before.LiveBytes, after.LiveBytes);
+	EXPECT_EQ(int64_t(100), after.Deallocations - before.Deallocations);
+
+	// The peak is only as exact as the batches each thread reports it in.
+	EXPECT_GE(after.PeakBytes + 64 * 1024, during.LiveBytes);
+}
+
+TEST(MemoryTag, Sum)
+{
+	// Every allocation is charged to exactly one tag, give or take the report's own allocations while it was being built.
+	const auto reports = npas4::GetMemoryTagReports();
+	const auto total = npas4::GetAllocationReport().LiveBytes;
+
+	int64_t live{0};
+
+	for(const auto& i : reports)
+	{
+		live += i.LiveBytes;
+	}
+
+	EXPECT_NEAR(static_cast<double>(total), static_cast<double>(live), 4096.0);
+}
+
+TEST(MemoryTag, Top)
+{
+	const auto id = npas4::RegisterMemoryTag("test.top");
+	std::unique_ptr<char[]> x;
+
+	{
+		npas4::MemoryTag tag(id);
+		x.reset(Keep(new char[256 * 1024 * 1024]));
+	}
+
+	const auto reports = npas4::GetMemoryTagReports(1);
+	ASSERT_EQ(size_t(1), reports.size());
+	EXPECT_EQ(id, reports[0].Id);
+	EXPECT_GE(reports[0].PeakBytes, int64_t(256 * 1024 * 1024));
+}
+
+TEST(MemoryTag, TaggedAllocator)
+{
+	const auto id = npas4::RegisterMemoryTag("test.allocator");
+	const auto before = GetReport(id);
+
+	{
+		npas4::TaggedAllocator<int> allocator(id);
+		std::vector<int, npas4::TaggedAllocator<int>> x(allocator);
+
+		// Allocated under a different tag, but charged to the allocator's.
+		npas4::MemoryTag tag("test.elsewhere");
+		x.resize(10000);
+
+		EXPECT_GE(GetReport(id).LiveBytes - before.LiveBytes, int64_t(10000 * sizeof(int)));
+	}
+
+	EXPECT_EQ(before.LiveBytes, GetReport(id).LiveBytes);
+}
+
+TEST(MemoryTag, Budget)
+{
+	const auto id = npas4::RegisterMemoryTag("test.budget");
+	npas4::SetMemoryTagBudget(id, 1024 * 1024);
+	EXPECT_EQ(int64_t(1024 * 1024), npas4::GetMemoryTagBudget(id));
+	EXPECT_FALSE(npas4::IsMemoryTagOverBudget(id));
+
+	std::vector<std::unique_ptr<char[]>> blocks;
+	blocks.reserve(128);
+
+	{
+		npas4::MemoryTag tag(id);
+
+		for(int i = 0; i < 128; ++i)
+		{
+			blocks.emplace_back(Keep(new char[16 * 1024]));
+		}
+	}
+
+	// 2 MB live against a 1 MB budget.
+	EXPECT_TRUE(npas4::IsMemoryTagOverBudget(id));
+
+	auto report = GetReport(id);
+	EXPECT_EQ(int64_t(1024 * 1024), report.Budget);
+	EXPECT_TRUE(report.OverBudget);
+	EXPECT_EQ(int64_t(1), report.BudgetExceeded);
+
+	blocks.clear();
+	EXPECT_FALSE(npas4::IsMemoryTagOverBudget(id));
+
+	// Lowering the budget below what is live marks the tag at once.
+	{
+		npas4::MemoryTag tag(id);
+		blocks.emplace_back(Keep(new char[512 * 1024]));
+	}
+
+	EXPECT_FALSE(npas4::IsMemoryTagOverBudget(id));
+	npas4::SetMemoryTagBudget(id, 256 * 1024);
+	EXPECT_TRUE(npas4::IsMemoryTagOverBudget(id));
+	EXPECT_EQ(int64_t(2), GetReport(id).BudgetExceeded);
+
+	npas4::SetMemoryTagBudget(id, 0);
+	EXPECT_FALSE(npas4::IsMemoryTagOverBudget(id));
+	EXPECT_FALSE(npas4::IsMemoryTagOverBudget(100000));
+}
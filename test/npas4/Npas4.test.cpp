@@ -42,6 +42,79 @@ TEST(npas4, Report)
 	EXPECT_NE(int64_t(0), npas4::GetRAMPhysicalUsedByCurrentProcess());
 }
 
+TEST(npas4, ReportSnapshot)
+{
+	const auto report = npas4::GetRAMReport();
+
+	EXPECT_NE(int64_t(0), report.RamSystemTotal);
+	EXPECT_NE(int64_t(0), report.RamPhysicalTotal);
+	EXPECT_NE(int64_t(0), report.RamPhysicalUsedByCurrentProcess);
+	EXPECT_NE(int64_t(0), report.RamPhysicalUsedByCurrentProcessPeak);
+	EXPECT_NE(int64_t(0), report.RamVirtualUsedByCurrentProcess);
+
+	// All fields come from the same snapshot, so they must be self-consistent.
+	EXPECT_EQ(report.RamSystemTotal, report.RamSystemAvailable + report.RamSystemUsed);
+	EXPECT_EQ(report.RamPhysicalTotal, report.RamPhysicalAvailable + report.RamPhysicalUsed);
+	EXPECT_EQ(report.RamVirtualTotal, report.RamVirtualAvailable + report.RamVirtualUsed);
+	EXPECT_GE(report.RamPhysicalUsedByCurrentProcessPeak, report.RamPhysicalUsedByCurrentProcess);
+	EXPECT_EQ(npas4::GetRAMPhysicalTotal(), report.RamPhysicalTotal);
+}
+
+TEST(npas4, ReportFieldMask)
+{
+	const auto fields = npas4::RAMReportField::PhysicalAvailable | npas4::RAMReportField::PhysicalUsedByCurrentProcess;
+	const auto report = npas4::GetRAMReport(fields);
+
+	EXPECT_GT(report.RamPhysicalAvailable, int64_t(0));
+	EXPECT_GT(report.RamPhysicalUsedByCurrentProcess, int64_t(0));
+	EXPECT_EQ(int64_t(0), report.RamPhysicalTotal);
+	EXPECT_EQ(int64_t(0), report.RamSystemTotal);
+	EXPECT_EQ(int64_t(0), report.RamPhysicalUsedByCurrentProcessPeak);
+	EXPECT_EQ(int64_t(0), report.RamVirtualUsedByCurrentProcess);
+
+	const auto none = npas4::GetRAMReport(0);
+	EXPECT_EQ(int64_t(0), none.RamPhysicalAvailable);
+	EXPECT_EQ(int64_t(0), none.RamPhysicalUsedByCurrentProcess);
+
+	const auto all = npas4::GetRAMReport(npas4::RAMReportField::All);
+	EXPECT_EQ(npas4::GetRAMPhysicalTotal(), all.RamPhysicalTotal);
+	EXPECT_GT(all.RamPhysicalUsedByCurrentProcessPeak, int64_t(0));
+	EXPECT_EQ(all.RamSystemTotal, all.RamSystemAvailable + all.RamSystemUsed);
+}
+
+TEST(npas4, ProcessQueryModeLowLatency)
+{
+	EXPECT_EQ(npas4::ProcessQueryMode::Status, npas4::GetProcessQueryMode());
+
+	const auto physical = npas4::GetRAMPhysicalUsedByCurrentProcess();
+	const auto virtualSize = npas4::GetRAMVirtualUsedByCurrentProcess();
+
+	npas4::SetProcessQueryMode(npas4::ProcessQueryMode::LowLatency);
+	EXPECT_EQ(npas4::ProcessQueryMode::LowLatency, npas4::GetProcessQueryMode());
+
+	// statm and status report the same counters, in pages and kilobytes respectively.
+	EXPECT_NEAR(static_cast<double>(physical), static_cast<double>(npas4::GetRAMPhysicalUsedByCurrentProcess()), 1024.0 * 1024.0);
+	EXPECT_NEAR(static_cast<double>(virtualSize), static_cast<double>(npas4::GetRAMVirtualUsedByCurrentProcess()), 1024.0 * 1024.0);
+	EXPECT_GT(npas4::GetRAMSystemUsedByCurrentProcess(), int64_t(0));
+
+	npas4::SetProcessQueryMode(npas4::ProcessQueryMode::Status);
+}
+
+TEST(npas4, ExtendedReport)
+{
+	auto report = npas4::GetExtendedReport();
+
+	EXPECT_GT(report.RamPhysicalUsedByCurrentProcess, int64_t(0));
+	EXPECT_GT(report.RamVirtualUsedByCurrentProcess, report.RamPhysicalUsedByCurrentProcess);
+	EXPECT_GT(report.RamSharedByCurrentProcess, int64_t(0));
+	EXPECT_GT(report.RamTextByCurrentProcess, int64_t(0));
+	EXPECT_GT(report.RamDataByCurrentProcess, int64_t(0));
+
+	const auto delta = report - report;
+	EXPECT_EQ(int64_t(0), delta.RamDataByCurrentProcess);
+	EXPECT_FALSE(static_cast<std::string>(report).empty());
+}
+
 // TEST(npas4, SystemHas32GB)
 // {
 // 	// Sanity check that my system reports about 32GB of physical RAM.
@@ -0,0 +1,144 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Peak.h>
+#include <npas4/Sampler.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+	const int64_t SpikeBytes{32 * 1024 * 1024};
+
+	///
+	/// Maps and touches SpikeBytes, calls hold(), and unmaps it.  Mapped directly, since the allocator may keep freed memory (glibc raises
+	/// its mmap threshold after large blocks are freed).
+	///
+	template <typename F>
+	void Spike(F hold)
+	{
+#ifdef WIN32
+		std::vector<char> memory(SpikeBytes);
+		memset(memory.data(), 1, memory.size());
+		hold();
+#else
+		const auto memory = mmap(nullptr, SpikeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		ASSERT_NE(MAP_FAILED, memory);
+		memset(memory, 1, SpikeBytes);
+		hold();
+		munmap(memory, SpikeBytes);
+#endif
+	}
+
+	void Spike()
+	{
+		Spike([]() {});
+	}
+
+	///
+	/// Waits until done() returns true, however slowly a sampling thread is scheduled, giving up after five seconds.
+	///
+	template <typename F>
+	void WaitFor(F done)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+		while(done() == false && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	///
+	/// Spikes until a scope has seen the spike (at once, unless the scope's peak is sampled).
+	///
+	void SpikeUntilSeen(const npas4::ScopedPeak& x)
+	{
+		Spike([&x]() { WaitFor([&x]() { return x.GetPeakIncrease() >= SpikeBytes * 3 / 4; }); });
+	}
+} // namespace
+
+TEST(Peak, ResetPeak)
+{
+	Spike();
+
+	const auto before = npas4::GetRAMPhysicalUsedByCurrentProcessPeak();
+	EXPECT_GE(before, SpikeBytes);
+
+	if(npas4::ResetPeak() == true)
+	{
+		const auto after = npas4::GetRAMPhysicalUsedByCurrentProcessPeak();
+		EXPECT_LT(after, before - SpikeBytes / 2);
+		EXPECT_GE(after, npas4::GetRAMPhysicalUsedByCurrentProcess() / 2);
+	}
+}
+
+TEST(Peak, ScopedPeak)
+{
+	npas4::ScopedPeak scope;
+	EXPECT_GT(scope.GetStart(), int64_t(0));
+
+	SpikeUntilSeen(scope);
+
+	EXPECT_GE(scope.GetPeakIncrease(), SpikeBytes * 3 / 4);
+	EXPECT_EQ(scope.GetPeak() - scope.GetStart(), scope.GetPeakIncrease());
+}
+
+TEST(Peak, Nested)
+{
+	npas4::ScopedPeak outer;
+	SpikeUntilSeen(outer);
+
+	npas4::ScopedPeak inner;
+
+	// The inner scope's reset must not hide the outer scope's spike.
+	EXPECT_GE(outer.GetPeakIncrease(), SpikeBytes * 3 / 4);
+
+	if(inner.IsExact() == true)
+	{
+		EXPECT_LT(inner.GetPeakIncrease(), SpikeBytes / 2);
+	}
+}
+
+TEST(Peak, Sampler)
+{
+	npas4::Sampler sampler(std::chrono::milliseconds(1));
+
+	// Waits for the sampler to take a few samples.
+	const auto wait = [&sampler]() {
+		const auto target = sampler.GetSampleCount() + 3;
+		WaitFor([&sampler, target]() { return sampler.GetSampleCount() >= target; });
+	};
+
+	// Held until the sampler has seen it, then freed and seen to be freed.
+	Spike(wait);
+	wait();
+
+	const auto peak = sampler.GetPeak();
+	EXPECT_GE(peak, sampler.GetLatest().Report.RamPhysicalUsedByCurrentProcess + SpikeBytes / 2);
+
+	sampler.ResetPeak();
+	EXPECT_LT(sampler.GetPeak(), peak - SpikeBytes / 2);
+}
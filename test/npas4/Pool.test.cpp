@@ -0,0 +1,191 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Pool.h>
+
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct Node
+	{
+		Node(int key, double value) : Key{key}, Value{value}
+		{
+		}
+
+		int Key;
+		double Value;
+		Node* Next{nullptr};
+	};
+
+	struct alignas(64) Aligned
+	{
+		char Data[64];
+	};
+
+	struct Throws
+	{
+		Throws()
+		{
+			throw std::runtime_error("Throws");
+		}
+	};
+} // namespace
+
+TEST(Pool, CreateDestroy)
+{
+	npas4::Pool<Node> x("test.nodes");
+
+	std::vector<Node*> nodes;
+	std::set<Node*> unique;
+
+	for(int i = 0; i < 1000; ++i)
+	{
+		nodes.push_back(x.Create(i, i * 0.5));
+		unique.insert(nodes.back());
+	}
+
+	EXPECT_EQ(size_t(1000), unique.size());
+	EXPECT_EQ(999, nodes[999]->Key);
+
+	auto report = x.GetReport();
+	EXPECT_EQ("test.nodes", report.Name);
+	EXPECT_EQ("pool", report.Type);
+	EXPECT_EQ(int64_t(1000 * sizeof(Node)), report.UsedBytes);
+	EXPECT_GE(report.CommittedBytes, report.UsedBytes);
+
+	for(auto i : nodes)
+	{
+		x.Destroy(i);
+	}
+
+	x.Destroy(nullptr);
+
+	report = x.GetReport();
+	EXPECT_EQ(int64_t(0), report.UsedBytes);
+	EXPECT_GE(report.PeakUsedBytes, int64_t(1000 * sizeof(Node)));
+
+	// Freed blocks are reused before any more are carved.
+	const auto committed = report.CommittedBytes;
+
+	for(int i = 0; i < 1000; ++i)
+	{
+		nodes[i] = x.Create(i, 0.0);
+	}
+
+	EXPECT_EQ(committed, x.GetReport().CommittedBytes);
+
+	for(auto i : nodes)
+	{
+		x.Destroy(i);
+	}
+}
+
+TEST(Pool, Alignment)
+{
+	npas4::Pool<Aligned> x;
+
+	for(int i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(uintptr_t(0), reinterpret_cast<uintptr_t>(x.Create()) % 64);
+	}
+}
+
+TEST(Pool, ConstructorThrows)
+{
+	npas4::Pool<Throws> x;
+	EXPECT_THROW(x.Create(), std::runtime_error);
+	EXPECT_EQ(int64_t(0), x.GetReport().UsedBytes);
+}
+
+TEST(Pool, Threads)
+{
+	npas4::Pool<Node> x("test.threads");
+
+	// Each thread frees what the previous one allocated, so blocks move between caches.
+	std::vector<Node*> nodes;
+
+	for(int i = 0; i < 1000; ++i)
+	{
+		nodes.push_back(x.Create(i, 0.0));
+	}
+
+	std::vector<std::thread> threads;
+
+	for(int i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([&x]() {
+			std::vector<Node*> mine;
+
+			for(int j = 0; j < 10000; ++j)
+			{
+				mine.push_back(x.Create(j, 0.0));
+
+				if(mine.size() > 100)
+				{
+					for(auto k : mine)
+					{
+						x.Destroy(k);
+					}
+
+					mine.clear();
+				}
+			}
+
+			for(auto k : mine)
+			{
+				x.Destroy(k);
+			}
+		});
+	}
+
+	for(auto& i : threads)
+	{
+		i.join();
+	}
+
+	EXPECT_EQ(int64_t(1000 * sizeof(Node)), x.GetReport().UsedBytes);
+
+	std::thread([&x, &nodes]() {
+		for(auto i : nodes)
+		{
+			x.Destroy(i);
+		}
+	}).join();
+
+	EXPECT_EQ(int64_t(0), x.GetReport().UsedBytes);
+}
+
+TEST(Pool, Registry)
+{
+	npas4::Pool<Node> x("test.registered");
+	x.Destroy(x.Create(1, 1.0));
+
+	auto found = false;
+
+	for(const auto& i : npas4::GetArenaReports())
+	{
+		found = found || (i.Name == "test.registered" && i.Type == "pool");
+	}
+
+	EXPECT_TRUE(found);
+}
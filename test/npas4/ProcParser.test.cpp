@@ -0,0 +1,112 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <ProcParser.h>
+
+#include <cstring>
+
+TEST(ProcParser, HashKeyMatchesAtCompileAndRunTime)
+{
+	static_assert(npas4::impl::HashKey("VmRSS", 5) != npas4::impl::HashKey("VmHWM", 5), "HashKey must be a constant expression");
+
+	EXPECT_EQ(npas4::impl::HashKey("VmRSS", 5), npas4::impl::HashKeyRuntime("VmRSS", 5));
+	EXPECT_EQ(npas4::impl::HashKey("Inactive(anon)", 14), npas4::impl::HashKeyRuntime("Inactive(anon)", 14));
+	EXPECT_EQ(npas4::impl::HashKey("", 0), npas4::impl::HashKeyRuntime("", 0));
+}
+
+TEST(ProcParser, Status)
+{
+	const char text[] =
+		"Name:\tTestNpas4\n"
+		"Umask:\t0022\n"
+		"VmPeak:\t   20000 kB\n"
+		"VmSize:\t   19000 kB\n"
+		"VmHWM:\t    4000 kB\n"
+		"VmRSS:\t    3000 kB\n"
+		"VmSwap:\t       0 kB\n"
+		"Threads:\t1\n";
+
+	npas4::impl::StatusFields fields;
+	const auto stored = npas4::impl::ParseKeyValues(text, strlen(text), fields);
+
+	EXPECT_EQ(size_t(5), stored);
+	EXPECT_EQ(int64_t(20000) * 1024, fields.VmPeak);
+	EXPECT_EQ(int64_t(19000) * 1024, fields.VmSize);
+	EXPECT_EQ(int64_t(4000) * 1024, fields.VmHWM);
+	EXPECT_EQ(int64_t(3000) * 1024, fields.VmRSS);
+	EXPECT_EQ(int64_t(0), fields.VmSwap);
+	EXPECT_EQ(int64_t(0), fields.VmLck);
+}
+
+TEST(ProcParser, MeminfoParenthesizedKeys)
+{
+	const char text[] =
+		"MemTotal:       16308020 kB\n"
+		"MemFree:         1203532 kB\n"
+		"MemAvailable:    9912344 kB\n"
+		"Active(anon):     102400 kB\n"
+		"Committed_AS:    7340032 kB\n"
+		"HugePages_Total:       0\n";
+
+	npas4::impl::MeminfoFields fields;
+	npas4::impl::ParseKeyValues(text, strlen(text), fields);
+
+	EXPECT_EQ(int64_t(16308020) * 1024, fields.MemTotal);
+	EXPECT_EQ(int64_t(1203532) * 1024, fields.MemFree);
+	EXPECT_EQ(int64_t(9912344) * 1024, fields.MemAvailable);
+	EXPECT_EQ(int64_t(102400) * 1024, fields.ActiveAnon);
+	EXPECT_EQ(int64_t(7340032) * 1024, fields.CommittedAS);
+}
+
+TEST(ProcParser, LargeValuesDoNotOverflow)
+{
+	// 8 TB expressed in kB overflows a 32 bit int.
+	const char text[] = "MemTotal:       8589934592 kB\n";
+
+	npas4::impl::MeminfoFields fields;
+	npas4::impl::ParseKeyValues(text, strlen(text), fields);
+
+	EXPECT_EQ(int64_t(8589934592) * 1024, fields.MemTotal);
+}
+
+TEST(ProcParser, Accumulate)
+{
+	const char text[] = "Rss: 4 kB\nPss: 2 kB\nRss: 8 kB\nPss: 3 kB\n";
+
+	npas4::impl::SmapsFields fields;
+	EXPECT_EQ(size_t(4), npas4::impl::AccumulateKeyValues(text, strlen(text), fields));
+
+	EXPECT_EQ(int64_t(12) * 1024, fields.Rss);
+	EXPECT_EQ(int64_t(5) * 1024, fields.Pss);
+
+	npas4::impl::SmapsFields last;
+	npas4::impl::ParseKeyValues(text, strlen(text), last);
+	EXPECT_EQ(int64_t(8) * 1024, last.Rss);
+}
+
+TEST(ProcParser, MalformedInput)
+{
+	const char text[] = "no colon here\nVmRSS:\nVmSize: 12 kB";
+
+	npas4::impl::StatusFields fields;
+	npas4::impl::ParseKeyValues(text, strlen(text), fields);
+
+	EXPECT_EQ(int64_t(0), fields.VmRSS);
+	EXPECT_EQ(int64_t(12) * 1024, fields.VmSize);
+}
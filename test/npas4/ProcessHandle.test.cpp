@@ -0,0 +1,159 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/ProcessHandle.h>
+
+#include <cstring>
+#include <vector>
+
+#ifndef WIN32
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	const int64_t ChildBytes{64 * 1024 * 1024};
+
+	///
+	/// Forks a child that touches ChildBytes of memory and then blocks until killed.
+	///
+	pid_t SpawnChild()
+	{
+		int ready[2];
+
+		if(pipe(ready) != 0)
+		{
+			return -1;
+		}
+
+		const auto pid = fork();
+
+		if(pid == 0)
+		{
+			close(ready[0]);
+
+			std::vector<char> memory(ChildBytes);
+			memset(memory.data(), 1, memory.size());
+
+			const char byte = 1;
+			const auto written = write(ready[1], &byte, 1);
+			(void)written;
+
+			for(;;)
+			{
+				pause();
+			}
+		}
+
+		close(ready[1]);
+
+		char byte;
+		const auto bytes = read(ready[0], &byte, 1);
+		(void)bytes;
+		close(ready[0]);
+		return pid;
+	}
+} // namespace
+
+TEST(ProcessHandle, Child)
+{
+	const auto pid = SpawnChild();
+	ASSERT_GT(pid, 0);
+
+	npas4::ProcessHandle handle(pid);
+	EXPECT_TRUE(handle.IsOpen());
+	EXPECT_TRUE(handle.IsAlive());
+	EXPECT_EQ(int64_t(pid), handle.GetPid());
+
+	// Sample repeatedly to exercise re-reading the same descriptors.
+	for(int i = 0; i < 8; ++i)
+	{
+		npas4::ProcessReport report;
+		EXPECT_TRUE(handle.GetReport(report, true));
+		EXPECT_GE(report.RamPhysicalUsed, ChildBytes);
+		EXPECT_GE(report.RamPhysicalUsedPeak, report.RamPhysicalUsed);
+		EXPECT_GE(report.RamUniqueUsed, ChildBytes);
+		EXPECT_LE(report.RamProportionalUsed, report.RamPhysicalUsed);
+	}
+
+	// smaps_rollup is only read when asked for.
+	npas4::ProcessReport status;
+	EXPECT_TRUE(handle.GetReport(status));
+	EXPECT_GE(status.RamPhysicalUsed, ChildBytes);
+	EXPECT_EQ(int64_t(0), status.RamProportionalUsed);
+	EXPECT_EQ(int64_t(0), status.RamUniqueUsed);
+
+	EXPECT_GE(handle.GetRAMPhysicalUsed(), ChildBytes);
+	EXPECT_GT(handle.GetRAMVirtualUsed(), ChildBytes);
+	EXPECT_GE(handle.GetRAMUniqueUsed(), ChildBytes);
+
+	EXPECT_GE(npas4::GetRAMPhysicalUsedByProcess(pid), ChildBytes);
+	EXPECT_GE(npas4::GetRAMPhysicalUsedByProcessPeak(pid), ChildBytes);
+	EXPECT_GE(npas4::GetRAMUniqueUsedByProcess(pid), ChildBytes);
+
+	// A zombie has no address space.
+	kill(pid, SIGKILL);
+	siginfo_t info;
+	waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOWAIT);
+
+	npas4::ProcessReport report;
+	EXPECT_FALSE(handle.IsAlive());
+	EXPECT_FALSE(handle.GetReport(report));
+	EXPECT_FALSE(handle.GetReport(report, true));
+	EXPECT_EQ(int64_t(0), report.RamPhysicalUsed);
+	EXPECT_EQ(int64_t(0), npas4::GetRAMPhysicalUsedByProcess(pid));
+
+	// Once reaped, the held descriptors stop working even though the handle stays valid.
+	waitpid(pid, nullptr, 0);
+
+	EXPECT_FALSE(handle.IsAlive());
+	EXPECT_FALSE(handle.GetReport(report));
+	EXPECT_EQ(int64_t(0), handle.GetRAMPhysicalUsed());
+	EXPECT_EQ(int64_t(0), handle.GetRAMVirtualUsed());
+	EXPECT_EQ(int64_t(0), handle.GetRAMProportionalUsed());
+	EXPECT_EQ(int64_t(0), npas4::GetRAMVirtualUsedByProcess(pid));
+}
+#endif
+
+TEST(ProcessHandle, MissingProcess)
+{
+	// Larger than any pid_max.
+	const int64_t pid{0x7FFFFFF0};
+
+	npas4::ProcessHandle handle(pid);
+	EXPECT_FALSE(handle.IsOpen());
+	EXPECT_FALSE(handle.IsAlive());
+
+	npas4::ProcessReport report;
+	EXPECT_FALSE(handle.GetReport(report));
+	EXPECT_EQ(int64_t(0), npas4::GetRAMPhysicalUsedByProcess(pid));
+	EXPECT_EQ(int64_t(0), npas4::GetRAMProportionalUsedByProcess(pid));
+}
+
+#ifndef WIN32
+TEST(ProcessHandle, CurrentProcess)
+{
+	npas4::ProcessHandle handle(getpid());
+
+	EXPECT_TRUE(handle.IsAlive());
+	EXPECT_NEAR(static_cast<double>(npas4::GetRAMVirtualUsedByCurrentProcess()), static_cast<double>(handle.GetRAMVirtualUsed()), 1024.0 * 1024.0);
+	EXPECT_GT(npas4::GetRAMSystemUsedByProcess(getpid()), int64_t(0));
+}
+#endif
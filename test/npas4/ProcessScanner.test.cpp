@@ -0,0 +1,149 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <Snapshot.h>
+#include <gtest/gtest.h>
+#include <npas4/ProcessScanner.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	///
+	/// A temporary directory laid out like /proc.
+	///
+	class FakeProc
+	{
+	public:
+		FakeProc()
+		{
+			char path[] = "/tmp/npas4-proc-XXXXXX";
+			this->root = mkdtemp(path);
+		}
+
+		~FakeProc()
+		{
+			nftw(this->root.c_str(), [](const char* x, const struct stat*, int, struct FTW*) { return remove(x); }, 16, FTW_DEPTH | FTW_PHYS);
+		}
+
+		void Add(const std::string& name, int64_t residentPages, int64_t sizePages, int64_t pssKb, int64_t ussKb)
+		{
+			mkdir((this->root + "/" + name).c_str(), 0755);
+			std::ofstream(this->root + "/" + name + "/statm") << sizePages << " " << residentPages << " 0 0 0 0 0\n";
+			std::ofstream(this->root + "/" + name + "/smaps_rollup")
+				<< "00400000-7fff0000 ---p 00000000 00:00 0 [rollup]\n"
+				<< "Rss:        " << ussKb << " kB\n"
+				<< "Pss:        " << pssKb << " kB\n"
+				<< "Private_Clean:        0 kB\n"
+				<< "Private_Dirty:        " << ussKb << " kB\n";
+		}
+
+		const std::string& Path() const
+		{
+			return this->root;
+		}
+
+	private:
+		std::string root;
+	};
+} // namespace
+
+TEST(ProcessScanner, FakeProc)
+{
+	const auto page = npas4::impl::PageSize();
+
+	FakeProc proc;
+	proc.Add("1", 10, 100, 40, 30);
+	proc.Add("20", 30, 50, 20, 10);
+	proc.Add("300", 20, 200, 80, 60);
+	proc.Add("4000", 30, 10, 10, 5);
+
+	// Not processes, or processes that have already exited.
+	mkdir((proc.Path() + "/self").c_str(), 0755);
+	mkdir((proc.Path() + "/55").c_str(), 0755);
+	std::ofstream(proc.Path() + "/66") << "not a directory\n";
+
+	npas4::ProcessScanner scanner(3, proc.Path());
+	EXPECT_EQ(size_t(3), scanner.GetThreadCount());
+
+	auto x = scanner.Scan();
+	ASSERT_EQ(size_t(4), x.Size());
+	EXPECT_EQ(x.Pid.size(), x.RamPhysicalUsed.size());
+	EXPECT_EQ(x.Pid.size(), x.RamVirtualUsed.size());
+	EXPECT_EQ(x.Pid.size(), x.RamProportionalUsed.size());
+	EXPECT_EQ(x.Pid.size(), x.RamUniqueUsed.size());
+
+	// Largest first, ties broken by pid.
+	EXPECT_EQ(int64_t(20), x.Pid[0]);
+	EXPECT_EQ(int64_t(4000), x.Pid[1]);
+	EXPECT_EQ(int64_t(300), x.Pid[2]);
+	EXPECT_EQ(int64_t(1), x.Pid[3]);
+	EXPECT_EQ(30 * page, x.RamPhysicalUsed[0]);
+	EXPECT_EQ(50 * page, x.RamVirtualUsed[0]);
+	EXPECT_EQ(int64_t(0), x.RamProportionalUsed[0]);
+
+	npas4::ScanOptions options;
+	options.SortBy = npas4::ScanKey::VirtualUsed;
+	options.Top = 2;
+
+	x = scanner.Scan(options);
+	ASSERT_EQ(size_t(2), x.Size());
+	EXPECT_EQ(int64_t(300), x.Pid[0]);
+	EXPECT_EQ(int64_t(1), x.Pid[1]);
+
+	// Sorting by a smaps value reads smaps_rollup.
+	options.SortBy = npas4::ScanKey::UniqueUsed;
+	options.Top = 10;
+
+	x = scanner.Scan(options);
+	ASSERT_EQ(size_t(4), x.Size());
+	EXPECT_EQ(int64_t(300), x.Pid[0]);
+	EXPECT_EQ(int64_t(60 * 1024), x.RamUniqueUsed[0]);
+	EXPECT_EQ(int64_t(80 * 1024), x.RamProportionalUsed[0]);
+	EXPECT_EQ(int64_t(4000), x.Pid[3]);
+}
+
+TEST(ProcessScanner, Live)
+{
+	npas4::ProcessScanner scanner(2);
+
+	npas4::ScanOptions options;
+	options.Smaps = true;
+
+	const auto x = scanner.Scan(options);
+	ASSERT_GT(x.Size(), size_t(0));
+
+	const auto self = std::find(std::begin(x.Pid), std::end(x.Pid), static_cast<int64_t>(getpid()));
+	ASSERT_NE(std::end(x.Pid), self);
+
+	const auto row = static_cast<size_t>(self - std::begin(x.Pid));
+	EXPECT_GT(x.RamPhysicalUsed[row], int64_t(0));
+	EXPECT_GE(x.RamVirtualUsed[row], x.RamPhysicalUsed[row]);
+	EXPECT_GT(x.RamProportionalUsed[row], int64_t(0));
+
+	EXPECT_TRUE(std::is_sorted(std::begin(x.RamPhysicalUsed), std::end(x.RamPhysicalUsed), [](int64_t a, int64_t b) { return a > b; }));
+}
+#endif
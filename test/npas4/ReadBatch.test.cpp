@@ -0,0 +1,157 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <ReadBatch.h>
+#include <gtest/gtest.h>
+#include <npas4/ProcessHandle.h>
+#include <npas4/SnapshotReader.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+	///
+	/// Reads ten small files, with more reads than the batch's capacity, and one invalid descriptor.
+	///
+	void ReadFiles(npas4::impl::ReadBatch::Backend backend)
+	{
+		char path[] = "/tmp/npas4-batch-XXXXXX";
+		const std::string root = mkdtemp(path);
+
+		int files[10];
+		char buffers[10][32];
+
+		for(int i = 0; i < 10; ++i)
+		{
+			const auto name = root + "/" + std::to_string(i);
+			FILE* f = fopen(name.c_str(), "w");
+			fprintf(f, "value %d", i * 111);
+			fclose(f);
+
+			files[i] = open(name.c_str(), O_RDONLY | O_CLOEXEC);
+			ASSERT_GE(files[i], 0);
+		}
+
+		npas4::impl::ReadBatch batch(4, backend);
+
+		if(backend == npas4::impl::ReadBatch::Backend::Pread)
+		{
+			EXPECT_FALSE(batch.IsRing());
+		}
+
+		// Twice, to check the batch can be reused.
+		for(int repeat = 0; repeat < 2; ++repeat)
+		{
+			batch.Clear();
+			memset(buffers, 0, sizeof(buffers));
+
+			for(int i = 0; i < 10; ++i)
+			{
+				EXPECT_EQ(size_t(i), batch.Add(files[i], buffers[i], sizeof(buffers[i]) - 1));
+			}
+
+			const auto invalid = batch.Add(-1, buffers[0], sizeof(buffers[0]));
+			EXPECT_EQ(size_t(11), batch.Size());
+
+			batch.Submit();
+
+			for(int i = 0; i < 10; ++i)
+			{
+				const auto expected = "value " + std::to_string(i * 111);
+				EXPECT_EQ(static_cast<int64_t>(expected.size()), batch.Result(i));
+				EXPECT_EQ(expected, std::string(buffers[i]));
+			}
+
+			EXPECT_EQ(int64_t(-1), batch.Result(invalid));
+		}
+
+		for(int i = 0; i < 10; ++i)
+		{
+			close(files[i]);
+			remove((root + "/" + std::to_string(i)).c_str());
+		}
+
+		remove(root.c_str());
+	}
+} // namespace
+
+TEST(ReadBatch, Automatic)
+{
+	ReadFiles(npas4::impl::ReadBatch::Backend::Automatic);
+}
+
+TEST(ReadBatch, Pread)
+{
+	ReadFiles(npas4::impl::ReadBatch::Backend::Pread);
+}
+
+TEST(ReadBatch, Empty)
+{
+	npas4::impl::ReadBatch batch(8);
+	batch.Submit();
+	EXPECT_EQ(size_t(0), batch.Size());
+	EXPECT_EQ(int64_t(-1), batch.Result(0));
+}
+
+TEST(ReadBatch, ProcessSet)
+{
+	npas4::ProcessSet set;
+	const auto self = set.Add(getpid());
+	const auto missing = set.Add(0x7ffffff0);
+
+	EXPECT_EQ(size_t(2), set.Size());
+	EXPECT_TRUE(set.GetHandle(self).IsOpen());
+	EXPECT_FALSE(set.GetHandle(missing).IsOpen());
+
+	std::vector<npas4::ProcessReport> x;
+	EXPECT_EQ(size_t(1), set.GetReports(x));
+	ASSERT_EQ(size_t(2), x.size());
+
+	EXPECT_GT(x[self].RamPhysicalUsed, int64_t(0));
+	EXPECT_GE(x[self].RamPhysicalUsedPeak, x[self].RamPhysicalUsed);
+	EXPECT_EQ(int64_t(0), x[self].RamUniqueUsed);
+	EXPECT_EQ(int64_t(0), x[missing].RamPhysicalUsed);
+	EXPECT_EQ(int64_t(0), x[missing].RamVirtualUsed);
+
+	EXPECT_EQ(size_t(1), set.GetReports(x, true));
+	EXPECT_GT(x[self].RamPhysicalUsed, int64_t(0));
+	EXPECT_GT(x[self].RamUniqueUsed, int64_t(0));
+	EXPECT_GT(x[self].RamProportionalUsed, int64_t(0));
+	EXPECT_EQ(int64_t(0), x[missing].RamUniqueUsed);
+}
+#endif
+
+TEST(ReadBatch, SnapshotReader)
+{
+	npas4::SnapshotReader reader;
+
+	// Batched twice in a row, to check the buffers are reset between samples.
+	for(int i = 0; i < 2; ++i)
+	{
+		const auto x = reader.GetRAMReport();
+		EXPECT_GT(x.RamPhysicalTotal, int64_t(0));
+		EXPECT_GT(x.RamPhysicalUsedByCurrentProcess, int64_t(0));
+		EXPECT_GT(x.RamCgroupTotal, int64_t(0));
+	}
+}
@@ -0,0 +1,126 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Sampler.h>
+#include <RingBuffer.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(Sampler, FirstSampleIsImmediate)
+{
+	npas4::Sampler sampler(std::chrono::seconds(60));
+
+	EXPECT_EQ(uint64_t(1), sampler.GetSampleCount());
+
+	const auto sample = sampler.GetLatest();
+	EXPECT_NE(int64_t(0), sample.Report.RamPhysicalTotal);
+	EXPECT_NE(int64_t(0), sample.Report.RamPhysicalUsedByCurrentProcess);
+}
+
+TEST(Sampler, SamplesAtInterval)
+{
+	npas4::Sampler sampler(std::chrono::milliseconds(1));
+	EXPECT_EQ(std::chrono::nanoseconds(std::chrono::milliseconds(1)), sampler.GetInterval());
+
+	while(sampler.GetSampleCount() < 8)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	npas4::Sample history[npas4::Sampler::Capacity + 1];
+	const auto copied = sampler.GetHistory(history, npas4::Sampler::Capacity + 1);
+
+	ASSERT_GE(copied, size_t(8));
+	EXPECT_LE(copied, npas4::Sampler::Capacity);
+
+	// Newest first.
+	for(size_t i = 1; i < copied; ++i)
+	{
+		EXPECT_GE(history[i - 1].Time, history[i].Time);
+	}
+}
+
+TEST(Sampler, StopsPromptly)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	{
+		npas4::Sampler sampler(std::chrono::seconds(60));
+	}
+
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(RingBuffer, ConcurrentReadersNeverSeeTornValues)
+{
+	struct Value
+	{
+		int64_t A;
+		int64_t B;
+		int64_t C;
+	};
+
+	npas4::impl::RingBuffer<Value, 8> ring;
+	std::atomic<bool> done{false};
+	std::atomic<int64_t> torn{0};
+	std::vector<std::thread> readers;
+
+	for(int i = 0; i < 3; ++i)
+	{
+		readers.emplace_back([&]() {
+			Value x;
+			Value recent[8];
+
+			while(done.load() == false)
+			{
+				if(ring.Latest(x) == true && (x.A != x.B || x.B != x.C))
+				{
+					++torn;
+				}
+
+				const auto copied = ring.Recent(recent, 8);
+
+				for(size_t j = 0; j < copied; ++j)
+				{
+					if(recent[j].A != recent[j].C || (j > 0 && recent[j].A >= recent[j - 1].A))
+					{
+						++torn;
+					}
+				}
+			}
+		});
+	}
+
+	for(int64_t i = 0; i < 200000; ++i)
+	{
+		ring.Push(Value{i, i, i});
+	}
+
+	done = true;
+
+	for(auto& reader : readers)
+	{
+		reader.join();
+	}
+
+	EXPECT_EQ(int64_t(0), torn.load());
+	EXPECT_EQ(uint64_t(200000), ring.Count());
+}
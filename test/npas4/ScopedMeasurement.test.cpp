@@ -0,0 +1,86 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/ScopedMeasurement.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+TEST(ScopedMeasurement, Empty)
+{
+	npas4::ScopedMeasurement x;
+	const auto report = x.Stop();
+
+	EXPECT_TRUE(x.IsStopped());
+
+	// With the measurer's own footprint removed, measuring nothing measures (almost) nothing.
+	EXPECT_LE(std::abs(report.RamPhysicalUsed), int64_t(8192));
+	EXPECT_LE(std::abs(report.RamVirtualUsed), int64_t(8192));
+	EXPECT_LE(report.MinorFaults, int64_t(2));
+	EXPECT_EQ(int64_t(0), report.MajorFaults);
+
+	const auto overhead = npas4::ScopedMeasurement::GetOverhead();
+	EXPECT_GE(overhead.RamPhysicalUsed, int64_t(0));
+	EXPECT_GE(overhead.MinorFaults, int64_t(0));
+}
+
+TEST(ScopedMeasurement, Allocation)
+{
+	const int64_t bytes{8 * 1024 * 1024};
+
+	npas4::MeasurementReport report;
+	std::vector<char> memory;
+
+	{
+		npas4::ScopedMeasurement x(report);
+		memory.resize(bytes);
+		memset(memory.data(), 1, memory.size());
+	}
+
+	EXPECT_NEAR(bytes, report.RamPhysicalUsed, 256 * 1024);
+	EXPECT_NEAR(bytes, report.RamVirtualUsed, 256 * 1024);
+	EXPECT_GE(report.RamPhysicalUsedPeak, report.RamPhysicalUsed);
+	EXPECT_GT(report.MinorFaults, int64_t(0));
+	EXPECT_GT(report.Elapsed.count(), int64_t(0));
+}
+
+TEST(ScopedMeasurement, Peak)
+{
+	const int64_t bytes{16 * 1024 * 1024};
+
+	npas4::ScopedMeasurement x;
+
+	{
+		std::vector<char> memory(bytes);
+		memset(memory.data(), 1, memory.size());
+
+		// Held long enough for a sampled peak to see it.
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	const auto report = x.Stop();
+	EXPECT_LE(std::abs(report.RamPhysicalUsed), bytes / 4);
+	EXPECT_GE(report.RamPhysicalUsedPeak, bytes * 3 / 4);
+
+	// Stopping again returns the same report.
+	EXPECT_EQ(report.RamPhysicalUsedPeak, x.Stop().RamPhysicalUsedPeak);
+	EXPECT_EQ(report.Elapsed, x.Stop().Elapsed);
+}
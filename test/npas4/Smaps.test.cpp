@@ -0,0 +1,168 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <Snapshot.h>
+#include <gtest/gtest.h>
+#include <npas4/Npas4.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+TEST(Smaps, ParseRollup)
+{
+	const char text[] =
+		"55fac3b6d000-7ffc17c40000 ---p 00000000 00:00 0                          [rollup]\n"
+		"Rss:                1308 kB\n"
+		"Pss:                 472 kB\n"
+		"Pss_Anon:            104 kB\n"
+		"Shared_Clean:       1136 kB\n"
+		"Shared_Dirty:          0 kB\n"
+		"Private_Clean:        68 kB\n"
+		"Private_Dirty:       104 kB\n"
+		"Anonymous:           104 kB\n"
+		"AnonHugePages:      2048 kB\n"
+		"Swap:                 12 kB\n"
+		"SwapPss:               6 kB\n"
+		"Locked:                4 kB\n";
+
+	npas4::impl::SmapsSnapshot x;
+	npas4::impl::ParseSmapsRollup(text, strlen(text), x);
+
+	EXPECT_EQ(int64_t(1308) * 1024, x.Rss);
+	EXPECT_EQ(int64_t(472) * 1024, x.Pss);
+	EXPECT_EQ(int64_t(68 + 104) * 1024, x.Uss);
+	EXPECT_EQ(int64_t(104) * 1024, x.Anonymous);
+	EXPECT_EQ(int64_t(2048) * 1024, x.AnonHugePages);
+	EXPECT_EQ(int64_t(12) * 1024, x.Swap);
+	EXPECT_EQ(int64_t(6) * 1024, x.SwapPss);
+	EXPECT_EQ(int64_t(4) * 1024, x.Locked);
+}
+
+#ifndef WIN32
+TEST(Smaps, AccumulateAcrossBuffers)
+{
+	// Enough mappings that the file spans many read buffers and lines straddle buffer boundaries.
+	constexpr int Mappings{1000};
+	const std::string path = "/tmp/npas4-smaps-test";
+
+	{
+		std::ofstream file(path);
+
+		for(int i = 0; i < Mappings; ++i)
+		{
+			file << "7f0000000000-7f0000001000 r-xp 00000000 08:01 1234                       /usr/lib/libc.so.6\n";
+			file << "Size:                  4 kB\n";
+			file << "Rss:                   4 kB\n";
+			file << "Pss:                   2 kB\n";
+			file << "Private_Clean:         1 kB\n";
+			file << "Private_Dirty:         1 kB\n";
+			file << "Swap:                  3 kB\n";
+			file << "Locked:                0 kB\n";
+			file << "VmFlags: rd ex mr mw me sd\n";
+		}
+	}
+
+	npas4::impl::SmapsSnapshot x;
+	EXPECT_TRUE(npas4::impl::AccumulateSmaps(path.c_str(), x));
+	remove(path.c_str());
+
+	EXPECT_EQ(int64_t(Mappings) * 4 * 1024, x.Rss);
+	EXPECT_EQ(int64_t(Mappings) * 2 * 1024, x.Pss);
+	EXPECT_EQ(int64_t(Mappings) * 2 * 1024, x.Uss);
+	EXPECT_EQ(int64_t(Mappings) * 3 * 1024, x.Swap);
+	EXPECT_EQ(int64_t(0), x.Locked);
+
+	EXPECT_FALSE(npas4::impl::AccumulateSmaps("/tmp/npas4-smaps-test-missing", x));
+}
+
+TEST(Smaps, AccumulateSkipsLongLines)
+{
+	const std::string path = "/tmp/npas4-smaps-test-long";
+
+	const auto mapping = [](std::ofstream& file, const std::string& line) {
+		file << line << "\n";
+		file << "Rss:                   4 kB\n";
+		file << "Pss:                   2 kB\n";
+	};
+
+	{
+		std::ofstream file(path);
+
+		// The first line fills the read buffer exactly, and what follows in the same line looks like a field.
+		std::string first = "7f0000000000-7f0000001000 r-xp 00000000 08:01 1234                       /";
+		first.resize(8192, 'a');
+		mapping(file, first + "Rss:                1000 kB");
+
+		mapping(file, "7f0000001000-7f0000002000 r-xp 00000000 08:01 1234                       /usr/lib/libc.so.6");
+
+		// A path spanning several buffers, starting part way into one.
+		mapping(file, "7f0000002000-7f0000003000 r-xp 00000000 08:01 1234                       /" + std::string(20000, 'b') + "Rss: 1 kB");
+
+		mapping(file, "7f0000003000-7f0000004000 r-xp 00000000 08:01 1234                       /usr/lib/libm.so.6");
+	}
+
+	npas4::impl::SmapsSnapshot x;
+	EXPECT_TRUE(npas4::impl::AccumulateSmaps(path.c_str(), x));
+	remove(path.c_str());
+
+	EXPECT_EQ(int64_t(4) * 4 * 1024, x.Rss);
+	EXPECT_EQ(int64_t(4) * 2 * 1024, x.Pss);
+}
+
+TEST(Smaps, RollupMatchesSmaps)
+{
+	npas4::impl::SmapsSnapshot rollup;
+	npas4::impl::SmapsSnapshot smaps;
+
+	ASSERT_TRUE(npas4::impl::ReadSmaps("/proc/self", rollup));
+	ASSERT_TRUE(npas4::impl::AccumulateSmaps("/proc/self/smaps", smaps));
+
+	// The two reads are not atomic with respect to each other, so allow for a little allocation in between.
+	EXPECT_NEAR(static_cast<double>(rollup.Rss), static_cast<double>(smaps.Rss), 4.0 * 1024.0 * 1024.0);
+	EXPECT_NEAR(static_cast<double>(rollup.Pss), static_cast<double>(smaps.Pss), 4.0 * 1024.0 * 1024.0);
+	EXPECT_NEAR(static_cast<double>(rollup.Uss), static_cast<double>(smaps.Uss), 4.0 * 1024.0 * 1024.0);
+}
+#endif
+
+TEST(Smaps, Report)
+{
+	// The unmasked report does not pay for the smaps query.
+	const auto plain = npas4::GetRAMReport();
+	EXPECT_EQ(int64_t(0), plain.RamProportionalUsedByCurrentProcess);
+	EXPECT_EQ(int64_t(0), plain.RamUniqueUsedByCurrentProcess);
+
+	const auto report = npas4::GetRAMReport(npas4::RAMReportField::All);
+
+	EXPECT_GT(report.RamProportionalUsedByCurrentProcess, int64_t(0));
+	EXPECT_GT(report.RamUniqueUsedByCurrentProcess, int64_t(0));
+	EXPECT_LE(report.RamUniqueUsedByCurrentProcess, report.RamProportionalUsedByCurrentProcess);
+	EXPECT_LE(report.RamProportionalUsedByCurrentProcess, report.RamPhysicalUsedByCurrentProcess);
+
+	const auto extended = npas4::GetExtendedReport();
+	EXPECT_GT(extended.RamProportionalUsedByCurrentProcess, int64_t(0));
+	EXPECT_GT(extended.RamAnonymousByCurrentProcess, int64_t(0));
+
+	EXPECT_GT(npas4::GetRAMProportionalUsedByCurrentProcess(), int64_t(0));
+	EXPECT_GT(npas4::GetRAMUniqueUsedByCurrentProcess(), int64_t(0));
+
+	const auto masked = npas4::GetRAMReport(npas4::RAMReportField::UniqueUsedByCurrentProcess);
+	EXPECT_GT(masked.RamUniqueUsedByCurrentProcess, int64_t(0));
+	EXPECT_EQ(int64_t(0), masked.RamProportionalUsedByCurrentProcess);
+}
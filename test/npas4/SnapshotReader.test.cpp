@@ -0,0 +1,76 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/SnapshotReader.h>
+
+TEST(SnapshotReader, IsOpen)
+{
+	npas4::SnapshotReader reader;
+	EXPECT_TRUE(reader.IsOpen());
+}
+
+TEST(SnapshotReader, MatchesFreeFunctions)
+{
+	npas4::SnapshotReader reader;
+
+	// Sample repeatedly to exercise re-reading the same descriptors.
+	for(int i = 0; i < 16; ++i)
+	{
+		const auto report = reader.GetRAMReport();
+		EXPECT_EQ(npas4::GetRAMPhysicalTotal(), report.RamPhysicalTotal);
+		EXPECT_EQ(npas4::GetRAMVirtualTotal(), report.RamVirtualTotal);
+		EXPECT_NE(int64_t(0), report.RamPhysicalUsedByCurrentProcess);
+		EXPECT_NE(int64_t(0), report.RamPhysicalUsedByCurrentProcessPeak);
+		EXPECT_NE(int64_t(0), report.RamVirtualUsedByCurrentProcess);
+	}
+}
+
+TEST(SnapshotReader, Fields)
+{
+	npas4::SnapshotReader reader;
+
+	const auto plain = reader.GetRAMReport();
+	EXPECT_EQ(int64_t(0), plain.RamProportionalUsedByCurrentProcess);
+	EXPECT_EQ(int64_t(0), plain.RamUniqueUsedByCurrentProcess);
+
+	const auto smaps = reader.GetRAMReport(npas4::RAMReportField::ProportionalUsedByCurrentProcess);
+	EXPECT_GT(smaps.RamProportionalUsedByCurrentProcess, int64_t(0));
+	EXPECT_EQ(int64_t(0), smaps.RamUniqueUsedByCurrentProcess);
+	EXPECT_EQ(int64_t(0), smaps.RamPhysicalTotal);
+
+	const auto process = reader.GetRAMReport(npas4::RAMReportField::PhysicalUsedByCurrentProcess | npas4::RAMReportField::PhysicalTotal);
+	EXPECT_GT(process.RamPhysicalUsedByCurrentProcess, int64_t(0));
+	EXPECT_EQ(npas4::GetRAMPhysicalTotal(), process.RamPhysicalTotal);
+	EXPECT_EQ(int64_t(0), process.RamPhysicalUsedByCurrentProcessPeak);
+}
+
+TEST(SnapshotReader, Statm)
+{
+	npas4::SnapshotReader reader;
+
+	const auto physical = reader.GetRAMPhysicalUsedByCurrentProcess();
+	const auto virtualSize = reader.GetRAMVirtualUsedByCurrentProcess();
+
+	EXPECT_GT(physical, int64_t(0));
+	EXPECT_GT(virtualSize, physical);
+
+	// statm and status report the same counters, in pages and kilobytes respectively.
+	EXPECT_NEAR(static_cast<double>(npas4::GetRAMVirtualUsedByCurrentProcess()), static_cast<double>(virtualSize), 1024.0 * 1024.0);
+	EXPECT_NEAR(static_cast<double>(npas4::GetRAMPhysicalUsedByCurrentProcess()), static_cast<double>(physical), 1024.0 * 1024.0);
+}
@@ -0,0 +1,148 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <gtest/gtest.h>
+#include <npas4/Npas4.h>
+#include <npas4/TrackingAllocator.h>
+
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	struct Vectors
+	{
+		static const char* Name()
+		{
+			return "test.vectors";
+		}
+	};
+
+	struct Maps
+	{
+		static const char* Name()
+		{
+			return "test.maps";
+		}
+	};
+
+	struct Threads
+	{
+		static const char* Name()
+		{
+			return "test.threads";
+		}
+	};
+} // namespace
+
+TEST(TrackingAllocator, Vector)
+{
+	const auto before = npas4::GetTrackingReport<Vectors>();
+	EXPECT_EQ("test.vectors", before.Name);
+
+	{
+		std::vector<int, npas4::TrackingAllocator<int, Vectors>> x;
+		x.reserve(1000);
+
+		auto during = npas4::GetTrackingReport<Vectors>();
+		EXPECT_EQ(int64_t(1000 * sizeof(int)), during.LiveBytes - before.LiveBytes);
+		EXPECT_EQ(int64_t(1), during.Allocations - before.Allocations);
+		EXPECT_GE(during.PeakBytes, during.LiveBytes);
+	}
+
+	auto after = npas4::GetTrackingReport<Vectors>();
+	EXPECT_EQ(before.LiveBytes, after.LiveBytes);
+	EXPECT_EQ(int64_t(1), after.Deallocations - before.Deallocations);
+	EXPECT_GE(after.PeakBytes, int64_t(1000 * sizeof(int)));
+
+	const auto text = static_cast<std::string>(after);
+	EXPECT_NE(std::string::npos, text.find("test.vectors"));
+}
+
+TEST(TrackingAllocator, Rebind)
+{
+	// Node containers rebind the allocator to their node type; the nodes are counted against the same tag.
+	typedef std::pair<const int, int> Value;
+
+	{
+		std::map<int, int, std::less<int>, npas4::TrackingAllocator<Value, Maps>> x;
+		std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, npas4::TrackingAllocator<Value, Maps>> y;
+
+		for(int i = 0; i < 100; ++i)
+		{
+			x[i] = i;
+			y[i] = i;
+		}
+
+		auto report = npas4::GetTrackingReport<Maps>();
+		EXPECT_GE(report.LiveBytes, int64_t(200 * sizeof(Value)));
+		EXPECT_GE(report.Allocations, int64_t(200));
+
+		// Untouched by the other tag.
+		EXPECT_EQ(int64_t(0), npas4::GetTrackingReport<Vectors>().LiveBytes);
+	}
+
+	EXPECT_EQ(int64_t(0), npas4::GetTrackingReport<Maps>().LiveBytes);
+}
+
+TEST(TrackingAllocator, Threads)
+{
+	std::vector<std::thread> threads;
+
+	for(int i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([]() {
+			for(int j = 0; j < 1000; ++j)
+			{
+				std::vector<char, npas4::TrackingAllocator<char, Threads>> x(100);
+			}
+		});
+	}
+
+	for(auto& i : threads)
+	{
+		i.join();
+	}
+
+	auto report = npas4::GetTrackingReport<Threads>();
+	EXPECT_EQ(int64_t(0), report.LiveBytes);
+	EXPECT_EQ(int64_t(4000), report.Allocations);
+	EXPECT_EQ(int64_t(4000 * 100), report.AllocatedBytes);
+	EXPECT_LE(report.PeakBytes, int64_t(4 * 100));
+}
+
+TEST(TrackingAllocator, Reports)
+{
+	std::vector<char, npas4::TrackingAllocator<char, Vectors>> x(1024 * 1024);
+
+	const auto reports = npas4::GetTrackingReports();
+	ASSERT_GE(reports.size(), size_t(3));
+	EXPECT_EQ("test.vectors", reports[0].Name);
+
+	int64_t total{0};
+
+	for(const auto& i : reports)
+	{
+		total += i.LiveBytes;
+	}
+
+	EXPECT_EQ(int64_t(1024 * 1024), total);
+	EXPECT_LE(total, npas4::GetRAMPhysicalUsedByCurrentProcess());
+}
@@ -0,0 +1,147 @@
+///
+/// \author	John Farrier
+///
+/// \copyright Copyright 2014-2018 John Farrier
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+/// http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+
+#include <Snapshot.h>
+#include <gtest/gtest.h>
+#include <npas4/Sampler.h>
+#include <npas4/SnapshotReader.h>
+#include <npas4/Usage.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	///
+	/// Maps and touches 'bytes' of new memory, one minor fault per page (fewer with transparent huge pages).  Mapped directly, since the
+	/// allocator would reuse memory freed by an earlier call without faulting.
+	///
+	void Touch(size_t bytes)
+	{
+#ifdef WIN32
+		std::vector<char> memory(bytes);
+		memset(memory.data(), 1, memory.size());
+#else
+		const auto memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		ASSERT_NE(MAP_FAILED, memory);
+		memset(memory, 1, bytes);
+		munmap(memory, bytes);
+#endif
+	}
+} // namespace
+
+TEST(Usage, ParseStat)
+{
+	// The command name may contain spaces and parentheses.
+	const char text[] = "1234 (my (odd) name) S 1 1234 1234 0 -1 4194560 1500 27 3 2 120 40 0 0 20 0 1 0 100 10000000 500\n";
+
+	npas4::impl::StatFields x;
+	ASSERT_TRUE(npas4::impl::ParseStat(text, sizeof(text) - 1, x));
+	EXPECT_EQ(int64_t(1500), x.MinorFaults);
+	EXPECT_EQ(int64_t(27), x.ChildMinorFaults);
+	EXPECT_EQ(int64_t(3), x.MajorFaults);
+	EXPECT_EQ(int64_t(2), x.ChildMajorFaults);
+
+	const char truncated[] = "1234 (name) S 1 1234 1234 0 -1 4194560 1500";
+	EXPECT_FALSE(npas4::impl::ParseStat(truncated, sizeof(truncated) - 1, x));
+
+	const char empty[] = "1234 name";
+	EXPECT_FALSE(npas4::impl::ParseStat(empty, sizeof(empty) - 1, x));
+}
+
+TEST(Usage, Faults)
+{
+	auto before = npas4::GetUsageReport();
+	Touch(16 * 1024 * 1024);
+	auto after = npas4::GetUsageReport();
+
+	const auto delta = after - before;
+	EXPECT_GT(delta.MinorFaults, int64_t(0));
+	EXPECT_GE(delta.MajorFaults, int64_t(0));
+	EXPECT_GE(after.RamPhysicalUsedPeak, int64_t(16 * 1024 * 1024));
+}
+
+#ifdef __linux__
+TEST(Usage, Thread)
+{
+	npas4::UsageReport thread;
+	npas4::UsageReport threadBefore;
+
+	std::thread([&]() {
+		threadBefore = npas4::GetUsageReport(npas4::UsageScope::Thread);
+		Touch(8 * 1024 * 1024);
+		thread = npas4::GetUsageReport(npas4::UsageScope::Thread);
+	}).join();
+
+	const auto process = npas4::GetUsageReport();
+
+	EXPECT_GT(thread.MinorFaults - threadBefore.MinorFaults, int64_t(0));
+	EXPECT_LT(thread.MinorFaults, process.MinorFaults);
+	EXPECT_EQ(int64_t(0), thread.ChildMinorFaults);
+}
+
+TEST(Usage, Children)
+{
+	const auto before = npas4::GetUsageReport();
+
+	const auto pid = fork();
+
+	if(pid == 0)
+	{
+		Touch(8 * 1024 * 1024);
+		_exit(0);
+	}
+
+	ASSERT_GT(pid, 0);
+	waitpid(pid, nullptr, 0);
+
+	const auto after = npas4::GetUsageReport();
+	EXPECT_GT(after.ChildMinorFaults, before.ChildMinorFaults);
+
+	npas4::SnapshotReader reader;
+	const auto x = reader.GetUsageReport();
+	EXPECT_EQ(after.ChildMinorFaults, x.ChildMinorFaults);
+	EXPECT_GE(x.MinorFaults, after.MinorFaults);
+}
+#endif
+
+TEST(Usage, SamplerRates)
+{
+	npas4::Sampler sampler(std::chrono::milliseconds(2));
+
+	const auto target = sampler.GetSampleCount() + 8;
+
+	while(sampler.GetSampleCount() < target)
+	{
+		Touch(1024 * 1024);
+	}
+
+	const auto rates = sampler.GetRates(4);
+	EXPECT_GT(rates.MinorFaults, 0.0);
+	EXPECT_GE(rates.MajorFaults, 0.0);
+
+	const auto latest = sampler.GetLatest();
+	EXPECT_GT(latest.Usage.MinorFaults, int64_t(0));
+}